@@ -63,6 +63,10 @@ final class RemoteRegisteredBackend :  RegisteredBackend {
 final class BackendUtils {
 
     private var _registered_backends: [String:RegisteredBackend] = [:]
+    /**
+     Instances released after running a job, reused by get_backend_instance.
+     */
+    private var _idle_backends: [String:[BaseBackend]] = [:]
     private var _api: IBMQuantumExperience?
     private var needsUpdate: Bool = true
     private let lock = NSRecursiveLock()    
@@ -74,6 +78,9 @@ final class BackendUtils {
         set(newApi) {
             self._api = newApi
             self.needsUpdate = true
+            self.lock.lock()
+            self._idle_backends = [:]
+            self.lock.unlock()
         }
     }
 
@@ -165,11 +172,12 @@ final class BackendUtils {
         }
         self.lock.lock()
         self._registered_backends = [:]
+        self._idle_backends = [:]
         self.lock.unlock()
         var backend_name_list = self.discover_local_backends()
         if self.api == nil {
             self.needsUpdate = false
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(backend_name_list,nil)
             }
             return RequestTask()
@@ -214,15 +222,31 @@ final class BackendUtils {
                 return
             }
             var backend: RegisteredBackend? = nil
+            var instance: BaseBackend? = nil
             self.lock.lock()
             backend = self._registered_backends[backend_name]
+            if backend != nil {
+                instance = self._idle_backends[backend_name]?.popLast()
+            }
             self.lock.unlock()
             if backend == nil {
                 responseHandler(nil,IBMQuantumExperienceError.badBackendError(backend: backend_name))
                 return
             }
-            responseHandler(backend!.newInstance(),nil)
+            responseHandler(instance ?? backend!.newInstance(),nil)
+        }
+    }
+
+    /**
+     Returns an instance got from get_backend_instance once its job has
+     finished, for the next jobs on the same backend.
+     */
+    func release_backend_instance(_ backend_name: String, _ backend: BaseBackend) {
+        self.lock.lock()
+        if self._registered_backends[backend_name] != nil {
+            self._idle_backends[backend_name, default: []].append(backend)
         }
+        self.lock.unlock()
     }
 
     func get_backend_configuration(_ backend_name: String,
@@ -27,6 +27,19 @@ public class BaseBackend {
     }
     var _configuration : [String:Any] = [:]
 
+    /**
+     Executor of the run responses, CompletionExecutor.shared unless set.
+     */
+    var executor: CompletionExecutor {
+        get {
+            return self._executor ?? CompletionExecutor.shared
+        }
+        set {
+            self._executor = newValue
+        }
+    }
+    var _executor: CompletionExecutor? = nil
+
     public required init(_ configuration: [String:Any]? = nil) {
         if type(of: self) == BaseBackend.self {
             fatalError("Abstract class instantiation.")
@@ -37,6 +37,9 @@ import Dispatch
  quantum state vector and 'classical_state' is an integer representing
  the state of the classical registors.
 
+ When the qobj or circuit config sets 'memory_mapped_output' to a directory,
+ 'quantum_state' is instead a ComplexBuffer mapped to a file in it.
+
  if shots > 1
     results['data']["counts"] where this is dict {"0000" : 454}
  
@@ -101,6 +104,12 @@ import Dispatch
  */
 final class QasmSimulator: BaseBackend {
 
+    /**
+     Up to this number of classical bits, shot outcomes are counted in a
+     flat array indexed by the classical state. Above it, in a dictionary.
+     */
+    static let dense_histogram_cbits: Int = 20
+
     /**
      Magic index1 function.
 
@@ -147,7 +156,7 @@ final class QasmSimulator: BaseBackend {
 
     private var _number_of_qubits: Int = 0
     private var _number_of_cbits: Int = 0
-    private var _quantum_state: [Complex] = []
+    private var _quantum_state: ComplexBuffer = ComplexBuffer(count: 0)
     private var _classical_state: Int = 0
     private var _shots: Int = 0
     private let _local_random: Random = Random()
@@ -180,7 +189,7 @@ final class QasmSimulator: BaseBackend {
      qubit is the qubit the gate is applied to.
      */
     private func _add_qasm_single(_ gate: Matrix<Complex>, _ qubit: Int) {
-        var psi = self._quantum_state
+        let psi = self._quantum_state
         let bit: Int = 1 << qubit
         for k1 in stride(from: 0, to: 1 << self._number_of_qubits, by: 1 << (qubit+1)) {
             for k2 in 0..<(1 << qubit) {
@@ -191,7 +200,6 @@ final class QasmSimulator: BaseBackend {
                 psi[k | bit] = gate[1,0] * cache0 + gate[1,1] * cache1
             }
         }
-        self._quantum_state = psi
     }
 
     /**
@@ -201,7 +209,7 @@ final class QasmSimulator: BaseBackend {
      q1 is the second qubit (target).
      */
     private func _add_qasm_cx(_ q0: Int, _ q1: Int) {
-        var psi = self._quantum_state
+        let psi = self._quantum_state
         for k in 0..<(1 << (self._number_of_qubits - 2)) {
             // first bit is control, second is target
             let ind1 = QasmSimulator._index2(1, q0, 0, q1, k)
@@ -212,7 +220,6 @@ final class QasmSimulator: BaseBackend {
             psi[ind3] = cache0
             psi[ind1] = cache1
         }
-        self._quantum_state = psi
     }
 
     /**
@@ -273,28 +280,18 @@ final class QasmSimulator: BaseBackend {
 
      */
     private func _add_qasm_reset(_ qubit: Int) {
-        // TODO: slow, refactor later
         let (outcome, norm) = self._add_qasm_decision(qubit)
-        var temp = self._quantum_state
-        self._quantum_state = [Complex](repeating: Complex(), count: _quantum_state.count)
-        // measurement
-        for ii in 0..<(1 << self._number_of_qubits) {
-            if ((ii >> qubit) & 1) == outcome {
-                temp[ii] = temp[ii]/norm
+        let psi = self._quantum_state
+        let bit: Int = 1 << qubit
+        for ii in 0..<(1 << self._number_of_qubits) where ii & bit == 0 {
+            if outcome == 1 {
+                // measured 1 then flipped: the amplitude with the bit set moves down
+                psi[ii] = psi[ii | bit]/norm
             }
             else {
-                temp[ii] = 0
+                psi[ii] = psi[ii]/norm
             }
-        }
-        // reset
-        if outcome == 1 {
-            for ii in 0..<(1 << self._number_of_qubits) {
-                let iip: Int = (~(1 << qubit)) & ii  // bit number qubit set to zero
-                self._quantum_state[iip] += temp[ii]
-            }
-        }
-        else {
-            self._quantum_state = temp
+            psi[ii | bit] = 0
         }
     }
 
@@ -308,27 +305,22 @@ final class QasmSimulator: BaseBackend {
             var result: Result? = nil
             let job_id = UUID().uuidString
             do {
-                self._shots = 0
-                let qobj = q_job.qobj
+                let qobj = q_job._qobj
                 var result_list: [[String:Any]] = []
-                if let config = qobj["config"] as? [String:Any] {
-                    if let shots = config["shots"] as? Int {
-                        self._shots = shots
-                    }
-                }
-                if let circuits = qobj["circuits"] as? [[String:Any]] {
-                    for circuit in circuits {
-                        result_list.append(try self.run_circuit(circuit,reqTask))
-                        if reqTask.isCancelled() {
-                            throw SimulatorError.simulationCancelled
-                        }
+                self._shots = qobj.config.shots
+                for (index, circuit) in qobj.circuits.enumerated() {
+                    result_list.append(try self.run_circuit(circuit,reqTask) { (count) in
+                        return try SimulatorTools.output_buffer(qobj, circuit, job_id, index, "quantum_state", count: count)
+                    })
+                    if reqTask.isCancelled() {
+                        throw SimulatorError.simulationCancelled
                     }
                 }
-                result = Result(["job_id": job_id, "result": result_list, "status": "COMPLETED"],qobj)
+                result = Result(["job_id": job_id, "result": result_list, "status": "COMPLETED"],qobj.dictionary)
             } catch {
                 result = Result(job_id,error,q_job.qobj)
             }
-            DispatchQueue.main.async {
+            self.executor.execute {
                  response(result!)
             }
         }
@@ -340,6 +332,8 @@ final class QasmSimulator: BaseBackend {
      Args:
          circuit (dict): JSON circuit from qobj circuits list
          shots (int): number of shots to run circuit
+         output_buffer: mapped buffer for a quantum state of the given
+            size, nil to return it as a list
      Returns:
          A dictionary of results which looks something like::
          {
@@ -351,147 +345,122 @@ final class QasmSimulator: BaseBackend {
          "status": --status (string)--
          }
      */
-    private func run_circuit(_ circuit: [String:Any], _ reqTask: RequestTask) throws -> [String:Any] {
+    private func run_circuit(_ circuit: QobjCircuit,
+                             _ reqTask: RequestTask,
+                             _ output_buffer: (Int) throws -> ComplexBuffer?) throws -> [String:Any] {
         var result: [String:Any] = [:]
         result["data"] = [:]
-        guard let ccircuit = circuit["compiled_circuit"] as? [String:Any] else {
+        guard let ccircuit = circuit.compiled_circuit else {
             throw SimulatorError.missingCompiledCircuit
         }
-        self._number_of_qubits = 0
-        self._number_of_cbits = 0
-        self._quantum_state = []
+        self._number_of_qubits = ccircuit.header.number_of_qubits ?? 0
+        self._number_of_cbits = ccircuit.header.number_of_clbits ?? 0
+        // A single buffer is reused by all the shots
+        let state_size = 1 << self._number_of_qubits
+        var mapped_state: ComplexBuffer? = nil
+        if self._shots == 1 {
+            mapped_state = try output_buffer(state_size)
+        }
+        self._quantum_state = mapped_state ?? ComplexBuffer(count: state_size)
         self._classical_state = 0
 
         var cl_reg_index: [Int] = [] // starting bit index of classical register
         var cl_reg_nbits: [Int] = [] // number of bits in classical register
-        if let header = ccircuit["header"]  as? [String:Any] {
-            if let number_of_qubits = header["number_of_qubits"] as? Int {
-                self._number_of_qubits = number_of_qubits
-            }
-            if let _number_of_cbits = header["number_of_clbits"] as? Int {
-                self._number_of_cbits = _number_of_cbits
-            }
-            if let clbit_labels = header["clbit_labels"] as? [[Any]] {
-                var cbit_index: Int = 0
-                for cl_reg in clbit_labels {
-                    if let index = cl_reg[1] as? Int {
-                        cl_reg_nbits.append(index)
-                        cl_reg_index.append(cbit_index)
-                        cbit_index += index
-                    }
-                }
+        if let clbit_labels = ccircuit.header.clbit_labels {
+            var cbit_index: Int = 0
+            for cl_reg in clbit_labels {
+                cl_reg_nbits.append(cl_reg.index)
+                cl_reg_index.append(cbit_index)
+                cbit_index += cl_reg.index
             }
         }
-        if let config = circuit["config"] as? [String:Any] {
-            if let seed = config["seed"] as? Int {
-                self._local_random.seed(seed)
-            }
-            else {
-                self._local_random.seed(time(nil))
-            }
+        if let seed = circuit.seed {
+            self._local_random.seed(seed)
+        }
+        else {
+            self._local_random.seed(time(nil))
         }
-        var outcomes: [String] = []
-        
+        // Count the classical states, formatting them once at the end
+        let dense = self._number_of_cbits <= QasmSimulator.dense_histogram_cbits
+        var histogram = [Int](repeating: 0, count: dense ? 1 << self._number_of_cbits : 0)
+        var sparse_histogram: [Int:Int] = [:]
+
         for _ in 0..<self._shots {
             if reqTask.isCancelled() {
                 throw SimulatorError.simulationCancelled
             }
-            self._quantum_state = [Complex](repeating: Complex(), count: 1 << self._number_of_qubits)
+            self._quantum_state.fill(Complex())
             self._quantum_state[0] = 1
             self._classical_state = 0
-            if let operations = ccircuit["operations"] as? [[String:Any]] {
-                // Do each operation in this shot
-                for operation in operations {
-                    if let conditional = operation["conditional"] as? [String:Any] {
-                        if let m = conditional["mask"] as? String {
-                            let scanner = Scanner(string: m)
-                            var n: UInt64 = 0
-                            if scanner.scanHexInt64(&n) {
-                                var mask = Int(n)
-                                if mask > 0 {
-                                    var value: Int = self._classical_state & mask
-                                    while ((mask & 0x1) == 0) {
-                                        mask >>= 1
-                                        value >>= 1
-                                    }
-                                    if let v = conditional["val"] as? String {
-                                        let scanner = Scanner(string: v)
-                                        var n: UInt64 = 0
-                                        if scanner.scanHexInt64(&n) {
-                                            if value != Int(n) {
-                                                continue
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    guard let name = operation["name"] as? String else {
-                        throw SimulatorError.missingOperationName
+            // Do each operation in this shot
+            for operation in ccircuit.operations {
+                if let conditional = operation.conditional {
+                    if !conditional.isSatisfied(self._classical_state) {
+                        continue
                     }
-                    // Check if single  gate
-                    if ["U", "u1", "u2", "u3"].contains(name) {
-                        if let qubits = operation["qubits"] as? [Int] {
-                            var params: [Double]? = nil
-                            if let _params = operation["params"] as? [Double] {
-                                params = _params
-                            }
-                            let qubit = qubits[0]
-                            let gate = SimulatorTools.single_gate_matrix(name, params)
-                            self._add_qasm_single(gate, qubit)
-                        }
-                    }
-                    else if ["id", "u0"].contains(name) {
-                    }
-                    // Check if CX gate
-                    else if ["CX", "cx"].contains(name) {
-                        if let qubits = operation["qubits"] as? [Int] {
-                            self._add_qasm_cx(qubits[0], qubits[1])
-                        }
-                    }
-                    // Check if measure
-                    else if name == "measure" {
-                        if let qubits = operation["qubits"] as? [Int] {
-                            if let clbits = operation["clbits"] as? [Int] {
-                                self._add_qasm_measure(qubits[0], clbits[0])
-                            }
-                        }
-                    }
-                    // Check if reset
-                    else if name == "reset" {
-                        if let qubits = operation["qubits"] as? [Int] {
-                            self._add_qasm_reset(qubits[0])
-                        }
-                    }
-                    else if name == "barrier" {
-                    }
-                    else {
-                        throw SimulatorError.unrecognizedOperation(backend: self.configuration["name"] as! String, operation: name)
+                }
+                let name = operation.name
+                if name.isEmpty {
+                    throw SimulatorError.missingOperationName
+                }
+                // Check if single  gate
+                if ["U", "u1", "u2", "u3"].contains(name) {
+                    let gate = SimulatorTools.single_gate_matrix(name, operation.params)
+                    self._add_qasm_single(gate, operation.qubits[0])
+                }
+                else if ["id", "u0"].contains(name) {
+                }
+                // Check if CX gate
+                else if ["CX", "cx"].contains(name) {
+                    self._add_qasm_cx(operation.qubits[0], operation.qubits[1])
+                }
+                // Check if measure
+                else if name == "measure" {
+                    if let clbits = operation.clbits {
+                        self._add_qasm_measure(operation.qubits[0], clbits[0])
                     }
                 }
+                // Check if reset
+                else if name == "reset" {
+                    self._add_qasm_reset(operation.qubits[0])
+                }
+                else if name == "barrier" {
+                }
+                else {
+                    throw SimulatorError.unrecognizedOperation(backend: self.configuration["name"] as! String, operation: name)
+                }
+            }
+            if dense {
+                histogram[self._classical_state] += 1
+            }
+            else {
+                sparse_histogram[self._classical_state, default: 0] += 1
             }
-            // Turn classical_state (int) into bit string
-            let binString = String(self._classical_state, radix: 2)
-            let filledBin: String = String(repeating: "0", count: self._number_of_cbits - binString.count) + binString
-            outcomes.append(filledBin)
         }
         // Return the results
         var data: [String:Any] = [:]
         if self._shots == 1 {
-            data["quantum_state"] = self._quantum_state
-            data["classical_state"] = self._classical_state
-        }
-        var counts: [String:Int] = [:]
-        for outcome in outcomes {
-            if let count = counts[outcome] {
-                counts[outcome] = count + 1
+            if mapped_state != nil {
+                data["quantum_state"] = self._quantum_state
             }
             else {
-                counts[outcome] = 1
+                data["quantum_state"] = self._quantum_state.array
             }
+            data["classical_state"] = self._classical_state
+        }
+        self._quantum_state = ComplexBuffer(count: 0)
+        if cl_reg_nbits.isEmpty {
+            cl_reg_index = [0]
+            cl_reg_nbits = [self._number_of_cbits]
+        }
+        var counts: [String:Int] = [:]
+        for (state, count) in histogram.enumerated() where count > 0 {
+            counts[QasmSimulator._format_result(state,cl_reg_index,cl_reg_nbits)] = count
+        }
+        for (state, count) in sparse_histogram {
+            counts[QasmSimulator._format_result(state,cl_reg_index,cl_reg_nbits)] = count
         }
-        data["counts"] = self._format_result(counts,cl_reg_index,cl_reg_nbits)
+        data["counts"] = counts
         result["data"] = data
         result["status"] = "DONE"
         return result
@@ -500,26 +469,26 @@ final class QasmSimulator: BaseBackend {
     /**
      Format the result bit string.
 
-     This formats the result bit strings such that spaces are inserted
-     at register divisions.
+     This formats the classical state as a bit string such that spaces are
+     inserted at register divisions, the last register first.
 
      Args:
-        counts : dictionary of counts e.g. {'1111': 1000, '0000':5}
+        state : classical state, bit i holding classical bit i
+        cl_reg_index : starting bit index of each classical register
+        cl_reg_nbits : number of bits in each classical register
      Returns:
-        spaces inserted into dictionary keys at register boundries.
+        the bit string, e.g. '01 1' for state 3 and registers of 1 and 2 bits
      */
-    private func _format_result(_ counts: [String:Int], _ cl_reg_index: [Int], _ cl_reg_nbits: [Int]) -> [String:Int] {
-        var fcounts: [String:Int] = [:]
-        for (key, value) in counts {
-            let start = key.index(key.endIndex, offsetBy: -cl_reg_nbits[0])
-            var new_key: [String] = [String(key[start..<key.endIndex])]
-            for (index, nbits) in zip(cl_reg_index[1...],cl_reg_nbits[1...]) {
-                let start = key.index(key.endIndex, offsetBy: -(index+nbits))
-                let end = key.index(key.endIndex, offsetBy: -index)
-                new_key.insert(String(key[start..<end]), at:0)
+    static func _format_result(_ state: Int, _ cl_reg_index: [Int], _ cl_reg_nbits: [Int]) -> String {
+        var key: [Character] = []
+        for reg in stride(from: cl_reg_nbits.count - 1, through: 0, by: -1) {
+            if reg < cl_reg_nbits.count - 1 {
+                key.append(" ")
+            }
+            for bit in stride(from: cl_reg_index[reg] + cl_reg_nbits[reg] - 1, through: cl_reg_index[reg], by: -1) {
+                key.append((state >> bit) & 1 == 1 ? "1" : "0")
             }
-            fcounts[new_key.joined(separator: " ")] = value
         }
-        return fcounts
+        return String(key)
     }
 }
@@ -47,7 +47,7 @@ final class QeRemote: BaseBackend {
      */
     override public func run(_ q_job: QuantumJob, response: @escaping ((_:Result) -> Void)) -> RequestTask {
         return self.runInternal(q_job) {  (result) -> Void in
-            DispatchQueue.main.async {
+            self.executor.execute {
                 response(result)
             }
         }
@@ -76,6 +76,10 @@ final class QeRemote: BaseBackend {
                             let compiled_circuit = try OpenQuantumCompiler.compile(dagCircuit.qasm())
                             circuit["compiled_circuit_qasm"] = try compiled_circuit.dag!.qasm(qeflag: true)
                         }
+                        else if let qasm = circuit["circuit"] as? String {
+                            let compiled_circuit = try OpenQuantumCompiler.compile(qasm)
+                            circuit["compiled_circuit_qasm"] = try compiled_circuit.dag!.qasm(qeflag: true)
+                        }
                     }
                     newCircuits.append(circuit)
                     if let bytes = circuit["compiled_circuit_qasm"] as? [UInt8] {
@@ -186,6 +190,10 @@ final class QeRemote: BaseBackend {
                             let compiled_circuit = try OpenQuantumCompiler.compile(dagCircuit.qasm())
                             circuit["compiled_circuit_qasm"] = try compiled_circuit.dag!.qasm(qeflag: true)
                         }
+                        else if let qasm = circuit["circuit"] as? String {
+                            let compiled_circuit = try OpenQuantumCompiler.compile(qasm)
+                            circuit["compiled_circuit_qasm"] = try compiled_circuit.dag!.qasm(qeflag: true)
+                        }
                     }
                     newCircuits.append(circuit)
                     if let bytes = circuit["compiled_circuit_qasm"] as? [UInt8] {
@@ -248,20 +256,13 @@ final class QeRemote: BaseBackend {
         return reqTask
     }
 
+    /**
+     Waits for the job jobId through the poller of api, which asks for the
+     status of all the jobs waited for at once.
+     */
     private static func wait_for_job(_ jobId: String, _ api: IBMQuantumExperience, wait: Int = 5, timeout: Int = 60,
                                      _ responseHandler: @escaping ((_:[String:Any], _:Error?) -> Void)) -> RequestTask {
-        return wait_for_job(api, jobId, wait, timeout, 0, responseHandler)
-    }
-
-    private static func wait_for_job(_ api: IBMQuantumExperience, _ jobid: String, _ wait: Int, _ timeout: Int, _ elapsed: Int,
-                                     _ responseHandler: @escaping ((_:[String:Any], _:Error?) -> Void)) -> RequestTask {
-        let reqTask = RequestTask()
-        let r =  api.get_jobInternal(jobId: jobid,
-                                     hub: nil,
-                                     group: nil,
-                                     project: nil,
-                                     access_token: nil,
-                                     user_id: nil) { (jobResult, error) -> Void in
+        return api.job_poller.wait(jobId, wait: wait, timeout: timeout) { (jobResult, error) -> Void in
             if error != nil {
                 responseHandler([:], error!)
                 return
@@ -270,36 +271,22 @@ final class QeRemote: BaseBackend {
                 responseHandler([:], QISKitError.missingStatus)
                 return
             }
-            if status != "RUNNING" {
-                if status == "ERROR_CREATING_JOB" || status == "ERROR_RUNNING_JOB" {
-                    responseHandler([:], QISKitError.errorStatus(status: status))
-                    return
-                }
-                // Get the results
-                var job_result_return: [[String:Any]] = []
-                if let qasms = jobResult["qasms"] as? [[String:Any]] {
-                    for qasm in qasms {
-                        if let data = qasm["data"],
-                            let status = qasm["status"] {
-                            job_result_return.append(["data": data, "status": status])
-                        }
-                    }
-                }
-                responseHandler(["status": status, "result": job_result_return],nil)
-                return
-            }
-            if elapsed >= timeout {
-                responseHandler([:], QISKitError.jobTimeout(timeout: timeout))
+            if status == "ERROR_CREATING_JOB" || status == "ERROR_RUNNING_JOB" {
+                responseHandler([:], QISKitError.errorStatus(status: status))
                 return
             }
-            DispatchQueue.global(qos: .background).asyncAfter(deadline: .now() + .seconds(wait)) {
-                SDKLogger.logInfo("status = \(status) (\(elapsed+wait) seconds)")
-                let r = wait_for_job(api,jobid, wait, timeout, elapsed + wait, responseHandler)
-                reqTask.add(r)
+            // Get the results
+            var job_result_return: [[String:Any]] = []
+            if let qasms = jobResult["qasms"] as? [[String:Any]] {
+                for qasm in qasms {
+                    if let data = qasm["data"],
+                        let status = qasm["status"] {
+                        job_result_return.append(["data": data, "status": status])
+                    }
+                }
             }
+            responseHandler(["status": status, "result": job_result_return],nil)
         }
-        reqTask.add(r)
-        return reqTask
     }
 
     /**
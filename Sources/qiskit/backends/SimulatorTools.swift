@@ -33,9 +33,38 @@ import Foundation
  */
 final class SimulatorTools {
 
+    /**
+     Qobj or circuit config key naming a directory. When set, the large
+     outputs of the local simulators are written to memory mapped files
+     in it and returned as ComplexBuffer.
+     */
+    static let memory_mapped_output: String = "memory_mapped_output"
+
     private init() {
     }
 
+    /**
+     Buffer for an output of count elements, mapped to a file of the
+     memory_mapped_output directory of the circuit or of the qobj, nil if
+     neither asks for one.
+     */
+    static func output_buffer(_ qobj: Qobj,
+                              _ circuit: QobjCircuit,
+                              _ job_id: String,
+                              _ index: Int,
+                              _ key: String,
+                              count: Int,
+                              dimensions: [Int]? = nil) throws -> ComplexBuffer? {
+        guard let path = circuit.config[memory_mapped_output] as? String ??
+                         qobj.config.extra[memory_mapped_output] as? String else {
+            return nil
+        }
+        let directory = URL(fileURLWithPath: path, isDirectory: true)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true, attributes: nil)
+        let file = directory.appendingPathComponent("\(job_id)_\(index)_\(key).bin")
+        return try ComplexBuffer(count: count, file: file, dimensions: dimensions)
+    }
+
     /**
      Magic index1 function.
 
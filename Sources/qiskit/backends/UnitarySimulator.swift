@@ -30,6 +30,9 @@ The input is the circuit object and the output is the same circuit object with
 a result field added results['data']['unitary'] where the unitary is
 a 2**n x 2**n complex numpy array representing the unitary matrix.
 
+When the qobj or circuit config sets 'memory_mapped_output' to a directory,
+the unitary is instead a ComplexBuffer mapped to a file in it, row by row.
+
 
 The input is
 compiled_circuit object
@@ -100,7 +103,7 @@ result =
 final class UnitarySimulator: BaseBackend {
 
     private var _number_of_qubits: Int = 0
-    private var _unitary_state: Matrix<Complex> = []
+    private var _unitary_state: ComplexBuffer = ComplexBuffer(count: 0)
 
     public required init(_ configuration: [String:Any]? = nil) {
         super.init(configuration)
@@ -127,23 +130,58 @@ final class UnitarySimulator: BaseBackend {
      qubit is the qubit to apply it on counts from 0 and order
      is q_{n-1} ... otimes q_1 otimes q_0.
      number_of_qubits is the number of qubits in the system.
+
+     The gate mixes the pairs of rows that differ in the qubit bit, in place,
+     which is the product with the enlarged operator without building it.
      */
     private func _add_unitary_single(_ gate: Matrix<Complex>, _ qubit: Int) {
-        let unitaty_add = SimulatorTools.enlarge_single_opt(gate, qubit, self._number_of_qubits)
-        self._unitary_state = unitaty_add.dot(self._unitary_state)
+        let unitary = self._unitary_state
+        let dim: Int = 1 << self._number_of_qubits
+        let bit: Int = 1 << qubit
+        for k in 0..<dim where k & bit == 0 {
+            let row0 = k * dim
+            let row1 = (k | bit) * dim
+            for col in 0..<dim {
+                let cache0 = unitary[row0 + col]
+                let cache1 = unitary[row1 + col]
+                unitary[row0 + col] = gate[0,0] * cache0 + gate[0,1] * cache1
+                unitary[row1 + col] = gate[1,0] * cache0 + gate[1,1] * cache1
+            }
+        }
     }
 
     /**
      Apply the two-qubit gate.
 
-     gate is the two-qubit gate
+     gate is the two-qubit gate, indexed by bit q0 + 2 * bit q1
      q0 is the first qubit (control) counts from 0
      q1 is the second qubit (target)
-     returns a complex numpy array
+
+     The gate mixes the groups of four rows that differ in the q0 and q1
+     bits, in place.
      */
     private func _add_unitary_two(_ gate: Matrix<Complex>, _ q0: Int, _ q1: Int) {
-        let unitaty_add = SimulatorTools.enlarge_two_opt(gate, q0, q1, self._number_of_qubits)
-        self._unitary_state = unitaty_add.dot(self._unitary_state)
+        let unitary = self._unitary_state
+        let dim: Int = 1 << self._number_of_qubits
+        var rows = [Int](repeating: 0, count: 4)
+        var cache = [Complex](repeating: Complex(), count: 4)
+        for k in 0..<(1 << (self._number_of_qubits - 2)) {
+            for j in 0..<4 {
+                rows[j] = SimulatorTools.index2(j & 1, q0, j >> 1, q1, k) * dim
+            }
+            for col in 0..<dim {
+                for j in 0..<4 {
+                    cache[j] = unitary[rows[j] + col]
+                }
+                for j in 0..<4 {
+                    var value = Complex()
+                    for jj in 0..<4 where gate[j,jj] != Complex() {
+                        value += gate[j,jj] * cache[jj]
+                    }
+                    unitary[rows[j] + col] = value
+                }
+            }
+        }
     }
 
     /**
@@ -156,21 +194,22 @@ final class UnitarySimulator: BaseBackend {
             var result: Result? = nil
             let job_id = UUID().uuidString
             do {
-                let qobj = q_job.qobj
+                let qobj = q_job._qobj
                 var result_list: [[String:Any]] = []
-                if let circuits = qobj["circuits"] as? [[String:Any]] {
-                    for circuit in circuits {
-                        result_list.append(try self.run_circuit(circuit,reqTask))
-                        if reqTask.isCancelled() {
-                            throw SimulatorError.simulationCancelled
-                        }
+                for (index, circuit) in qobj.circuits.enumerated() {
+                    result_list.append(try self.run_circuit(circuit,reqTask) { (dim) in
+                        return try SimulatorTools.output_buffer(qobj, circuit, job_id, index, "unitary",
+                                                                count: dim * dim, dimensions: [dim, dim])
+                    })
+                    if reqTask.isCancelled() {
+                        throw SimulatorError.simulationCancelled
                     }
                 }
-                result = Result(["job_id": job_id, "result": result_list, "status": "COMPLETED"],qobj)
+                result = Result(["job_id": job_id, "result": result_list, "status": "COMPLETED"],qobj.dictionary)
             } catch {
                 result = Result(job_id,error,q_job.qobj)
             }
-            DispatchQueue.main.async {
+            self.executor.execute {
                 response(result!)
             }
         }
@@ -178,49 +217,44 @@ final class UnitarySimulator: BaseBackend {
     }
 
     /**
-     Apply the single-qubit gate.
+     Run a circuit, output_buffer giving the mapped buffer of a unitary of
+     the given dimension or nil to return it as a Matrix.
      */
-    private func run_circuit(_ circuit: [String:Any], _ reqTask: RequestTask) throws -> [String:Any] {
+    private func run_circuit(_ circuit: QobjCircuit,
+                             _ reqTask: RequestTask,
+                             _ output_buffer: (Int) throws -> ComplexBuffer?) throws -> [String:Any] {
         var result: [String:Any] = [:]
         result["data"] = [:]
-        guard let ccircuit = circuit["compiled_circuit"] as? [String:Any] else {
+        guard let ccircuit = circuit.compiled_circuit else {
             throw SimulatorError.missingCompiledCircuit
         }
-        if let header = ccircuit["header"]  as? [String:Any] {
-            if let number_of_qubits = header["number_of_qubits"] as? Int {
-                self._number_of_qubits = number_of_qubits
-            }
+        if let number_of_qubits = ccircuit.header.number_of_qubits {
+            self._number_of_qubits = number_of_qubits
         }
-        self._unitary_state = Matrix<Complex>.identity(Int(pow(2.0,Double(self._number_of_qubits))))
-        guard let operations = ccircuit["operations"] as? [[String:Any]] else {
-            result["status"] = "ERROR"
-            return result
+        // The unitary is built in place, in the output file when mapped
+        let dim: Int = 1 << self._number_of_qubits
+        let mapped_unitary = try output_buffer(dim)
+        self._unitary_state = mapped_unitary ?? ComplexBuffer(count: dim * dim, dimensions: [dim, dim])
+        for i in 0..<dim {
+            self._unitary_state[i, i] = 1
         }
-        for operation in operations {
+        for operation in ccircuit.operations {
             if reqTask.isCancelled() {
                 throw SimulatorError.simulationCancelled
             }
-            guard let name = operation["name"] as? String else {
+            let name = operation.name
+            if name.isEmpty {
                 throw SimulatorError.missingOperationName
             }
             if ["U", "u1", "u2", "u3"].contains(name) {
-                if let qubits = operation["qubits"] as? [Int] {
-                    var params: [Double]? = nil
-                    if let _params = operation["params"] as? [Double] {
-                        params = _params
-                    }
-                    let qubit = qubits[0]
-                    let gate = SimulatorTools.single_gate_matrix(name, params)
-                    self._add_unitary_single(gate, qubit)
-                }
+                let gate = SimulatorTools.single_gate_matrix(name, operation.params)
+                self._add_unitary_single(gate, operation.qubits[0])
             }
             else if ["id", "u0"].contains(name) {
             }
             else if ["CX", "cx"].contains(name) {
-                if let qubits = operation["qubits"] as? [Int] {
-                    let gate: Matrix<Complex> = [[1, 0, 0, 0], [0, 0, 0, 1], [0, 0, 1, 0], [0, 1, 0, 0]]
-                    self._add_unitary_two(gate, qubits[0], qubits[1])
-                }
+                let gate: Matrix<Complex> = [[1, 0, 0, 0], [0, 0, 0, 1], [0, 0, 1, 0], [0, 1, 0, 0]]
+                self._add_unitary_two(gate, operation.qubits[0], operation.qubits[1])
             }
             else if name == "measure" {
                 SDKLogger.logInfo("Warning have dropped measure from unitary simulator")
@@ -235,7 +269,13 @@ final class UnitarySimulator: BaseBackend {
             }
         }
         var data: [String:Any] = [:]
-        data["unitary"] = self._unitary_state
+        if mapped_unitary != nil {
+            data["unitary"] = self._unitary_state
+        }
+        else {
+            data["unitary"] = self._unitary_state.matrix
+        }
+        self._unitary_state = ComplexBuffer(count: 0)
         result["data"] = data
         result["status"] = "DONE"
         return result
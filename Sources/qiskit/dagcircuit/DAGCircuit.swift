@@ -318,6 +318,21 @@ final class DAGCircuit {
         }
     }
 
+    /**
+     Remove an operation from the basis.
+     name is string label for operation
+     The operation must no longer be used by any node of the circuit.
+     */
+    public func remove_basis_element(_ name: String) throws {
+        if self.basis[name] == nil {
+            return
+        }
+        if !(try self.get_named_nodes(name)).isEmpty {
+            throw DAGCircuitError.basisElementInUse(name: name)
+        }
+        self.basis.removeValue(forKey: name)
+    }
+
     /**
      Add the definition of a gate.
      gatedata is dict with fields:
@@ -858,6 +873,77 @@ final class DAGCircuit {
         }
     }
 
+    /**
+     Return a circuit without operations that has the quantum registers
+     qregs and the classical registers, basis and gates of this circuit.
+     Registers are added in name order, as qasm() declares them.
+     */
+    func empty_copy(_ qregs: OrderedDictionary<String,Int>) throws -> DAGCircuit {
+        let circuit = DAGCircuit()
+        for (k,v) in qregs.sorted(by: { $0.0 < $1.0 }) {
+            try circuit.add_qreg(k, v)
+        }
+        for (k,v) in self.cregs.sorted(by: { $0.0 < $1.0 }) {
+            try circuit.add_creg(k, v)
+        }
+        circuit.basis = self.basis
+        circuit.gates = self.gates
+        circuit.prec = self.prec
+        return circuit
+    }
+
+    /**
+     Apply the operations of input_circuit to the output of this circuit.
+     Qubits are renamed with wire_map, other wires keep their names.
+     Unlike compose_back, registers, basis and gates are not merged, so
+     input_circuit may only use operations in the basis of this circuit.
+     */
+    func apply_circuit_back(_ input_circuit: DAGCircuit, _ wire_map: OrderedDictionary<RegBit,RegBit>) throws {
+        let topological_sort = try input_circuit.multi_graph.topological_sort()
+        for node in topological_sort {
+            guard let dataOp = node.data as? CircuitVertexOpData else {
+                continue
+            }
+            let m_qargs = dataOp.qargs.map { wire_map[$0] ?? $0 }
+            try self.apply_operation_back(dataOp.name, m_qargs, dataOp.cargs, dataOp.params, dataOp.condition)
+        }
+    }
+
+    /**
+     Return the operation nodes in topological order.
+     */
+    func topological_op_nodes() throws -> [GraphVertex<CircuitVertexData>] {
+        return try self.multi_graph.topological_sort().filter { $0.data is CircuitVertexOpData }
+    }
+
+    /**
+     Return the operations in topological order and, for each of them,
+     the positions in that order of the operations that directly follow it.
+     */
+    func op_successors() throws -> ([CircuitVertexOpData], [[Int]]) {
+        let topological_sort = try self.multi_graph.topological_sort()
+        var ops: [CircuitVertexOpData] = []
+        var keys: [Int] = []
+        var positions: [Int:Int] = [:]
+        for node in topological_sort {
+            guard let dataOp = node.data as? CircuitVertexOpData else {
+                continue
+            }
+            positions[node.key] = ops.count
+            ops.append(dataOp)
+            keys.append(node.key)
+        }
+        var successors = [[Int]](repeating: [], count: ops.count)
+        for (i, key) in keys.enumerated() {
+            for node in self.multi_graph.successors(key) {
+                if let j = positions[node.key] {
+                    successors[i].append(j)
+                }
+            }
+        }
+        return (ops, successors)
+    }
+
     /**
      Return the number of operations.
      */
@@ -1070,6 +1156,89 @@ final class DAGCircuit {
         return out
     }
 
+    /**
+     Return the json memory object for this circuit.
+     Emits the same structure as the unroller JsonBackend does for the
+     text returned by qasm(qeflag: true), without printing and parsing it
+     again. Every operation node is emitted as is, so the circuit must
+     already be expressed in the target basis.
+     */
+    public func json() throws -> [String:Any] {
+        return try self.compiled_circuit().dictionary
+    }
+
+    /**
+     Return the typed qobj compiled circuit for this circuit.
+     See json(). Params computed from circuit parameters are listed in its
+     parameters so that the circuit can be bound to new values, and the
+     parameters some params no longer follow in its untracked.
+     */
+    func compiled_circuit() throws -> QobjCompiledCircuit {
+        var qubit_indices: [RegBit:Int] = [:]
+        var qubit_labels: [RegBit] = []
+        for (name,size) in self.qregs.sorted(by: { $0.0 < $1.0 }) {
+            for j in 0..<size {
+                qubit_indices[RegBit(name, j)] = qubit_labels.count
+                qubit_labels.append(RegBit(name, j))
+            }
+        }
+        var cbit_indices: [RegBit:Int] = [:]
+        var clbit_labels: [RegBit] = []
+        for (name,size) in self.cregs.sorted(by: { $0.0 < $1.0 }) {
+            clbit_labels.append(RegBit(name, size))
+            for j in 0..<size {
+                cbit_indices[RegBit(name, j)] = cbit_indices.count
+            }
+        }
+        let header = QobjHeader(qubit_labels: qubit_labels.isEmpty ? nil : qubit_labels,
+                                clbit_labels: clbit_labels.isEmpty ? nil : clbit_labels)
+        var operations: [QobjOperation] = []
+        var parameters: [QobjParameter] = []
+        var untracked = Set<String>()
+        let topological_sort = try self.multi_graph.topological_sort()
+        for node in topological_sort {
+            guard let nd = node.data else {
+                continue
+            }
+            if nd.type != "op" {
+                continue
+            }
+            let dataOp = nd as! CircuitVertexOpData
+            var operation = QobjOperation(dataOp.name, qubits: dataOp.qargs.map { qubit_indices[$0]! })
+            switch dataOp.name {
+            case "CX", "barrier", "reset":
+                break
+            case "measure":
+                operation.clbits = dataOp.cargs.map { cbit_indices[$0]! }
+            default:
+                operation.params = dataOp.params.map { $0.value }
+                for (j, param) in dataOp.params.enumerated() {
+                    untracked.formUnion(param.untracked)
+                    if let name = param.parameter {
+                        parameters.append(QobjParameter(name: name, operation: operations.count, param: j,
+                                                        scale: param.scale, offset: param.offset))
+                    }
+                }
+            }
+            // no conditions on barrier, even when it appears
+            // in body of conditioned gate
+            if dataOp.name != "barrier" {
+                if let condition = dataOp.condition {
+                    var mask: Int = 0
+                    for j in 0..<(self.cregs[condition.name] ?? 0) {
+                        mask |= (1 << cbit_indices[RegBit(condition.name, j)]!)
+                    }
+                    operation.conditional = QobjConditional(mask: mask, val: condition.index)
+                }
+            }
+            operations.append(operation)
+        }
+        return QobjCompiledCircuit(header: header,
+                                   operations: operations,
+                                   parameters: parameters.isEmpty ? nil : parameters,
+                                   untracked: untracked.isEmpty ? nil : untracked.sorted())
+    }
+
     /**
      Check that a list of wires satisfies some conditions.
      The wires give an order for (qu)bits in the input circuit
@@ -43,6 +43,7 @@ public enum DAGCircuitError: LocalizedError, CustomStringConvertible {
     case missingWire(wire: RegBit)
     case missingName(name: String)
     case invalidOpType(type: String)
+    case basisElementInUse(name: String)
 
     public var errorDescription: String? {
         return self.description
@@ -97,6 +98,8 @@ public enum DAGCircuitError: LocalizedError, CustomStringConvertible {
             return "\(name) is not in the list of basis operations"
         case .invalidOpType(let type):
             return "expected node type \"op\", got \(type)"
+        case .basisElementInUse(let name):
+            return "\(name) is still used by operations of the circuit"
         }
     }
 }
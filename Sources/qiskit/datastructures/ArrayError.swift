@@ -37,6 +37,7 @@ public enum ArrayError: LocalizedError, CustomStringConvertible {
     case differentSizes(count1: Int, count2: Int)
     case matrixIsNotHermitian
     case unableToComputeEigenValues
+    case errorMapFile(file: String)
 
     public var errorDescription: String? {
         return self.description
@@ -77,6 +78,8 @@ public enum ArrayError: LocalizedError, CustomStringConvertible {
             return "Matrix is not hermitian"
         case .unableToComputeEigenValues:
             return "Unable to compute eigen values for this matrix"
+        case .errorMapFile(let file):
+            return "Unable to memory map file: \(file)"
         }
     }
 }
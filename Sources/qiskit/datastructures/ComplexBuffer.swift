@@ -0,0 +1,181 @@
+// Copyright 2017 IBM RESEARCH. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+
+import Foundation
+#if os(Linux)
+import Glibc
+#else
+import Darwin
+#endif
+
+/**
+ Fixed size buffer of complex numbers, held in memory or in a memory
+ mapped file.
+
+ The buffer is a reference: copies share the elements, which are changed
+ in place. A file backed buffer writes its elements to the file through
+ the mapping, as (real, imag) pairs of doubles in host byte order, so it
+ is never held twice in memory. Matrices are stored row by row, with
+ dimensions holding their shape.
+ */
+public final class ComplexBuffer: RandomAccessCollection, CustomStringConvertible {
+
+    public let count: Int
+    /**
+     Shape of the data, [count] for a vector and [rows, cols] for a matrix.
+     */
+    public let dimensions: [Int]
+    /**
+     File backing the buffer, nil if it is held in memory.
+     */
+    public let url: URL?
+
+    private let base: UnsafeMutablePointer<Complex>
+    private let mapped_bytes: Int
+
+    /**
+     Buffer of count zeros held in memory.
+     */
+    public init(count: Int, dimensions: [Int]? = nil) {
+        self.count = max(count, 0)
+        self.dimensions = dimensions ?? [self.count]
+        self.url = nil
+        self.mapped_bytes = 0
+        let raw = calloc(max(self.count, 1), MemoryLayout<Complex>.stride)!
+        self.base = raw.bindMemory(to: Complex.self, capacity: max(self.count, 1))
+    }
+
+    /**
+     Buffer of count zeros mapped to file, which is created or truncated.
+     */
+    public init(count: Int, file: URL, dimensions: [Int]? = nil) throws {
+        self.count = max(count, 0)
+        self.dimensions = dimensions ?? [self.count]
+        let bytes = max(self.count, 1) * MemoryLayout<Complex>.stride
+        let fd = open(file.path, O_RDWR | O_CREAT | O_TRUNC, 0o644)
+        if fd < 0 {
+            throw ArrayError.errorMapFile(file: file.path)
+        }
+        defer { close(fd) }
+        if ftruncate(fd, off_t(bytes)) != 0 {
+            throw ArrayError.errorMapFile(file: file.path)
+        }
+        guard let raw = mmap(nil, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0),
+            raw != UnsafeMutableRawPointer(bitPattern: -1) else {
+            throw ArrayError.errorMapFile(file: file.path)
+        }
+        self.url = file
+        self.mapped_bytes = bytes
+        self.base = raw.bindMemory(to: Complex.self, capacity: max(self.count, 1))
+    }
+
+    deinit {
+        if self.mapped_bytes > 0 {
+            munmap(UnsafeMutableRawPointer(self.base), self.mapped_bytes)
+        }
+        else {
+            free(UnsafeMutableRawPointer(self.base))
+        }
+    }
+
+    public var startIndex: Int {
+        return 0
+    }
+
+    public var endIndex: Int {
+        return self.count
+    }
+
+    public func index(after i: Int) -> Int {
+        return i + 1
+    }
+
+    public func index(before i: Int) -> Int {
+        return i - 1
+    }
+
+    public subscript(index: Int) -> Complex {
+        get {
+            precondition(index >= 0 && index < self.count, "Index out of range")
+            return self.base[index]
+        }
+        set {
+            precondition(index >= 0 && index < self.count, "Index out of range")
+            self.base[index] = newValue
+        }
+    }
+
+    /**
+     Element of a matrix buffer.
+     */
+    public subscript(row: Int, col: Int) -> Complex {
+        get {
+            return self[row * self.dimensions[1] + col]
+        }
+        set {
+            self[row * self.dimensions[1] + col] = newValue
+        }
+    }
+
+    /**
+     Whether the buffer is backed by a file.
+     */
+    public var isMapped: Bool {
+        return self.mapped_bytes > 0
+    }
+
+    /**
+     Copy of the elements.
+     */
+    public var array: [Complex] {
+        return Array(UnsafeBufferPointer(start: self.base, count: self.count))
+    }
+
+    /**
+     Copy of a matrix buffer as a Matrix.
+     */
+    public var matrix: Matrix<Complex> {
+        let cols = self.dimensions.count == 2 ? self.dimensions[1] : self.count
+        var value: [[Complex]] = []
+        for row in stride(from: 0, to: self.count, by: max(cols, 1)) {
+            value.append(Array(UnsafeBufferPointer(start: self.base + row, count: cols)))
+        }
+        return Matrix<Complex>(value: value)
+    }
+
+    /**
+     Sets every element to value.
+     */
+    public func fill(_ value: Complex) {
+        if value == Complex() {
+            memset(self.base, 0, self.count * MemoryLayout<Complex>.stride)
+            return
+        }
+        for i in 0..<self.count {
+            self.base[i] = value
+        }
+    }
+
+    /**
+     Calls body with the raw bytes of the elements.
+     */
+    public func withUnsafeBytes<R>(_ body: (UnsafeRawBufferPointer) throws -> R) rethrows -> R {
+        return try body(UnsafeRawBufferPointer(start: self.base, count: self.count * MemoryLayout<Complex>.stride))
+    }
+
+    public var description: String {
+        return self.array.description
+    }
+}
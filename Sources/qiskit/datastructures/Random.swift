@@ -53,7 +53,8 @@ final class Random {
         self.mt = Array<UInt>(repeating: 0, count: Int(N))
         self.mti = N + 1
         var randomState = CRandomState(mt:&self.mt, mti:  self.mti)
-        var initKey: [UInt] = [UInt(seed)]
+        // negative seeds are used as their bits
+        var initKey: [UInt] = [UInt(bitPattern: seed)]
         init_by_array(&randomState,&initKey, Int32(initKey.count));
         self.mti = randomState.mti
     }
@@ -15,6 +15,13 @@
 
 import Foundation
 
+/**
+ Real value of a circuit. A value computed from a circuit parameter keeps
+ the parameter name while it stays an affine function of it, value being
+ scale * parameter + offset for the parameter value it was computed with.
+ Any other operation gives a plain number that lists the parameters it
+ was computed from in untracked, so that binding them can be refused.
+ */
 public struct SymbolicValue: ExpressibleByFloatLiteral, Comparable, Hashable {
 
     public typealias FloatLiteralType = Swift.FloatLiteralType
@@ -22,15 +29,68 @@ public struct SymbolicValue: ExpressibleByFloatLiteral, Comparable, Hashable {
     public static let pi: SymbolicValue = SymbolicValue(Double.pi)
 
     public let value: FloatLiteralType
+    public let parameter: String?
+    public let scale: FloatLiteralType
+    public let offset: FloatLiteralType
+    /**
+     Circuit parameters the value depends on other than through scale and
+     offset. Binding them does not update the value.
+     */
+    public let untracked: Set<String>
 
     public init() {
-        self.value = 0.0
+        self.init(0.0)
     }
     public init(_ value: Swift.FloatLiteralType) {
         self.value = value
+        self.parameter = nil
+        self.scale = 0.0
+        self.offset = value
+        self.untracked = []
     }
     public init(floatLiteral value: FloatLiteralType) {
+        self.init(value)
+    }
+    /**
+     Value of the circuit parameter name, currently set to value.
+     */
+    public init(parameter name: String, value: FloatLiteralType) {
+        self.value = value
+        self.parameter = name
+        self.scale = 1.0
+        self.offset = 0.0
+        self.untracked = []
+    }
+    private init(_ value: FloatLiteralType, _ parameter: String?, _ scale: FloatLiteralType, _ offset: FloatLiteralType,
+                 _ untracked: Set<String>) {
+        let symbolic = parameter != nil && scale != 0.0
         self.value = value
+        self.parameter = symbolic ? parameter : nil
+        self.scale = symbolic ? scale : 0.0
+        self.offset = symbolic ? offset : value
+        self.untracked = untracked
+    }
+    /**
+     Plain number computed from operands, which no longer follows their
+     parameters.
+     */
+    fileprivate init(_ value: FloatLiteralType, from operands: [SymbolicValue]) {
+        self.init(value, nil, 0.0, value, operands.reduce(Set<String>()) { $0.union($1.parameters) })
+    }
+    /**
+     Every circuit parameter the value depends on.
+     */
+    public var parameters: Set<String> {
+        if let parameter = self.parameter {
+            return self.untracked.union([parameter])
+        }
+        return self.untracked
+    }
+    /**
+     Value for the parameter set to x.
+     */
+    public func bind(_ x: FloatLiteralType) -> FloatLiteralType {
+        return self.parameter == nil ? self.value : self.scale * x + self.offset
     }
     public var hashValue : Int {
         get {
@@ -62,69 +122,90 @@ public struct SymbolicValue: ExpressibleByFloatLiteral, Comparable, Hashable {
         return self.value.format(precision)
     }
     public func truncatingRemainder(dividingBy other: SymbolicValue) -> SymbolicValue {
-        return SymbolicValue(self.value.truncatingRemainder(dividingBy: other.value))
+        return SymbolicValue(self.value.truncatingRemainder(dividingBy: other.value), from: [self, other])
     }
     public func add(_ n: SymbolicValue) -> SymbolicValue {
-        return SymbolicValue(self.value + n.value)
+        let untracked = self.untracked.union(n.untracked)
+        if n.parameter == nil {
+            return SymbolicValue(self.value + n.value, self.parameter, self.scale, self.offset + n.value, untracked)
+        }
+        if self.parameter == nil {
+            return SymbolicValue(self.value + n.value, n.parameter, n.scale, n.offset + self.value, untracked)
+        }
+        if self.parameter == n.parameter {
+            return SymbolicValue(self.value + n.value, self.parameter, self.scale + n.scale, self.offset + n.offset, untracked)
+        }
+        return SymbolicValue(self.value + n.value, from: [self, n])
     }
     public func add(_ n: FloatLiteralType) -> SymbolicValue {
-        return SymbolicValue(self.value + n)
+        return SymbolicValue(self.value + n, self.parameter, self.scale, self.offset + n, self.untracked)
     }
     public func subtract(_ n: SymbolicValue) -> SymbolicValue {
-       return SymbolicValue(self.value - n.value)
+       return self.add(-n)
     }
     public func subtract(_ n: FloatLiteralType) -> SymbolicValue {
-        return SymbolicValue(self.value - n)
+        return self.add(-n)
     }
     public func multiply(_ n: SymbolicValue) -> SymbolicValue {
-        return SymbolicValue(self.value * n.value)
+        let untracked = self.untracked.union(n.untracked)
+        if n.parameter == nil {
+            return SymbolicValue(self.value * n.value, self.parameter, self.scale * n.value, self.offset * n.value, untracked)
+        }
+        if self.parameter == nil {
+            return SymbolicValue(self.value * n.value, n.parameter, n.scale * self.value, n.offset * self.value, untracked)
+        }
+        return SymbolicValue(self.value * n.value, from: [self, n])
     }
     public func multiply(_ n: FloatLiteralType) -> SymbolicValue {
-        return SymbolicValue(self.value * n)
+        return SymbolicValue(self.value * n, self.parameter, self.scale * n, self.offset * n, self.untracked)
     }
     public func divide(_ n: SymbolicValue) -> SymbolicValue {
-        return SymbolicValue(self.value / n.value)
+        if n.parameter == nil {
+            let untracked = self.untracked.union(n.untracked)
+            return SymbolicValue(self.value / n.value, self.parameter, self.scale / n.value, self.offset / n.value, untracked)
+        }
+        return SymbolicValue(self.value / n.value, from: [self, n])
     }
     public func divide(_ n: FloatLiteralType) -> SymbolicValue {
-        return SymbolicValue(self.value / n)
+        return SymbolicValue(self.value / n, self.parameter, self.scale / n, self.offset / n, self.untracked)
     }
     public func squareRoot() -> SymbolicValue {
-        return SymbolicValue(self.value.squareRoot())
+        return SymbolicValue(self.value.squareRoot(), from: [self])
     }
 }
 
 public func abs(_ value: SymbolicValue) -> SymbolicValue {
-    return SymbolicValue(abs(value.value))
+    return SymbolicValue(abs(value.value), from: [value])
 }
 public func sin(_ value: SymbolicValue) -> SymbolicValue {
-    return SymbolicValue(sin(value.value))
+    return SymbolicValue(sin(value.value), from: [value])
 }
 public func asin(_ value: SymbolicValue) -> SymbolicValue {
-    return SymbolicValue(asin(value.value))
+    return SymbolicValue(asin(value.value), from: [value])
 }
 public func acos(_ value: SymbolicValue) -> SymbolicValue {
-    return SymbolicValue(acos(value.value))
+    return SymbolicValue(acos(value.value), from: [value])
 }
 public func tan(_ value: SymbolicValue) -> SymbolicValue {
-    return SymbolicValue(tan(value.value))
+    return SymbolicValue(tan(value.value), from: [value])
 }
 public func atan(_ value: SymbolicValue) -> SymbolicValue {
-    return SymbolicValue(atan(value.value))
+    return SymbolicValue(atan(value.value), from: [value])
 }
 public func cos(_ value: SymbolicValue) -> SymbolicValue {
-    return SymbolicValue(cos(value.value))
+    return SymbolicValue(cos(value.value), from: [value])
 }
 public func exp(_ value: SymbolicValue) -> SymbolicValue {
-    return SymbolicValue(exp(value.value))
+    return SymbolicValue(exp(value.value), from: [value])
 }
 public func log(_ value: SymbolicValue) -> SymbolicValue {
-    return SymbolicValue(log(value.value))
+    return SymbolicValue(log(value.value), from: [value])
 }
 public func pow(_ left: SymbolicValue, _ right: SymbolicValue) -> SymbolicValue {
-    return SymbolicValue(pow(left.value,right.value))
+    return SymbolicValue(pow(left.value,right.value), from: [left, right])
 }
 public prefix func - (value: SymbolicValue) -> SymbolicValue {
-    return SymbolicValue(-value.value)
+    return value.multiply(-1.0)
 }
 public func + (left: SymbolicValue,  right: SymbolicValue) -> SymbolicValue {
     return left.add(right)
@@ -18,7 +18,7 @@ import Foundation
 /**
  controlled-U1 gate.
  */
-public final class Cu1Gate: Gate, CopyableInstruction  {
+public final class Cu1Gate: Gate, CopyableInstruction, ParameterizedInstruction {
 
     public let instructionComponent: InstructionComponent
 
@@ -35,7 +35,11 @@ public final class Cu1Gate: Gate, CopyableInstruction  {
     }
 
     public var description: String {
-        let theta = self.params[0].format(15)
+        return self._qasm(false)
+    }
+
+    func _qasm(_ symbolic: Bool) -> String {
+        let theta = self.instructionComponent.param_qasm(0, symbolic)
         return self._qasmif("\(name)(\(theta)) \(self.args[0].identifier),\(self.args[1].identifier)")
     }
 
@@ -18,7 +18,7 @@ import Foundation
 /**
  controlled-U3 gate.
  */
-public final class Cu3Gate: Gate, CopyableInstruction {
+public final class Cu3Gate: Gate, CopyableInstruction, ParameterizedInstruction {
 
     public let instructionComponent: InstructionComponent
 
@@ -35,9 +35,13 @@ public final class Cu3Gate: Gate, CopyableInstruction {
     }
 
     public var description: String {
-        let theta = self.params[0].format(15)
-        let phi = self.params[1].format(15)
-        let lam = self.params[2].format(15)
+        return self._qasm(false)
+    }
+
+    func _qasm(_ symbolic: Bool) -> String {
+        let theta = self.instructionComponent.param_qasm(0, symbolic)
+        let phi = self.instructionComponent.param_qasm(1, symbolic)
+        let lam = self.instructionComponent.param_qasm(2, symbolic)
         return self._qasmif("\(name)(\(theta),\(phi),\(lam)) \(self.args[0].identifier),\(self.args[1].identifier)")
     }
 
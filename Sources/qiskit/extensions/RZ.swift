@@ -19,7 +19,7 @@ import Foundation
 /**
  rotation around the z-axis
  */
-public final class RZGate: Gate, CopyableInstruction {
+public final class RZGate: Gate, CopyableInstruction, ParameterizedInstruction {
 
     public let instructionComponent: InstructionComponent
 
@@ -36,7 +36,11 @@ public final class RZGate: Gate, CopyableInstruction {
     }
 
     public var description: String {
-        let theta = self.params[0].format(15)
+        return self._qasm(false)
+    }
+
+    func _qasm(_ symbolic: Bool) -> String {
+        let theta = self.instructionComponent.param_qasm(0, symbolic)
         return self._qasmif("\(name)(\(theta)) \(self.args[0].identifier)")
     }
 
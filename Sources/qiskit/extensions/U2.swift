@@ -19,7 +19,7 @@ import Foundation
 /**
  One-pulse single qubit gate
  */
-public final class U2Gate: Gate, CopyableInstruction {
+public final class U2Gate: Gate, CopyableInstruction, ParameterizedInstruction {
 
     public let instructionComponent: InstructionComponent
 
@@ -36,8 +36,12 @@ public final class U2Gate: Gate, CopyableInstruction {
     }
 
     public var description: String {
-        let phi = self.params[0].format(15)
-        let lam = self.params[1].format(15)
+        return self._qasm(false)
+    }
+
+    func _qasm(_ symbolic: Bool) -> String {
+        let phi = self.instructionComponent.param_qasm(0, symbolic)
+        let lam = self.instructionComponent.param_qasm(1, symbolic)
         return self._qasmif("\(name)(\(phi),\(lam)) \(self.args[0].identifier)")
     }
 
@@ -19,7 +19,7 @@ import Foundation
 /**
  Two-pulse single qubit gate
  */
-public final class U3Gate: Gate, CopyableInstruction {
+public final class U3Gate: Gate, CopyableInstruction, ParameterizedInstruction {
 
     public let instructionComponent: InstructionComponent
 
@@ -36,9 +36,13 @@ public final class U3Gate: Gate, CopyableInstruction {
     }
 
     public var description: String {
-        let theta = self.params[0].format(15)
-        let phi = self.params[1].format(15)
-        let lam = self.params[2].format(15)
+        return self._qasm(false)
+    }
+
+    func _qasm(_ symbolic: Bool) -> String {
+        let theta = self.instructionComponent.param_qasm(0, symbolic)
+        let phi = self.instructionComponent.param_qasm(1, symbolic)
+        let lam = self.instructionComponent.param_qasm(2, symbolic)
         return self._qasmif("\(name)(\(theta),\(phi),\(lam)) \(self.args[0].identifier)")
     }
 
@@ -90,10 +90,20 @@ final class Coupling: CustomStringConvertible {
     private var G: Graph<CouplingVertexData,EmptyGraphData> = Graph<CouplingVertexData,EmptyGraphData>(directed: true)
 
     /**
-     dist is a dict of dicts from node pairs to distances
-     it must be computed, it is the distance on the digraph
+     qubit_indices is a dict from qubits to their position in get_qubits()
      */
-    private var dist: [RegBit:[RegBit:Int]] = [:]
+    private var qubit_indices: [RegBit:Int] = [:]
+
+    /**
+     edge_indices holds the edges of get_edges() as pairs of qubit positions
+     */
+    private var edge_indices: [(Int,Int)] = []
+
+    /**
+     distance_matrix is the flat n x n matrix of distances on the digraph,
+     indexed by qubit position (row major). It must be computed.
+     */
+    private(set) var distance_matrix: [Int32] = []
 
     /**
      Return a string representation of the coupling graph.
@@ -178,6 +188,7 @@ final class Coupling: CustomStringConvertible {
             throw CouplingError.duplicateregbit(regBit: name)
         }
         self.node_counter += 1
+        self.qubit_indices[name] = self.qubits.count
         self.qubits[name] = self.G.add_vertex(self.node_counter, CouplingVertexData(name)).key
         self.index_to_qubit[self.qubits[name]!] = name
     }
@@ -207,7 +218,7 @@ final class Coupling: CustomStringConvertible {
 
     /**
      Compute the distance function on pairs of nodes.
-     The distance map self.dist is computed from the graph using
+     The distance matrix self.distance_matrix is computed from the graph using
      all_pairs_shortest_path_length    
     */
     private func compute_distance() throws {
@@ -215,34 +226,58 @@ final class Coupling: CustomStringConvertible {
             throw CouplingError.notconnected
         }
         let lengths = self.G.to_undirected().all_pairs_shortest_path_length()
-        self.dist = [:]
-        for i in self.qubits.keys {
-            self.dist[i] = [:]
-            guard let lengthSource = lengths[self.qubits[i]!] else {
+        let n = self.qubits.count
+        let qubits = self.qubits.keys
+        self.distance_matrix = [Int32](repeating: 0, count: n * n)
+        for i in 0..<n {
+            guard let lengthSource = lengths[self.qubits[qubits[i]]!] else {
                 continue
             }
-            for j in self.qubits.keys {
-                guard let lengthEnd = lengthSource[self.qubits[j]!] else {
+            for j in 0..<n {
+                guard let lengthEnd = lengthSource[self.qubits[qubits[j]]!] else {
                     continue
                 }
-                self.dist[i]![j] = lengthEnd
+                self.distance_matrix[i * n + j] = Int32(lengthEnd)
             }
         }
+        self.edge_indices = []
+        for edge in self.get_edges() {
+            self.edge_indices.append((self.qubit_indices[edge.one]!, self.qubit_indices[edge.two]!))
+        }
+    }
+
+    /**
+     Return the position of a qubit in get_qubits(), the row and column
+     of the qubit in distance_matrix.
+     */
+    public func qubit_index(_ q: RegBit) throws -> Int {
+        guard let index = self.qubit_indices[q] else {
+            throw CouplingError.notincouplinggraph(regBit: q)
+        }
+        return index
+    }
+
+    /**
+     Return the edges of get_edges() as pairs of qubit positions.
+     */
+    public func get_edge_indices() -> [(Int,Int)] {
+        return self.edge_indices
+    }
+
+    /**
+     Return the distance between the qubits at positions i and j.
+     */
+    public func distance(_ i: Int, _ j: Int) -> Int {
+        return Int(self.distance_matrix[i * self.qubits.count + j])
     }
 
     /**
      Return the distance between qubit q1 to qubit q2
      */
     public func distance(_ q1: RegBit, _ q2: RegBit) throws -> Int {
-        if self.dist.isEmpty {
+        if self.distance_matrix.isEmpty {
             throw CouplingError.distancenotcomputed
         }
-        if self.qubits[q1] == nil {
-            throw CouplingError.notincouplinggraph(regBit: q1)
-        }
-        if self.qubits[q2] == nil {
-            throw CouplingError.notincouplinggraph(regBit: q2)
-        }
-        return self.dist[q1]![q2]!
+        return self.distance(try self.qubit_index(q1), try self.qubit_index(q2))
     }
 }
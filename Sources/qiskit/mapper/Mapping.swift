@@ -15,6 +15,9 @@
 
 
 import Foundation
+#if os(Linux)
+import Dispatch
+#endif
 
 /**
  Layout module to assist with mapping circuit qubits onto physical qubits.
@@ -49,12 +52,13 @@ final class Mapping {
      The qubit_subset is the subset of qubits in the coupling graph that
      we have chosen to map into.
      The coupling is a CouplingGraph.
-     TRIALS is the number of attempts the randomized algorithm makes.
+     TRIALS is the number of attempts the randomized algorithm makes. The
+     trials run concurrently, trial i seeded with seed + i.
 
-     Returns: success_flag, best_circ, best_d, best_layout, trivial_flag
+     Returns: success_flag, best_swaps, best_d, best_layout, trivial_flag
 
-     If success_flag is True, then best_circ contains an OPENQASM string with
-     the swap circuit, best_d contains the depth of the swap circuit, and
+     If success_flag is True, then best_swaps contains the swap circuit as
+     a list of coupling graph edges, best_d contains the depth of the swap circuit, and
      best_layout contains the new positions of the data qubits after the
      swap circuit has been applied. The trivial_flag is set if the layer
      has no multi-qubit gates.
@@ -64,25 +68,46 @@ final class Mapping {
                                   _ qubit_subset: [RegBit],
                                   _ coupling: Coupling,
                                   _ trials: Int,
-                                  _ seed: Int? = nil) throws -> (Bool, String?, Int?, OrderedDictionary<RegBit,RegBit>?, Bool) {
-        let random = Random(seed != nil ? seed! : time(nil))
+                                  _ seed: Int? = nil) throws -> (Bool, [(RegBit,RegBit)]?, Int?, OrderedDictionary<RegBit,RegBit>?, Bool) {
         SDKLogger.logDebug("layer_permutation: ----- enter -----")
         SDKLogger.logDebug("layer_permutation: layer_partition = \(SDKLogger.debugString(layer_partition))")
         SDKLogger.logDebug("layer_permutation: layout = \(SDKLogger.debugString(layout))")
         SDKLogger.logDebug("layer_permutation: qubit_subset = \(SDKLogger.debugString(qubit_subset))")
         SDKLogger.logDebug("layer_permutation: trials = \(trials)")
 
-        var rev_layout: OrderedDictionary<RegBit,RegBit> = OrderedDictionary<RegBit,RegBit>()
-        for (a,b) in layout {
-            rev_layout[b] = a
+        // Work on positions: virtual qubits are numbered in layout order and
+        // physical qubits by their position in the coupling graph.
+        let n = coupling.size()
+        let virtual_qubits = layout.keys
+        let physical_qubits = coupling.get_qubits()
+        var virtual_indices: [RegBit:Int] = [:]
+        for (v, regBit) in virtual_qubits.enumerated() {
+            virtual_indices[regBit] = v
+        }
+        var v2p = [Int](repeating: -1, count: virtual_qubits.count)
+        var p2v = [Int](repeating: -1, count: n)
+        for (v, regBit) in virtual_qubits.enumerated() {
+            let p = try coupling.qubit_index(layout[regBit]!)
+            v2p[v] = p
+            p2v[p] = v
         }
-        var gates: [(RegBit,RegBit)] = []
+        var gates: [(Int,Int)] = []
+        // gate_of[v] is the gate acting on virtual qubit v, if any
+        var gate_of = [Int](repeating: -1, count: virtual_qubits.count)
         for layer in layer_partition {
             if layer.count > 2 {
                 throw MappingError.layoutError
             }
             if layer.count == 2 {
-                gates.append((layer[0],layer[1]))
+                guard let v0 = virtual_indices[layer[0]] else {
+                    throw MappingError.errorQubitInputCircuit(regBit: layer[0])
+                }
+                guard let v1 = virtual_indices[layer[1]] else {
+                    throw MappingError.errorQubitInputCircuit(regBit: layer[1])
+                }
+                gate_of[v0] = gates.count
+                gate_of[v1] = gates.count
+                gates.append((v0,v1))
             }
         }
 
@@ -91,139 +116,203 @@ final class Mapping {
         // Can we already apply the gates?
         var dist: Int = 0
         for g in gates {
-            dist += try coupling.distance(layout[g.0]!,layout[g.1]!)
+            dist += coupling.distance(v2p[g.0],v2p[g.1])
         }
         SDKLogger.logDebug("layer_permutation: dist = \(dist)")
         if dist == gates.count {
             SDKLogger.logDebug("layer_permutation: done already")
             SDKLogger.logDebug("layer_permutation: ----- exit -----")
-            return (true, "", 0, layout, gates.isEmpty)
+            return (true, [], 0, layout, gates.isEmpty)
         }
 
-        // Begin loop over trials of randomized algorithm
-        let n = coupling.size()
+        var subset = [Bool](repeating: false, count: n)
+        for regBit in qubit_subset {
+            subset[try coupling.qubit_index(regBit)] = true
+        }
+        let edges = coupling.get_edge_indices()
+
+        // Begin loop over trials of randomized algorithm. Each trial draws
+        // from its own generator seeded by the base seed and the trial index,
+        // so the trials run concurrently and still reproduce for a fixed seed.
+        let base_seed: Int = seed != nil ? seed! : time(nil)
+        var results = [(Int, [(Int,Int)], [Int])?](repeating: nil, count: trials)
+        let lock = NSLock()
+        DispatchQueue.concurrentPerform(iterations: trials) { (trial) in
+            let result = Mapping.layer_trial(trial, Random(base_seed &+ trial), v2p, p2v,
+                                             gates, gate_of, subset, edges, coupling)
+            lock.lock()
+            results[trial] = result
+            lock.unlock()
+        }
+        // Lowest depth wins, ties go to the lowest trial index
         var best_d: Int = Int.max  // initialize best depth
-        var best_circ: String? = nil  // initialize best swap circuit
-        var best_layout: OrderedDictionary<RegBit,RegBit>? = nil  // initialize best final layout
-        for trial in 0..<trials {
-            SDKLogger.logDebug("layer_permutation: trial \(trial)")
-            var trial_layout = layout
-            var rev_trial_layout = rev_layout
-            var trial_circ = ""  // circuit produced in this trial
-
-            // Compute Sergey's randomized distance
-            var xi:[RegBit:[RegBit:Double]] = [:]
-            for i in coupling.get_qubits() {
-                xi[i] = [:]
-            }
-            for i in coupling.get_qubits() {
-                for j in coupling.get_qubits() {
-                    let scale: Double = 1.0 + random.normal(mean: 0.0, standardDeviation: 1.0 / Double(n))
-                    xi[i]![j] = scale * pow(Double(try coupling.distance(i, j)),2)
-                    xi[j]![i] = xi[i]![j]
-                }
-            }
-            // Loop over depths d up to a max depth of 2n+1
-            var d: Int = 1
-            var circ = ""  // circuit for this swap slice
-            while d < 2*n+1 {
-                // Set of available qubits
-                var qubit_set = Set<RegBit>(qubit_subset)
-                // While there are still qubits available
-                while !qubit_set.isEmpty {
-                    // Compute the objective function
-                    var min_cost: Double = 0
-                    for g in gates {
-                        min_cost += xi[trial_layout[g.0]!]![trial_layout[g.1]!]!
+        var best_circ: [(Int,Int)]? = nil  // initialize best swap circuit
+        var best_layout: [Int]? = nil  // initialize best final layout
+        for result in results {
+            if case let (d, trial_circ, trial_layout)? = result, d < best_d {
+                best_d = d
+                best_circ = trial_circ
+                best_layout = trial_layout
+            }
+        }
+        if best_circ == nil {
+            SDKLogger.logDebug("layer_permutation: failed!")
+            SDKLogger.logDebug("layer_permutation: ----- exit -----")
+            return (false, nil, nil, nil, false)
+        }
+        var new_layout: OrderedDictionary<RegBit,RegBit> = OrderedDictionary<RegBit,RegBit>()
+        for (v, regBit) in virtual_qubits.enumerated() {
+            new_layout[regBit] = physical_qubits[best_layout![v]]
+        }
+        let best_swaps = best_circ!.map { (physical_qubits[$0.0], physical_qubits[$0.1]) }
+        SDKLogger.logDebug("layer_permutation: done")
+        SDKLogger.logDebug("layer_permutation: ----- exit -----")
+        return (true, best_swaps, best_d, new_layout, false)
+    }
+
+    /**
+     Run one trial of the randomized swap search for layer_permutation.
+     v2p and p2v are the starting layout on positions, gates the pairs of
+     virtual qubits to bring together and gate_of the gate acting on each
+     virtual qubit. Only physical qubits flagged in subset may be swapped.
+
+     Returns the depth, the swap circuit as edges on positions and the final
+     layout, or nil if the trial failed.
+     */
+    static private func layer_trial(_ trial: Int,
+                                    _ random: Random,
+                                    _ v2p: [Int],
+                                    _ p2v: [Int],
+                                    _ gates: [(Int,Int)],
+                                    _ gate_of: [Int],
+                                    _ subset: [Bool],
+                                    _ edges: [(Int,Int)],
+                                    _ coupling: Coupling) -> (Int, [(Int,Int)], [Int])? {
+        SDKLogger.logDebug("layer_permutation: trial \(trial)")
+        let n = coupling.size()
+        var trial_layout = v2p
+        var rev_trial_layout = p2v
+        var trial_circ: [(Int,Int)] = []  // circuit produced in this trial
+
+        // Compute Sergey's randomized distance
+        var xi = [Double](repeating: 0, count: n * n)
+        for i in 0..<n {
+            for j in 0..<n {
+                let scale: Double = 1.0 + random.normal(mean: 0.0, standardDeviation: 1.0 / Double(n))
+                let d = Double(coupling.distance(i, j))
+                xi[i * n + j] = scale * d * d
+                xi[j * n + i] = xi[i * n + j]
+            }
+        }
+        // Cost of gate g when its qubits sit at physical positions p0 and p1
+        func gate_cost(_ g: Int, _ layout: [Int]) -> Double {
+            return xi[layout[gates[g].0] * n + layout[gates[g].1]]
+        }
+        // Loop over depths d up to a max depth of 2n+1
+        var d: Int = 1
+        var circ: [(Int,Int)] = []  // circuit for this swap slice
+        while d < 2*n+1 {
+            // Set of available qubits
+            var qubit_set = subset
+            // While there are still qubits available
+            while true {
+                // Try to decrease objective function by swapping the
+                // qubits of an edge. Only the gates acting on the two
+                // swapped qubits change cost.
+                var min_delta: Double = 0
+                var opt_edge: (Int,Int)? = nil
+                // Loop over edges of coupling graph
+                for e in edges {
+                    // Are the qubits available?
+                    if !qubit_set[e.0] || !qubit_set[e.1] {
+                        continue
                     }
-                    // Try to decrease objective function
-                    var progress_made = false
-                    // Loop over edges of coupling graph
-                    var opt_layout: OrderedDictionary<RegBit,RegBit> = OrderedDictionary<RegBit,RegBit>()
-                    var rev_opt_layout: OrderedDictionary<RegBit,RegBit> = OrderedDictionary<RegBit,RegBit>()
-                    var opt_edge: TupleRegBit? = nil
-                    for e in coupling.get_edges() {
-                        // Are the qubits available?
-                        if qubit_set.contains(e.one) && qubit_set.contains(e.two) {
-                            // Try this edge to reduce the cost
-                            var new_layout = trial_layout
-                            new_layout[rev_trial_layout[e.one]!] = e.two
-                            new_layout[rev_trial_layout[e.two]!] = e.one
-                            var rev_new_layout = rev_trial_layout
-                            rev_new_layout[e.one] = rev_trial_layout[e.two]
-                            rev_new_layout[e.two] = rev_trial_layout[e.one]
-                            // Compute the objective function
-                            var new_cost: Double = 0
-                            for g in gates {
-                                new_cost += xi[new_layout[g.0]!]![new_layout[g.1]!]!
-                            }
-                            // Record progress if we succceed
-                            if new_cost < min_cost {
-                                SDKLogger.logDebug("layer_permutation: progress! min_cost = \(min_cost)")
-                                progress_made = true
-                                min_cost = new_cost
-                                opt_layout = new_layout
-                                rev_opt_layout = rev_new_layout
-                                opt_edge = e
-                            }
-                        }
+                    let g0 = rev_trial_layout[e.0] >= 0 ? gate_of[rev_trial_layout[e.0]] : -1
+                    let g1 = rev_trial_layout[e.1] >= 0 ? gate_of[rev_trial_layout[e.1]] : -1
+                    if g0 < 0 && g1 < 0 {
+                        continue
                     }
-
-                    // Were there any good choices?
-                    if progress_made {
-                        qubit_set.remove(opt_edge!.one)
-                        qubit_set.remove(opt_edge!.two)
-                        trial_layout = opt_layout
-                        rev_trial_layout = rev_opt_layout
-                        circ += "swap \(opt_edge!.one.description),\(opt_edge!.two.description); "
-                        SDKLogger.logDebug("layer_permutation: chose pair \(SDKLogger.debugString(opt_edge!))")
+                    var delta: Double = 0
+                    if g0 >= 0 {
+                        delta -= gate_cost(g0, trial_layout)
+                    }
+                    if g1 >= 0 && g1 != g0 {
+                        delta -= gate_cost(g1, trial_layout)
+                    }
+                    Mapping.swap(&trial_layout, &rev_trial_layout, e.0, e.1)
+                    if g0 >= 0 {
+                        delta += gate_cost(g0, trial_layout)
                     }
-                    else {
-                        break
+                    if g1 >= 0 && g1 != g0 {
+                        delta += gate_cost(g1, trial_layout)
+                    }
+                    Mapping.swap(&trial_layout, &rev_trial_layout, e.0, e.1)
+                    // Record progress if we succceed
+                    if delta < min_delta {
+                        SDKLogger.logDebug("layer_permutation: progress! delta = \(delta)")
+                        min_delta = delta
+                        opt_edge = e
                     }
                 }
-                // We have either run out of qubits or failed to improve
-                // Compute the coupling graph distance
-                var dist: Int = 0
-                for g in gates {
-                    dist += try coupling.distance(trial_layout[g.0]!,trial_layout[g.1]!)
-                }
-                SDKLogger.logDebug("layer_permutation: dist = \(dist)")
-                // If all gates can be applied now, we are finished
-                // Otherwise we need to consider a deeper swap circuit
-                if dist == gates.count {
-                    SDKLogger.logDebug("layer_permutation: all can be applied now")
-                    trial_circ += circ
+
+                // Were there any good choices?
+                guard let edge = opt_edge else {
                     break
                 }
-
-                // Increment the depth
-                d += 1
-                SDKLogger.logDebug("layer_permutation: increment depth to \(d)")
+                qubit_set[edge.0] = false
+                qubit_set[edge.1] = false
+                Mapping.swap(&trial_layout, &rev_trial_layout, edge.0, edge.1)
+                circ.append(edge)
+                SDKLogger.logDebug("layer_permutation: chose pair \(SDKLogger.debugString(edge))")
             }
-            // Either we have succeeded at some depth d < dmax or failed
+            // We have either run out of qubits or failed to improve
+            // Compute the coupling graph distance
             var dist: Int = 0
             for g in gates {
-                dist += try coupling.distance(trial_layout[g.0]!,trial_layout[g.1]!)
+                dist += coupling.distance(trial_layout[g.0],trial_layout[g.1])
             }
             SDKLogger.logDebug("layer_permutation: dist = \(dist)")
+            // If all gates can be applied now, we are finished
+            // Otherwise we need to consider a deeper swap circuit
             if dist == gates.count {
-                if d < best_d {
-                    SDKLogger.logDebug("layer_permutation: got circuit with depth \(d)")
-                    best_circ = trial_circ
-                    best_layout = trial_layout
-                }
-                best_d = min(best_d, d)
+                SDKLogger.logDebug("layer_permutation: all can be applied now")
+                trial_circ += circ
+                break
             }
+
+            // Increment the depth
+            d += 1
+            SDKLogger.logDebug("layer_permutation: increment depth to \(d)")
         }
-        if best_circ == nil {
-            SDKLogger.logDebug("layer_permutation: failed!")
-            SDKLogger.logDebug("layer_permutation: ----- exit -----")
-            return (false, nil, nil, nil, false)
+        // Either we have succeeded at some depth d < dmax or failed
+        var dist: Int = 0
+        for g in gates {
+            dist += coupling.distance(trial_layout[g.0],trial_layout[g.1])
+        }
+        SDKLogger.logDebug("layer_permutation: dist = \(dist)")
+        if dist != gates.count {
+            return nil
+        }
+        SDKLogger.logDebug("layer_permutation: got circuit with depth \(d)")
+        return (d, trial_circ, trial_layout)
+    }
+
+    /**
+     Swap the virtual qubits at physical positions p0 and p1.
+     v2p maps virtual to physical positions and p2v is its inverse, -1 for
+     unused physical qubits.
+     */
+    static private func swap(_ v2p: inout [Int], _ p2v: inout [Int], _ p0: Int, _ p1: Int) {
+        let v0 = p2v[p0]
+        let v1 = p2v[p1]
+        p2v[p0] = v1
+        p2v[p1] = v0
+        if v0 >= 0 {
+            v2p[v0] = p1
+        }
+        if v1 >= 0 {
+            v2p[v1] = p0
         }
-        SDKLogger.logDebug("layer_permutation: done")
-        SDKLogger.logDebug("layer_permutation: ----- exit -----")
-        return (true, best_circ, best_d, best_layout, false)
     }
 
     /**
@@ -278,53 +367,176 @@ final class Mapping {
     }
 
     /**
-     Update the QASM string for an iteration of swap_mapper.
+     Expand the swap gates inserted by swap_mapper into cx gates.
+
+     circuit_graph = DAGCircuit returned by swap_mapper
+
+     Each swap a,b is replaced by cx a,b; cx b,a; cx a,b directly on the
+     graph, and swap is dropped from the basis.
+     */
+    static func expand_swaps(_ circuit_graph: DAGCircuit) throws {
+        if circuit_graph.basis["swap"] == nil {
+            return
+        }
+        let swap_circuit = DAGCircuit()
+        try swap_circuit.add_qreg("q", 2)
+        try swap_circuit.add_basis_element("cx", 2)
+        try swap_circuit.apply_operation_back("cx", [RegBit("q", 0), RegBit("q", 1)])
+        try swap_circuit.apply_operation_back("cx", [RegBit("q", 1), RegBit("q", 0)])
+        try swap_circuit.apply_operation_back("cx", [RegBit("q", 0), RegBit("q", 1)])
+        try circuit_graph.substitute_circuit_all("swap", swap_circuit, [RegBit("q", 0), RegBit("q", 1)])
+        try circuit_graph.remove_basis_element("swap")
+    }
+
+    /**
+     Definitions of cx and swap attached to the circuits swap_mapper emits,
+     so that swap can be printed and expanded like any other gate.
+     */
+    static private let swap_gates: [String:GateData] = {
+        var gates: [String:GateData] = [:]
+        let qasm = "OPENQASM 2.0;\n" +
+            "gate cx a,b { CX a,b; }\n" +
+            "gate swap a,b { cx a,b; cx b,a; cx a,b; }\n"
+        guard let root = try? Qasm(data: qasm).parse(),
+              let program = root.program as? NodeProgram else {
+            return gates
+        }
+        for case let gate as NodeGate in program.statements {
+            var bits: [String] = []
+            if let bitlist = gate.bitlist as? NodeIdList {
+                for b in bitlist.children {
+                    bits.append((b as! NodeId).name)
+                }
+            }
+            gates[gate.name] = GateData(false, gate.n_args, gate.n_bits, [], bits, gate.body as? NodeGateBody)
+        }
+        return gates
+    }()
+
+    /**
+     Add swap to the basis of circuit together with its definition.
+     */
+    static private func add_swap_gate(_ circuit: DAGCircuit) throws {
+        if circuit.basis["swap"] != nil {
+            return
+        }
+        for (name, gatedata) in Mapping.swap_gates {
+            try circuit.add_gate_data(name, gatedata)
+        }
+        try circuit.add_basis_element("swap", 2)
+    }
+
+    /**
+     Return circuit_graph with every operation outside of basis expanded.
+     The circuit is only unrolled when it has such operations.
+     */
+    static private func unroll_to_basis(_ circuit_graph: DAGCircuit, _ basis: [String]) throws -> DAGCircuit {
+        let primitives: Set<String> = ["U", "CX", "measure", "reset", "barrier"]
+        if !circuit_graph.basis.keys.contains(where: { !basis.contains($0) && !primitives.contains($0) }) {
+            return circuit_graph
+        }
+        let u = Unroller(try Qasm(data: circuit_graph.qasm()).parse(), DAGBackend(basis))
+        return try u.execute() as! DAGCircuit
+    }
+
+    /**
+     Check the input layout and create a default layout if necessary.
+
+     Returns the layout and the subset of coupling graph qubits it maps into.
+     */
+    static private func check_layout(_ circuit_graph: DAGCircuit,
+                                     _ coupling_graph: Coupling,
+                                     _ init_layout: OrderedDictionary<RegBit,RegBit>?) throws -> (OrderedDictionary<RegBit,RegBit>, [RegBit]) {
+        var qubit_subset: [RegBit] = []
+        if let init_layout = init_layout {
+            let circ_qubits = circuit_graph.get_qubits()
+            let coup_qubits = coupling_graph.get_qubits()
+            for (k, v) in init_layout {
+                qubit_subset.append(v)
+                if !circ_qubits.contains(k) {
+                    throw MappingError.errorQubitInputCircuit(regBit: k)
+                }
+                if !coup_qubits.contains(v) {
+                    throw MappingError.errorQubitInCouplingGraph(regBit: v)
+                }
+            }
+            return (init_layout, qubit_subset)
+        }
+        // Supply a default layout
+        qubit_subset = coupling_graph.get_qubits()
+        qubit_subset = Array(qubit_subset[0..<circuit_graph.width()])
+        var layout: OrderedDictionary<RegBit,RegBit> = OrderedDictionary<RegBit,RegBit>()
+        let qubits = circuit_graph.get_qubits()
+        for i in 0..<qubits.count {
+            if i < qubit_subset.count {
+                layout[qubits[i]] = qubit_subset[i]
+            }
+            else {
+                break
+            }
+        }
+        return (layout, qubit_subset)
+    }
+
+    /**
+     Return the empty output circuit of a mapper, declaring the coupling
+     graph registers used by layout.
+     */
+    static private func mapped_circuit(_ circuit_graph: DAGCircuit,
+                                       _ layout: OrderedDictionary<RegBit,RegBit>) throws -> DAGCircuit {
+        var qregdata: OrderedDictionary<String,Int> = OrderedDictionary<String,Int>()
+        for (_,q) in layout {
+            qregdata[q.name] = max(qregdata[q.name] ?? 0, q.index + 1)
+        }
+        return try circuit_graph.empty_copy(qregdata)
+    }
+
+    /**
+     Append the gates of an iteration of swap_mapper to the output circuit.
 
      i = layer number
      first_layer = True if this is the first layer with multi-qubit gates
      best_layout = layout returned from swap algorithm
      best_d = depth returns from swap algorithm
-     best_circ = swap circuit returned from swap algorithm
-     circuit_graph = original input circuit
+     best_swaps = swap circuit returned from swap algorithm
      layer_list = list of circuit objects for each layer
-
-     Return openqasm_output, the QASM string to append.
-    */
-    static func update_qasm(_ i: Int,
-                            _ first_layer: Bool,
-                            _ best_layout: OrderedDictionary<RegBit,RegBit>,
-                            _ best_d: Int,
-                            _ best_circ: String,
-                            _ circuit_graph: DAGCircuit,
-                            _ layer_list: [Layer]) throws -> String {
-        var openqasm_output = ""
+     circuit = output circuit on the coupling graph qubits
+     */
+    static private func update_circuit(_ i: Int,
+                                       _ first_layer: Bool,
+                                       _ best_layout: OrderedDictionary<RegBit,RegBit>,
+                                       _ best_d: Int,
+                                       _ best_swaps: [(RegBit,RegBit)],
+                                       _ layer_list: [Layer],
+                                       _ circuit: DAGCircuit) throws {
         let layout = best_layout
 
         // If this is the first layer with multi-qubit gates,
         // output all layers up to this point and ignore any
         // swap gates. Set the initial layout.
         if first_layer {
-            SDKLogger.logDebug("update_qasm_and_layout: first multi-qubit gate layer")
+            SDKLogger.logDebug("update_circuit: first multi-qubit gate layer")
             // Output all layers up to this point
-            openqasm_output += try circuit_graph.qasm(decls_only: true, add_swap: true,aliases: layout)
             for j in 0..<(i+1) {
-                openqasm_output += try layer_list[j].graph.qasm(no_decls: true,aliases: layout)
+                try circuit.apply_circuit_back(layer_list[j].graph, layout)
             }
         }
         // Otherwise, we output the current layer and the associated swap gates.
         else {
             // Output any swaps
             if best_d > 0 {
-                SDKLogger.logDebug("update_qasm_and_layout: swaps in this layer, depth \(best_d)")
-                openqasm_output += best_circ
+                SDKLogger.logDebug("update_circuit: swaps in this layer, depth \(best_d)")
+                try Mapping.add_swap_gate(circuit)
+                for (q0, q1) in best_swaps {
+                    try circuit.apply_operation_back("swap", [q0, q1])
+                }
             }
             else {
-                SDKLogger.logDebug("update_qasm_and_layout: no swaps in this layer")
+                SDKLogger.logDebug("update_circuit: no swaps in this layer")
             }
             // Output this layer
-            openqasm_output += try layer_list[i].graph.qasm(no_decls: true,aliases: layout)
+            try circuit.apply_circuit_back(layer_list[i].graph, layout)
         }
-        return openqasm_output
     }
 
     /**
@@ -355,7 +567,7 @@ final class Mapping {
         if circuit_graph.width() > coupling_graph.size() {
             throw MappingError.errorQubitsCouplingGraph
         }
-        var basis = b
+        let circuit_graph = try Mapping.unroll_to_basis(circuit_graph, b.components(separatedBy: ",") + ["swap"])
 
         // Schedule the input circuit
         let layerlist = try circuit_graph.layers()
@@ -370,48 +582,19 @@ final class Mapping {
         }
 
         // Check input layout and create default layout if necessary
-        var qubit_subset: [RegBit] = []
-        var initial_layout = init_layout
-        if let init_layout = initial_layout {
-            let circ_qubits = circuit_graph.get_qubits()
-            let coup_qubits = coupling_graph.get_qubits()
-            for (k, v) in init_layout {
-                qubit_subset.append(v)
-                if !circ_qubits.contains(k) {
-                    throw MappingError.errorQubitInputCircuit(regBit: k)
-                }
-                if !coup_qubits.contains(v) {
-                    throw MappingError.errorQubitInCouplingGraph(regBit: v)
-                }
-            }
-        }
-        else {
-            // Supply a default layout
-            qubit_subset = coupling_graph.get_qubits()
-            qubit_subset = Array(qubit_subset[0..<circuit_graph.width()])
-            var init_layout: OrderedDictionary<RegBit,RegBit> = OrderedDictionary<RegBit,RegBit>()
-            let qubits = circuit_graph.get_qubits()
-            for i in 0..<qubits.count {
-                if i < qubit_subset.count {
-                    init_layout[qubits[i]] = qubit_subset[i]
-                }
-                else {
-                    break
-                }
-            }
-            initial_layout = init_layout
-        }
+        let (checked_layout, qubit_subset) = try Mapping.check_layout(circuit_graph, coupling_graph, init_layout)
+        var initial_layout = checked_layout
 
         // Find swap circuit to preceed to each layer of input circuit
-        var layout = initial_layout!
-        var openqasm_output = ""
+        var layout = checked_layout
+        let circuit = try Mapping.mapped_circuit(circuit_graph, layout)
         var first_layer = true  // True until first layer is output
         SDKLogger.logDebug("initial_layout = \(SDKLogger.debugString(layout))")
 
         // Iterate over layers
         for (i,layer) in layerlist.enumerated() {
             // Attempt to find a permutation for this layer
-            let (success_flag, best_circ, best_d, best_layout, trivial_flag) =
+            let (success_flag, best_swaps, best_d, best_layout, trivial_flag) =
                 try Mapping.layer_permutation(layer.partition, layout, qubit_subset, coupling_graph, trials, seed)
             SDKLogger.logDebug("swap_mapper: layer: \(i)")
             SDKLogger.logDebug("swap_mapper: success_flag=\(success_flag),best_d=\(best_d ?? 0),trivial_flag=\(trivial_flag)")
@@ -423,7 +606,7 @@ final class Mapping {
 
                 // Go through each gate in the layer
                 for (j,serial_layer) in serial_layerlist.enumerated() {
-                    let (success_flag, best_circ, best_d, best_layout, trivial_flag) =
+                    let (success_flag, best_swaps, best_d, best_layout, trivial_flag) =
                             try Mapping.layer_permutation(serial_layer.partition,
                                                           layout, qubit_subset, coupling_graph,trials,seed)
                     SDKLogger.logDebug("swap_mapper: layer \(i), sublayer \(j)")
@@ -441,9 +624,9 @@ final class Mapping {
                         continue
                     }
                     // Update the record of qubit positions for each inner iteration
-                    let layout = best_layout!
-                    // Update the QASM
-                    openqasm_output += try Mapping.update_qasm(j, first_layer, best_layout!, best_d!, best_circ!, circuit_graph, serial_layerlist)
+                    layout = best_layout!
+                    // Update the circuit
+                    try Mapping.update_circuit(j, first_layer, best_layout!, best_d!, best_swaps!, serial_layerlist, circuit)
                     // Update initial layout
                     if first_layer {
                         initial_layout = layout
@@ -454,8 +637,8 @@ final class Mapping {
             else {
                 // Update the qubit positions each iteration
                 layout = best_layout!
-                // Update the QASM
-                openqasm_output += try update_qasm(i, first_layer, best_layout!, best_d!, best_circ!, circuit_graph, layerlist)
+                // Update the circuit
+                try Mapping.update_circuit(i, first_layer, best_layout!, best_d!, best_swaps!, layerlist, circuit)
                 // Update initial layout
                 if first_layer {
                     initial_layout = layout
@@ -467,18 +650,284 @@ final class Mapping {
         // If first_layer is still set, the circuit only has single-qubit gates
         // so we can use the initial layout to output the entire circuit
         if first_layer {
-            let layout = initial_layout
-            openqasm_output += try circuit_graph.qasm(decls_only: true, add_swap: true,aliases: layout)
             for layer in layerlist {
-                openqasm_output += try layer.graph.qasm(no_decls: true,aliases: layout)
+                try circuit.apply_circuit_back(layer.graph, initial_layout)
+            }
+        }
+        return (circuit, initial_layout)
+    }
+
+    /**
+     Map a DAGCircuit onto a CouplingGraph using swap gates chosen with a
+     front layer and lookahead heuristic.
+
+     Operations are routed in dependency order. The front layer holds the
+     operations whose predecessors have all been output. Every operation of
+     the front layer that the current layout allows is output; when none
+     is, the swap next to a blocked two-qubit gate that most reduces the
+     distance of the front layer gates, plus lookahead_weight times the
+     distance of the next lookahead two-qubit gates, is inserted. A swap
+     only changes the cost of the gates on its two qubits, so candidates
+     are scored incrementally from the distance matrix. If the heuristic
+     stops making progress, the first blocked gate is routed along a
+     shortest path.
+
+     Args:
+        circuit_graph (DAGCircuit): input DAG circuit
+        coupling_graph (CouplingGraph): coupling graph to map onto
+        initial_layout (dict): dict from qubits of circuit_graph to qubits
+        of coupling_graph (optional)
+        basis (str, optional): basis string specifying basis of output
+            DAGCircuit
+        lookahead (int): number of two-qubit gates after the front layer
+            taken into account, looked for among at most
+            lookahead_scan_factor * lookahead gates
+        lookahead_weight (float): weight of those gates in the cost
+
+     Returns:
+         Returns a DAGCircuit object containing a circuit equivalent to
+         circuit_graph that respects couplings in coupling_graph, and
+         the initial layout dict mapping qubits of circuit_graph into
+         qubits of coupling_graph.
+     */
+    static func lookahead_mapper(_ circuit_graph: DAGCircuit,
+                                 _ coupling_graph: Coupling,
+                                 _ init_layout: OrderedDictionary<RegBit,RegBit>? = nil,
+                                 _ b: String = "cx,u1,u2,u3,id",
+                                 lookahead: Int = 20,
+                                 lookahead_weight: Double = 0.5) throws -> (DAGCircuit, OrderedDictionary<RegBit,RegBit>) {
+        if circuit_graph.width() > coupling_graph.size() {
+            throw MappingError.errorQubitsCouplingGraph
+        }
+        let circuit_graph = try Mapping.unroll_to_basis(circuit_graph, b.components(separatedBy: ",") + ["swap"])
+        let (initial_layout, qubit_subset) = try Mapping.check_layout(circuit_graph, coupling_graph, init_layout)
+        let circuit = try Mapping.mapped_circuit(circuit_graph, initial_layout)
+        SDKLogger.logDebug("lookahead_mapper: initial_layout = \(SDKLogger.debugString(initial_layout))")
+
+        // Work on positions as layer_permutation does
+        let n = coupling_graph.size()
+        let physical_qubits = coupling_graph.get_qubits()
+        var virtual_indices: [RegBit:Int] = [:]
+        var v2p: [Int] = []
+        var p2v = [Int](repeating: -1, count: n)
+        for (regBit, q) in initial_layout {
+            let p = try coupling_graph.qubit_index(q)
+            virtual_indices[regBit] = v2p.count
+            p2v[p] = v2p.count
+            v2p.append(p)
+        }
+        var subset = [Bool](repeating: false, count: n)
+        for regBit in qubit_subset {
+            subset[try coupling_graph.qubit_index(regBit)] = true
+        }
+        let (dist, neighbors) = Mapping.subset_distances(coupling_graph, subset)
+
+        // Dependencies between the operations of the input circuit
+        let (ops, successors) = try circuit_graph.op_successors()
+        var op_qubits: [[Int]] = []
+        for op in ops {
+            var qubits: [Int] = []
+            for qarg in op.qargs {
+                guard let v = virtual_indices[qarg] else {
+                    throw MappingError.errorQubitInputCircuit(regBit: qarg)
+                }
+                qubits.append(v)
+            }
+            if qubits.count > 2 && op.name != "barrier" {
+                throw MappingError.layoutError
+            }
+            op_qubits.append(qubits)
+        }
+        func is_two_qubit(_ i: Int) -> Bool {
+            return op_qubits[i].count == 2 && ops[i].name != "barrier"
+        }
+        func gate_distance(_ i: Int) -> Int {
+            return dist[v2p[op_qubits[i][0]] * n + v2p[op_qubits[i][1]]]
+        }
+        func op_qasm(_ i: Int) -> String {
+            let qargs = ops[i].qargs.map { $0.qasm }
+            return "\(ops[i].name) \(qargs.joined(separator: ","));"
+        }
+        // Change in distance of the gates of gates_of on the qubits at
+        // positions p0 and p1 if those qubits were swapped
+        func swap_delta(_ gates_of: [[Int]], _ p0: Int, _ p1: Int) -> Int {
+            func moved(_ p: Int) -> Int {
+                return p == p0 ? p1 : (p == p1 ? p0 : p)
+            }
+            var delta = 0
+            var counted: [Int] = []
+            for v in [p2v[p0], p2v[p1]] where v >= 0 {
+                for g in gates_of[v] where !counted.contains(g) {
+                    counted.append(g)
+                    let a = v2p[op_qubits[g][0]]
+                    let b = v2p[op_qubits[g][1]]
+                    delta += dist[moved(a) * n + moved(b)] - dist[a * n + b]
+                }
+            }
+            return delta
+        }
+
+        let lookahead_scan = Mapping.lookahead_scan_factor * lookahead
+        var pending = [Int](repeating: 0, count: ops.count)
+        for list in successors {
+            for j in list {
+                pending[j] += 1
+            }
+        }
+        var front: [Int] = (0..<ops.count).filter { pending[$0] == 0 }
+        var swaps_since_progress = 0
+        var last_swap: (Int,Int)? = nil
+        var swap_count = 0
+        while !front.isEmpty {
+            // Output every operation of the front layer the layout allows
+            var blocked: [Int] = []
+            var ready: [Int] = []
+            for i in front {
+                if is_two_qubit(i) && gate_distance(i) != 1 {
+                    blocked.append(i)
+                }
+                else {
+                    ready.append(i)
+                }
+            }
+            if !ready.isEmpty {
+                for i in ready {
+                    let op = ops[i]
+                    let qargs = op_qubits[i].map { physical_qubits[v2p[$0]] }
+                    try circuit.apply_operation_back(op.name, qargs, op.cargs, op.params, op.condition)
+                    for j in successors[i] {
+                        pending[j] -= 1
+                        if pending[j] == 0 {
+                            blocked.append(j)
+                        }
+                    }
+                }
+                front = blocked.sorted()
+                swaps_since_progress = 0
+                last_swap = nil
+                continue
+            }
+
+            // Next two-qubit gates after the front layer, searched among a
+            // bounded number of gates so that a long tail of single qubit
+            // gates is not walked again for every swap
+            var extended: [Int] = []
+            var queue = front
+            var seen = Set<Int>(front)
+            var k = 0
+            while k < queue.count && queue.count < front.count + lookahead_scan && extended.count < lookahead {
+                for j in successors[queue[k]] where !seen.contains(j) {
+                    seen.insert(j)
+                    queue.append(j)
+                    if is_two_qubit(j) && extended.count < lookahead {
+                        extended.append(j)
+                    }
+                }
+                k += 1
+            }
+            var front_of = [[Int]](repeating: [], count: v2p.count)
+            for g in front {
+                front_of[op_qubits[g][0]].append(g)
+                front_of[op_qubits[g][1]].append(g)
+            }
+            var extended_of = [[Int]](repeating: [], count: v2p.count)
+            for g in extended {
+                extended_of[op_qubits[g][0]].append(g)
+                extended_of[op_qubits[g][1]].append(g)
+            }
+
+            var opt_edge: (Int,Int)? = nil
+            if swaps_since_progress < n {
+                // Score the swaps on edges next to the blocked gates
+                var min_score: Double = Double.greatestFiniteMagnitude
+                var candidates = Set<Int>()
+                for g in front {
+                    for v in op_qubits[g] {
+                        let p0 = v2p[v]
+                        for p1 in neighbors[p0] {
+                            let edge = (min(p0, p1), max(p0, p1))
+                            if candidates.contains(edge.0 * n + edge.1) {
+                                continue
+                            }
+                            candidates.insert(edge.0 * n + edge.1)
+                            if let last = last_swap, last == edge {
+                                continue
+                            }
+                            var score = Double(swap_delta(front_of, edge.0, edge.1)) / Double(front.count)
+                            if !extended.isEmpty {
+                                score += lookahead_weight * Double(swap_delta(extended_of, edge.0, edge.1)) / Double(extended.count)
+                            }
+                            if score < min_score {
+                                min_score = score
+                                opt_edge = edge
+                            }
+                        }
+                    }
+                }
+            }
+            else {
+                // No progress: move the first blocked gate one step closer
+                let g = front[0]
+                let p0 = v2p[op_qubits[g][0]]
+                let p1 = v2p[op_qubits[g][1]]
+                if let p = neighbors[p0].first(where: { dist[$0 * n + p1] < dist[p0 * n + p1] }) {
+                    opt_edge = (min(p0, p), max(p0, p))
+                }
+                SDKLogger.logDebug("lookahead_mapper: routing \(op_qasm(g)) along a shortest path")
+            }
+            guard let edge = opt_edge else {
+                throw MappingError.lookaheadMapperFailed(qasm: op_qasm(front[0]))
             }
+            try Mapping.add_swap_gate(circuit)
+            try circuit.apply_operation_back("swap", [physical_qubits[edge.0], physical_qubits[edge.1]])
+            Mapping.swap(&v2p, &p2v, edge.0, edge.1)
+            last_swap = edge
+            swaps_since_progress += 1
+            swap_count += 1
         }
+        SDKLogger.logDebug("lookahead_mapper: \(swap_count) swaps inserted")
+        return (circuit, initial_layout)
+    }
 
-        // Parse openqasm_output into Circuit object
-        basis += ",swap"
-        let u = Unroller(try Qasm(data: openqasm_output).parse(), DAGBackend(basis.components(separatedBy:",")))
-        let circuit = try u.execute() as! DAGCircuit
-        return (circuit, initial_layout!)
+    /**
+     Return the distances between the qubits of coupling restricted to the
+     positions flagged in subset, as a row-major matrix over all positions,
+     and the neighbors of each position within subset. Positions that
+     cannot reach each other within subset are size() apart.
+     */
+    static private func subset_distances(_ coupling: Coupling, _ subset: [Bool]) -> ([Int], [[Int]]) {
+        let n = coupling.size()
+        var neighbors = [[Int]](repeating: [], count: n)
+        for e in coupling.get_edge_indices() where subset[e.0] && subset[e.1] {
+            if !neighbors[e.0].contains(e.1) {
+                neighbors[e.0].append(e.1)
+                neighbors[e.1].append(e.0)
+            }
+        }
+        var dist = [Int](repeating: n, count: n * n)
+        if !subset.contains(false) {
+            // The whole coupling graph: use its distance matrix
+            for i in 0..<n {
+                for j in 0..<n {
+                    dist[i * n + j] = coupling.distance(i, j)
+                }
+            }
+            return (dist, neighbors)
+        }
+        for source in 0..<n where subset[source] {
+            dist[source * n + source] = 0
+            var queue = [source]
+            var k = 0
+            while k < queue.count {
+                let p = queue[k]
+                for q in neighbors[p] where dist[source * n + q] == n {
+                    dist[source * n + q] = dist[source * n + p] + 1
+                    queue.append(q)
+                }
+                k += 1
+            }
+        }
+        return (dist, neighbors)
     }
 
     /**
@@ -637,174 +1086,249 @@ final class Mapping {
     }
 
     /**
-     Cancel back-to-back "cx" gates in circuit.
+     Single qubit gates merged by the peephole optimizer. h is read as
+     u2(0,pi), as qelib1.inc defines it.
      */
-    static func cx_cancellation(_ circuit: DAGCircuit) throws {
-        let runs = try circuit.collect_runs(["cx"])
-        for run in runs {
-            // Partition the run into chunks with equal gate arguments
-            var partition: [[GraphVertex<CircuitVertexData>]] = []
-            var chunk: [GraphVertex<CircuitVertexData>] = []
-            for i in 0..<(run.count-1) {
-                chunk.append(run[i])
-                let qargs0 = (run[i].data as! CircuitVertexOpData).qargs
-                let qargs1 = (run[i + 1].data as! CircuitVertexOpData).qargs
-                if qargs0 != qargs1 {
-                    partition.append(chunk)
-                    chunk = []
-                }
-            }
-            chunk.append(run[run.count-1])
-            partition.append(chunk)
-            // Simplify each chunk in the partition
-            for chunk in partition {
-                if chunk.count % 2 == 0 {
-                    for n in chunk {
-                        circuit._remove_op_node(n.key)
-                    }
+    static private let single_qubit_gates: Set<String> = ["u1", "u2", "u3", "id", "h"]
+
+    /**
+     Gates visited by lookahead_mapper per lookahead gate when looking for
+     the next two-qubit gates.
+     */
+    static private let lookahead_scan_factor = 10
+
+    /**
+     Compose a run of single qubit gates on one qubit into a single gate.
+     Returns its name, "nop" for the identity, and its parameters.
+     */
+    static private func compose_1q_run(_ run: [CircuitVertexOpData]) -> (String, [SymbolicValue]) {
+        var right_name = "u1"
+        var right_parameters: (SymbolicValue, SymbolicValue, SymbolicValue) = (0.0, 0.0, 0.0)  // (theta, phi, lambda)
+        for nd in run {
+            assert(nd.condition == nil, "internal error")
+            assert(nd.qargs.count == 1, "internal error")
+            var left_name = nd.name
+            assert(Mapping.single_qubit_gates.contains(left_name), "internal error")
+            var left_parameters: (SymbolicValue, SymbolicValue, SymbolicValue) = (0.0,0.0,0.0)
+            if left_name == "u1" {
+                left_parameters = (0.0, 0.0, nd.params[0])
+            }
+            else if left_name == "u2" {
+                left_parameters = (SymbolicValue.pi / 2.0, nd.params[0], nd.params[1])
+            }
+            else if left_name == "u3" {
+                left_parameters = (nd.params[0], nd.params[1], nd.params[2])
+            }
+            else if left_name == "h" {
+                left_name = "u2"  // h is u2(0,pi)
+                left_parameters = (SymbolicValue.pi / 2.0, 0.0, SymbolicValue.pi)
+            }
+            else {
+                left_name = "u1"  // replace id with u1
+                left_parameters = (0.0, 0.0, 0.0)
+            }
+            // Compose gates
+            let name_tuple = (left_name, right_name)
+            if name_tuple == ("u1", "u1") {
+                // u1(lambda1) * u1(lambda2) = u1(lambda1 + lambda2)
+                right_parameters = (0.0, 0.0, right_parameters.2 + left_parameters.2)
+            }
+            else if name_tuple == ("u1", "u2") {
+                // u1(lambda1) * u2(phi2, lambda2) = u2(phi2 + lambda1, lambda2)
+                right_parameters = (SymbolicValue.pi / 2, right_parameters.1 + left_parameters.2, right_parameters.2)
+            }
+            else if name_tuple == ("u2", "u1") {
+                // u2(phi1, lambda1) * u1(lambda2) = u2(phi1, lambda1 + lambda2)
+                right_name = "u2"
+                right_parameters = (SymbolicValue.pi / 2.0, left_parameters.1, right_parameters.2 + left_parameters.2)
+            }
+            else if name_tuple == ("u1", "u3") {
+                // u1(lambda1) * u3(theta2, phi2, lambda2) =
+                //     u3(theta2, phi2 + lambda1, lambda2)
+                right_parameters = (right_parameters.0, right_parameters.1 + left_parameters.2, right_parameters.2)
+            }
+            else if name_tuple == ("u3", "u1") {
+                // u3(theta1, phi1, lambda1) * u1(lambda2) =
+                //    u3(theta1, phi1, lambda1 + lambda2)
+                right_name = "u3"
+                right_parameters = (left_parameters.0, left_parameters.1, right_parameters.2 + left_parameters.2)
+            }
+            else if name_tuple == ("u2", "u2") {
+                // Using Ry(pi/2).Rz(2*lambda).Ry(pi/2) =
+                //    Rz(pi/2).Ry(pi-2*lambda).Rz(pi/2),
+                // u2(phi1, lambda1) * u2(phi2, lambda2) =
+                //    u3(pi - lambda1 - phi2, phi1 + pi/2, lambda2 + pi/2)
+                right_name = "u3"
+                right_parameters = (SymbolicValue.pi - left_parameters.2 - right_parameters.1, left_parameters.1 + SymbolicValue.pi / 2.0, right_parameters.2 + SymbolicValue.pi / 2)
+            }
+            else if name_tuple.1 == "nop" {
+                right_name = left_name
+                right_parameters = left_parameters
+            }
+            else {
+                // For composing u3's or u2's with u3's, use
+                // u2(phi, lambda) = u3(pi/2, phi, lambda)
+                // together with the qiskit.mapper.compose_u3 method.
+                right_name = "u3"
+                right_parameters = Mapping.compose_u3(left_parameters.0,
+                                                left_parameters.1,
+                                                left_parameters.2,
+                                                right_parameters.0,
+                                                right_parameters.1,
+                                                right_parameters.2)
+            }
+            // Here down, when we simplify, we add f(theta) to lambda to correct
+            // the global phase when f(theta) is 2*pi. This isn't necessary but
+            // the other steps preserve the global phase, so we continue.
+            let epsilon = 1e-9  // for comparison with zero
+            // Y rotation is 0 mod 2*pi, so the gate is a u1
+            if abs(right_parameters.0.truncatingRemainder(dividingBy: 2.0 * SymbolicValue.pi)) < epsilon && right_name != "u1" {
+                right_name = "u1"
+                right_parameters = (0.0, 0.0, right_parameters.1 + right_parameters.2 + right_parameters.0)
+            }
+            // Y rotation is pi/2 or -pi/2 mod 2*pi, so the gate is a u2
+            if right_name == "u3" {
+                // theta = pi/2 + 2*k*pi
+                if abs((right_parameters.0 - SymbolicValue.pi / 2.0).truncatingRemainder(dividingBy: 2.0 * SymbolicValue.pi)) < epsilon {
+                    right_name = "u2"
+                    right_parameters = (SymbolicValue.pi / 2.0, right_parameters.1, right_parameters.2 + (right_parameters.0 - SymbolicValue.pi / 2.0))
                 }
-                else {
-                    for i in 1..<chunk.count {
-                        circuit._remove_op_node(chunk[i].key)
-                    }
+                // theta = -pi/2 + 2*k*pi
+                if abs((right_parameters.0 + SymbolicValue.pi / 2.0).truncatingRemainder(dividingBy: 2.0 * SymbolicValue.pi)) < epsilon {
+                    right_name = "u2"
+                    right_parameters = (SymbolicValue.pi / 2.0, right_parameters.1 + SymbolicValue.pi, right_parameters.2 - SymbolicValue.pi + (right_parameters.0 + SymbolicValue.pi / 2.0))
                 }
             }
+            // u1 and lambda is 0 mod 4*pi so gate is nop
+            if right_name == "u1" && abs(right_parameters.2.truncatingRemainder(dividingBy: 4.0 * SymbolicValue.pi)) < epsilon {
+                right_name = "nop"
+            }
+        }
+        var new_params: [SymbolicValue] = []
+        if right_name == "u1" {
+            new_params.append(right_parameters.2)
+        }
+        if right_name == "u2" {
+            new_params = [right_parameters.1, right_parameters.2]
         }
+        if right_name == "u3" {
+            new_params = [right_parameters.0, right_parameters.1, right_parameters.2]
+        }
+        return (right_name, new_params)
     }
 
     /**
-     "Simplify runs of single qubit gates in the QX basis.
-     Return a new circuit that has been optimized.
+     One topological sweep of the peephole optimizer over circuit.
+     Runs of single qubit gates are merged into one gate, or removed when
+     they compose to the identity. If cancel_cx is set, two cx gates on the
+     same qubits separated only by such identity runs cancel. Gates with
+     params computed from circuit parameters are left as they are so that
+     the circuit can still be bound to new values. Gates are edited and
+     removed in place.
+     Returns True if the circuit changed.
      */
-    static func optimize_1q_gates(_ circuit: DAGCircuit) throws -> DAGCircuit {
-        let qx_basis = ["u1", "u2", "u3", "cx", "id"]
-        let urlr = try Unroller(Qasm(data: circuit.qasm()).parse(), DAGBackend(qx_basis))
-        let unrolled = try urlr.execute() as! DAGCircuit
-       
-        let runs = try unrolled.collect_runs(["u1", "u2", "u3", "id"])
-        for run in runs {
-            let qname = (run[0].data as! CircuitVertexOpData).qargs[0]
-            var right_name = "u1"
-            var right_parameters: (SymbolicValue, SymbolicValue, SymbolicValue) = (0.0, 0.0, 0.0)  // (theta, phi, lambda)
-            for node in run {
-                let nd = node.data as! CircuitVertexOpData
-                assert(nd.condition == nil, "internal error")
-                assert(nd.qargs.count == 1, "internal error")
-                assert(nd.qargs[0] == qname, "internal error")
-                var left_name = nd.name
-                assert(Set<String>(["u1", "u2", "u3", "id"]).contains(left_name), "internal error")
-                var left_parameters: (SymbolicValue, SymbolicValue, SymbolicValue) = (0.0,0.0,0.0)
-                if left_name == "u1" {
-                    left_parameters = (0.0, 0.0, nd.params[0])
-                }
-                else if left_name == "u2" {
-                    left_parameters = (SymbolicValue.pi / 2.0, nd.params[0], nd.params[1])
-                }
-                else if left_name == "u3" {
-                    left_parameters = (nd.params[0], nd.params[1], nd.params[2])
-                }
-                else {
-                    left_name = "u1"  // replace id with u1
-                    left_parameters = (0.0, 0.0, 0.0)
-                }
-                // Compose gates
-                let name_tuple = (left_name, right_name)
-                if name_tuple == ("u1", "u1") {
-                    // u1(lambda1) * u1(lambda2) = u1(lambda1 + lambda2)
-                    right_parameters = (0.0, 0.0, right_parameters.2 + left_parameters.2)
-                }
-                else if name_tuple == ("u1", "u2") {
-                    // u1(lambda1) * u2(phi2, lambda2) = u2(phi2 + lambda1, lambda2)
-                    right_parameters = (SymbolicValue.pi / 2, right_parameters.1 + left_parameters.2, right_parameters.2)
-                }
-                else if name_tuple == ("u2", "u1") {
-                    // u2(phi1, lambda1) * u1(lambda2) = u2(phi1, lambda1 + lambda2)
-                    right_name = "u2"
-                    right_parameters = (SymbolicValue.pi / 2.0, left_parameters.1, right_parameters.2 + left_parameters.2)
-                }
-                else if name_tuple == ("u1", "u3") {
-                    // u1(lambda1) * u3(theta2, phi2, lambda2) =
-                    //     u3(theta2, phi2 + lambda1, lambda2)
-                    right_parameters = (right_parameters.0, right_parameters.1 + left_parameters.2, right_parameters.2)
-                }
-                else if name_tuple == ("u3", "u1") {
-                    // u3(theta1, phi1, lambda1) * u1(lambda2) =
-                    //    u3(theta1, phi1, lambda1 + lambda2)
-                    right_name = "u3"
-                    right_parameters = (left_parameters.0, left_parameters.1, right_parameters.2 + left_parameters.2)
-                }
-                else if name_tuple == ("u2", "u2") {
-                    // Using Ry(pi/2).Rz(2*lambda).Ry(pi/2) =
-                    //    Rz(pi/2).Ry(pi-2*lambda).Rz(pi/2),
-                    // u2(phi1, lambda1) * u2(phi2, lambda2) =
-                    //    u3(pi - lambda1 - phi2, phi1 + pi/2, lambda2 + pi/2)
-                    right_name = "u3"
-                    right_parameters = (SymbolicValue.pi - left_parameters.2 - right_parameters.1, left_parameters.1 + SymbolicValue.pi / 2.0, right_parameters.2 + SymbolicValue.pi / 2)
-                }
-                else if name_tuple.1 == "nop" {
-                    right_name = left_name
-                    right_parameters = left_parameters
-                }
-                else {
-                    // For composing u3's or u2's with u3's, use
-                    // u2(phi, lambda) = u3(pi/2, phi, lambda)
-                    // together with the qiskit.mapper.compose_u3 method.
-                    right_name = "u3"
-                    right_parameters = Mapping.compose_u3(left_parameters.0,
-                                                    left_parameters.1,
-                                                    left_parameters.2,
-                                                    right_parameters.0,
-                                                    right_parameters.1,
-                                                    right_parameters.2)
-                }
-                // Here down, when we simplify, we add f(theta) to lambda to correct
-                // the global phase when f(theta) is 2*pi. This isn't necessary but
-                // the other steps preserve the global phase, so we continue.
-                let epsilon = 1e-9  // for comparison with zero
-                // Y rotation is 0 mod 2*pi, so the gate is a u1
-                if abs(right_parameters.0.truncatingRemainder(dividingBy: 2.0) * SymbolicValue.pi) < epsilon && right_name != "u1" {
-                    right_name = "u1"
-                    right_parameters = (0.0, 0.0, right_parameters.1 + right_parameters.2 + right_parameters.0)
-                }
-                // Y rotation is pi/2 or -pi/2 mod 2*pi, so the gate is a u2
-                if right_name == "u3" {
-                    // theta = pi/2 + 2*k*pi
-                    if abs((right_parameters.0 - SymbolicValue.pi / 2.0).truncatingRemainder(dividingBy: 2.0) * SymbolicValue.pi) < epsilon {
-                        right_name = "u2"
-                        right_parameters = (SymbolicValue.pi / 2.0, right_parameters.1, right_parameters.2 + (right_parameters.0 - SymbolicValue.pi / 2.0))
-                    }
-                    // theta = -pi/2 + 2*k*pi
-                    if abs((right_parameters.0 + SymbolicValue.pi / 2.0).truncatingRemainder(dividingBy: 2.0) * SymbolicValue.pi) < epsilon {
-                        right_name = "u2"
-                        right_parameters = (SymbolicValue.pi / 2.0, right_parameters.1 + SymbolicValue.pi, right_parameters.2 - SymbolicValue.pi + (right_parameters.0 + SymbolicValue.pi / 2.0))
-                    }
-                }
-                // u1 and lambda is 0 mod 4*pi so gate is nop
-                if right_name == "u1" && abs(right_parameters.2.truncatingRemainder(dividingBy: 4.0) * SymbolicValue.pi) < epsilon {
-                    right_name = "nop"
-                }
+    static private func peephole_sweep(_ circuit: DAGCircuit, _ cancel_cx: Bool) throws -> Bool {
+        var changed = false
+        var runs: [RegBit:[GraphVertex<CircuitVertexData>]] = [:]
+        var last_cx: [RegBit:GraphVertex<CircuitVertexData>] = [:]
+
+        // Replace the run on qubit q by its composition.
+        // Returns True if a gate is left on the wire.
+        func flush(_ q: RegBit) throws -> Bool {
+            guard let run = runs.removeValue(forKey: q), !run.isEmpty else {
+                return false
             }
-            // Replace the data of the first node in the run
-            var new_params: [SymbolicValue] = []
-            if right_name == "u1" {
-                new_params.append(right_parameters.2)
+            let first = run[0].data as! CircuitVertexOpData
+            let (name, params) = Mapping.compose_1q_run(run.map { $0.data as! CircuitVertexOpData })
+            for i in 1..<run.count {
+                circuit._remove_op_node(run[i].key)
             }
-            if right_name == "u2" {
-                new_params = [right_parameters.1, right_parameters.2]
+            if name == "nop" {
+                circuit._remove_op_node(run[0].key)
+                changed = true
+                return false
             }
-            if right_name == "u3" {
-                new_params = [right_parameters.0, right_parameters.1, right_parameters.2]
+            if run.count > 1 || name != first.name || params != first.params {
+                changed = true
+                if circuit.basis[name] == nil {
+                    try circuit.add_basis_element(name, 1, 0, params.count)
+                }
+                first.name = name
+                first.params = params
             }
-            (run[0].data as! CircuitVertexOpData).name = right_name
-            (run[0].data as! CircuitVertexOpData).params = new_params
-            // Delete the other nodes in the run
-            for i in 1..<run.count {
-                unrolled._remove_op_node(run[i].key)
+            return true
+        }
+
+        for node in try circuit.topological_op_nodes() {
+            let nd = node.data as! CircuitVertexOpData
+            if nd.condition == nil && nd.qargs.count == 1 && nd.cargs.isEmpty &&
+                Mapping.single_qubit_gates.contains(nd.name) &&
+                !nd.params.contains(where: { $0.parameter != nil }) {
+                runs[nd.qargs[0], default: []].append(node)
+                continue
+            }
+            for q in nd.qargs {
+                if try flush(q) {
+                    last_cx[q] = nil
+                }
             }
-            if right_name == "nop" {
-                unrolled._remove_op_node(run[0].key)
+            if cancel_cx && nd.name == "cx" && nd.condition == nil {
+                let q0 = nd.qargs[0]
+                let q1 = nd.qargs[1]
+                if let prev = last_cx[q0], prev === last_cx[q1],
+                    (prev.data as! CircuitVertexOpData).qargs == nd.qargs {
+                    circuit._remove_op_node(prev.key)
+                    circuit._remove_op_node(node.key)
+                    last_cx[q0] = nil
+                    last_cx[q1] = nil
+                    changed = true
+                    continue
+                }
+                last_cx[q0] = node
+                last_cx[q1] = node
+                continue
             }
+            for q in nd.qargs {
+                last_cx[q] = nil
+            }
+        }
+        for q in circuit.get_qubits() {
+            _ = try flush(q)
+        }
+        return changed
+    }
+
+    /**
+     Peephole optimize circuit in the QX basis.
+     Runs of single qubit gates are merged, gates composing to the identity
+     are dropped and back-to-back cx gates cancel, sweeping the circuit until
+     nothing changes. The input circuit is left untouched: the optimization
+     runs on a copy, or on the unrolled circuit when it holds operations
+     outside of the QX basis other than h.
+     Return the optimized circuit.
+     */
+    static func peephole_optimize(_ circuit: DAGCircuit, cancel_cx: Bool = true) throws -> DAGCircuit {
+        var optimized = try Mapping.unroll_to_basis(circuit, ["u1", "u2", "u3", "cx", "id", "h"])
+        if optimized === circuit {
+            optimized = circuit.deepcopy()
+        }
+        while try Mapping.peephole_sweep(optimized, cancel_cx) {
+        }
+        // Drop the basis elements no longer in use
+        let ops = try optimized.count_ops()
+        for name in optimized.basis.keys where ops[name] == nil {
+            try optimized.remove_basis_element(name)
         }
-        return unrolled
+        return optimized
+    }
+
+    /**
+     "Simplify runs of single qubit gates in the QX basis.
+     Like peephole_optimize the input circuit is left untouched, and cx gates
+     are left as they are.
+     Return the optimized circuit.
+     */
+    static func optimize_1q_gates(_ circuit: DAGCircuit) throws -> DAGCircuit {
+        return try Mapping.peephole_optimize(circuit, cancel_cx: false)
     }
 }
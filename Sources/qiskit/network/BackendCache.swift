@@ -0,0 +1,295 @@
+// Copyright 2017 IBM RESEARCH. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+
+import Foundation
+
+/**
+ Cache of the backend data a connector gets from the QX Platform: the
+ list of backends with their configuration, their status and their
+ calibration and parameters.
+
+ An entry is kept for the time to live of its kind, 0 not to cache the
+ kind. Callers asking for an entry that is being fetched wait for that
+ request instead of sending another one; a caller that cancels is
+ answered with requestCancelled, and the request is cancelled with its
+ last caller. Errors are not cached. When directory is set, the entries
+ are also written there as JSON files and read back on a memory miss
+ while still valid, by this process or the next ones.
+ */
+public final class BackendCache {
+
+    public enum Kind: String {
+        case configuration
+        case status
+        case calibration
+    }
+
+    /**
+     Number of calls answered without a request.
+     */
+    public var hits: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._hits
+    }
+
+    /**
+     Number of calls that sent a request.
+     */
+    public var misses: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._misses
+    }
+
+    /**
+     Directory where the entries persist between processes, nil to keep
+     them in memory only.
+     */
+    public var directory: URL? {
+        get {
+            self.lock.lock()
+            defer { self.lock.unlock() }
+            return self._directory
+        }
+        set {
+            self.lock.lock()
+            defer { self.lock.unlock() }
+            self._directory = newValue
+        }
+    }
+
+    private struct Entry {
+        let value: Any
+        let expires: Date
+    }
+
+    /**
+     A request in flight with the callers waiting for it.
+     */
+    private final class Fetch {
+        var waiters: [(RequestTask, (_:Any?, _:IBMQuantumExperienceError?) -> Void)] = []
+        var task: RequestTask? = nil
+        var done = false
+    }
+
+    private let lock = NSRecursiveLock()
+    private var ttls: [Kind:TimeInterval]
+    private var entries: [String:Entry] = [:]
+    private var fetches: [String:Fetch] = [:]
+    private var _directory: URL? = nil
+    private var _hits: Int = 0
+    private var _misses: Int = 0
+
+    public init(configuration_ttl: TimeInterval = 300.0,
+                status_ttl: TimeInterval = 30.0,
+                calibration_ttl: TimeInterval = 900.0) {
+        self.ttls = [
+            .configuration: max(configuration_ttl, 0.0),
+            .status: max(status_ttl, 0.0),
+            .calibration: max(calibration_ttl, 0.0)
+        ]
+    }
+
+    /**
+     Seconds an entry of kind is kept.
+     */
+    public func ttl(_ kind: Kind) -> TimeInterval {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.ttls[kind]!
+    }
+
+    /**
+     Sets the seconds an entry of kind is kept, 0 not to cache the kind.
+     */
+    public func set_ttl(_ ttl: TimeInterval, _ kind: Kind) {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        self.ttls[kind] = max(ttl, 0.0)
+    }
+
+    /**
+     Drops the entries of kind, all of them if nil, from memory and from
+     directory.
+     */
+    public func invalidate(_ kind: Kind? = nil) {
+        self.lock.lock()
+        for key in Array(self.entries.keys) where kind == nil || key.hasPrefix("\(kind!.rawValue)|") {
+            self.entries[key] = nil
+        }
+        let directory = self._directory
+        self.lock.unlock()
+        guard let directory = directory,
+            let files = try? FileManager.default.contentsOfDirectory(atPath: directory.path) else {
+            return
+        }
+        let prefix = kind != nil ? "\(kind!.rawValue)_" : ""
+        for file in files where file.hasPrefix(prefix) && file.hasSuffix(".json") {
+            try? FileManager.default.removeItem(at: directory.appendingPathComponent(file))
+        }
+    }
+
+    /**
+     Calls handler with the entry key of kind, calling fetch to get it
+     when it is missing or expired.
+     */
+    func get(_ kind: Kind,
+             _ key: String,
+             fetch: (_ done: @escaping (_:Any?, _:IBMQuantumExperienceError?) -> Void) -> RequestTask,
+             _ handler: @escaping (_:Any?, _:IBMQuantumExperienceError?) -> Void) -> RequestTask {
+        let entry_key = "\(kind.rawValue)|\(key)"
+        self.lock.lock()
+        let ttl = self.ttls[kind]!
+        var entry = ttl > 0.0 ? self.entries[entry_key] : nil
+        if entry == nil && ttl > 0.0, let file = self._file(kind, entry_key) {
+            // the file is read unlocked, then published
+            self.lock.unlock()
+            let loaded = BackendCache._load(entry_key, file)
+            self.lock.lock()
+            if let loaded = loaded, self.entries[entry_key] == nil {
+                self.entries[entry_key] = loaded
+            }
+            entry = self.entries[entry_key]
+        }
+        if let entry = entry, entry.expires > Date() {
+            self._hits += 1
+            self.lock.unlock()
+            handler(entry.value, nil)
+            return RequestTask()
+        }
+        let task = RequestTask()
+        if let pending = self.fetches[entry_key] {
+            pending.waiters.append((task, handler))
+            self._hits += 1
+            self.lock.unlock()
+            task.on_cancel { [weak self] in
+                self?._cancelled(entry_key, pending, task)
+            }
+            return task
+        }
+        let pending = Fetch()
+        pending.waiters.append((task, handler))
+        self.fetches[entry_key] = pending
+        self._misses += 1
+        self.lock.unlock()
+        task.on_cancel { [weak self] in
+            self?._cancelled(entry_key, pending, task)
+        }
+        let r = fetch() { (value, error) -> Void in
+            self.lock.lock()
+            pending.done = true
+            let waiting = pending.waiters
+            pending.waiters = []
+            if self.fetches[entry_key] === pending {
+                self.fetches[entry_key] = nil
+            }
+            var stored: (Entry, URL)? = nil
+            if error == nil, let v = value, ttl > 0.0 {
+                let entry = Entry(value: v, expires: Date().addingTimeInterval(ttl))
+                self.entries[entry_key] = entry
+                if let file = self._file(kind, entry_key) {
+                    stored = (entry, file)
+                }
+            }
+            self.lock.unlock()
+            if let stored = stored {
+                BackendCache._store(entry_key, stored.0, stored.1)
+            }
+            for (_, h) in waiting {
+                h(value, error)
+            }
+        }
+        self.lock.lock()
+        pending.task = r
+        // every caller cancelled before the request was sent
+        let orphan = !pending.done && pending.waiters.isEmpty
+        self.lock.unlock()
+        if orphan {
+            r.cancel()
+        }
+        return task
+    }
+
+    /**
+     Answers a caller that cancelled, and cancels the request once no
+     caller waits for it.
+     */
+    private func _cancelled(_ entry_key: String, _ pending: Fetch, _ task: RequestTask) {
+        self.lock.lock()
+        guard let index = pending.waiters.index(where: { $0.0 === task }) else {
+            self.lock.unlock()
+            return
+        }
+        let (_, handler) = pending.waiters.remove(at: index)
+        var fetch_task: RequestTask? = nil
+        if pending.waiters.isEmpty && self.fetches[entry_key] === pending {
+            self.fetches[entry_key] = nil
+            fetch_task = pending.task
+        }
+        self.lock.unlock()
+        fetch_task?.cancel()
+        let error = NSError(domain: NSURLErrorDomain, code: NSURLErrorCancelled, userInfo: nil)
+        handler(nil, IBMQuantumExperienceError.requestCancelled(error: error))
+    }
+
+    /**
+     File of an entry in directory, named by its kind and the hash of its
+     key. Called locked.
+     */
+    private func _file(_ kind: Kind, _ entry_key: String) -> URL? {
+        return self._directory?.appendingPathComponent("\(kind.rawValue)_\(CompileCache.hash(entry_key)).json")
+    }
+
+    /**
+     Reads an entry back from file, nil if it is missing or expired.
+     */
+    private static func _load(_ entry_key: String, _ file: URL) -> Entry? {
+        guard FileManager.default.fileExists(atPath: file.path),
+            let data = try? Data(contentsOf: file),
+            let json = (try? JSONSerialization.jsonObject(with: data, options: [])) as? [String:Any],
+            let stored_key = json["key"] as? String, stored_key == entry_key,
+            let expires = json["expires"] as? Double,
+            let value = json["value"] else {
+            return nil
+        }
+        let entry = Entry(value: value, expires: Date(timeIntervalSince1970: expires))
+        if entry.expires <= Date() {
+            return nil
+        }
+        return entry
+    }
+
+    /**
+     Writes an entry to file.
+     */
+    private static func _store(_ entry_key: String, _ entry: Entry, _ file: URL) {
+        let json: [String:Any] = [
+            "key": entry_key,
+            "expires": entry.expires.timeIntervalSince1970,
+            "value": entry.value
+        ]
+        guard JSONSerialization.isValidJSONObject(json),
+            let data = try? JSONSerialization.data(withJSONObject: json, options: []) else {
+            return
+        }
+        do {
+            try FileManager.default.createDirectory(at: file.deletingLastPathComponent(), withIntermediateDirectories: true, attributes: nil)
+            try data.write(to: file, options: .atomic)
+        } catch {
+            SDKLogger.logError("BackendCache: could not save \(file.path): \(error)")
+        }
+    }
+}
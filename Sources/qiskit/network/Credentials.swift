@@ -108,6 +108,18 @@ public final class Credentials {
         return self.data_credentials["userId"] as? String
     }
 
+    /**
+     Identity of the account these credentials belong to: the user id once
+     known, otherwise a hash of the API token. Never the token itself.
+     */
+    func account_key() -> String {
+        if let user_id = self.get_user_id() {
+            return user_id
+        }
+        let token = self.token_unique ?? self.config["access_token"] as? String ?? ""
+        return CompileCache.hash(token)
+    }
+
     /**
      Set Access Token to connect with QX Platform API
      */
@@ -37,7 +37,29 @@ public final class IBMQuantumExperience {
             self.credentials.config = newValue
         }
     }
+    /**
+     Counters of the HTTP requests sent by this connector.
+     */
+    public let metrics = RequestMetrics()
+    /**
+     Cache of the backend list, status and calibration got by this connector.
+     */
+    public let backend_cache = BackendCache()
     private var request: Request? = nil
+    private var _job_poller: JobPoller? = nil
+    private let poller_lock = NSLock()
+
+    /**
+     Poller waiting for the jobs run through this connector.
+     */
+    var job_poller: JobPoller {
+        self.poller_lock.lock()
+        defer { self.poller_lock.unlock() }
+        if self._job_poller == nil {
+            self._job_poller = JobPoller(self)
+        }
+        return self._job_poller!
+    }
 
     /**
      Creates Quantum Experience object with a given configuration.
@@ -130,7 +152,7 @@ public final class IBMQuantumExperience {
     @discardableResult
     public func check_connection(_ responseHandler: @escaping ((_:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
         return self.check_connectionInternal() { (error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(error)
             }
         }
@@ -148,7 +170,7 @@ public final class IBMQuantumExperience {
             return RequestTask()
         }
         do {
-            let req = try Request(self.credentials)
+            let req = try Request(self.credentials, metrics: self.metrics)
             return req.initialize() { (request,error) -> Void in
                 self.request = request
                 responseHandler(self.request,error)
@@ -164,6 +186,19 @@ public final class IBMQuantumExperience {
         }
     }
 
+    /**
+     Key of a backend_cache entry: the platform url and the account,
+     followed by parts, so accounts never share cached entries.
+     */
+    private func cache_key(_ parts: String?...) -> String {
+        var key = self.config["url"] as? String ?? ""
+        key += "|\(self.credentials.account_key())"
+        for part in parts {
+            key += "|\(part ?? "")"
+        }
+        return key
+    }
+
     /**
      Check if the name of a backend is valid to run in QX Platform
      */
@@ -223,7 +258,7 @@ public final class IBMQuantumExperience {
             return RequestTask()
         }
         // Check for new-style backends
-        return self.available_backends() { (backends,error) -> Void in
+        return self.available_backendsInternal(nil, nil, nil, nil, nil) { (backends,error) -> Void in
             if error != nil {
                 responseHandler(nil,error)
                 return
@@ -273,7 +308,7 @@ public final class IBMQuantumExperience {
         return self.get_executionInternal(id_execution,
                                    access_token,
                                    user_id) { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -339,7 +374,7 @@ public final class IBMQuantumExperience {
         return self.get_result_from_executionInternal(id_execution,
                                                       access_token,
                                                       user_id) { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -419,7 +454,7 @@ public final class IBMQuantumExperience {
         return self.get_codeInternal(id_code,
                                      access_token,
                                      user_id) { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -482,7 +517,7 @@ public final class IBMQuantumExperience {
         return self.get_image_codeInternal(id_code,
                                            access_token,
                                            user_id) { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -534,7 +569,7 @@ public final class IBMQuantumExperience {
                                responseHandler: @escaping ((_:[String], _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
         return self.get_last_codesInternal(access_token,
                                            user_id) { (res,error) in
-                DispatchQueue.main.async {
+                CompletionExecutor.shared.execute {
                     responseHandler(res,error)
                 }
         }
@@ -603,7 +638,7 @@ public final class IBMQuantumExperience {
                                            timeout,
                                            access_token,
                                            user_id) { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -850,7 +885,7 @@ public final class IBMQuantumExperience {
                                     hpc: hpc,
                                     access_token: access_token,
                                     user_id: user_id) { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -965,7 +1000,7 @@ public final class IBMQuantumExperience {
                                     project: project,
                                     access_token: access_token,
                                     user_id: user_id) { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -1044,7 +1079,7 @@ public final class IBMQuantumExperience {
         return self.get_jobsInternal(limit,
                                      access_token,
                                      user_id) { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -1087,6 +1122,81 @@ public final class IBMQuantumExperience {
         return reqTask
     }
 
+    /**
+     Gets the status of the jobs ids with a single request. Asynchronous.
+     - parameter ids: job identifiers
+     - parameter responseHandler: Closure to be called upon completion, with the id and status of each job
+     */
+    @discardableResult
+    public func get_status_jobs(ids: [String],
+                                hub: String? = nil,
+                                group: String? = nil,
+                                project: String? = nil,
+                                access_token: String? = nil,
+                                user_id: String? = nil,
+                                responseHandler: @escaping ((_:[[String:Any]], _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
+        return self.get_status_jobsInternal(ids: ids,
+                                            hub: hub,
+                                            group: group,
+                                            project: project,
+                                            access_token: access_token,
+                                            user_id: user_id) { (res,error) in
+            CompletionExecutor.shared.execute {
+                responseHandler(res,error)
+            }
+        }
+    }
+
+    func get_status_jobsInternal(ids: [String],
+                                 hub: String?,
+                                 group: String?,
+                                 project: String?,
+                                 access_token: String?,
+                                 user_id: String?,
+                                 responseHandler: @escaping ((_:[[String:Any]], _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
+        let reqTask = RequestTask()
+        let r = self.getRequest() { (req,error) -> Void in
+            if error != nil {
+                responseHandler([], error)
+                return
+            }
+            if let token = access_token {
+                req!.credentials.set_token(token)
+            }
+            if let user = user_id {
+                req!.credentials.set_user_id(user)
+            }
+            if !self.check_credentials() {
+                responseHandler([],IBMQuantumExperienceError.invalidCredentials)
+                return
+            }
+            let filter: [String:Any] = [
+                "limit": ids.count,
+                "where": ["id": ["inq": ids]]
+            ]
+            guard let data = try? JSONSerialization.data(withJSONObject: filter),
+                let json = String(data: data, encoding: .utf8) else {
+                responseHandler([],IBMQuantumExperienceError.invalidResponseData)
+                return
+            }
+            let path = IBMQuantumExperience.get_job_url(self.config, hub, group, project)
+            let r = req!.get(path: "\(path)/status", params: "&filter=\(json)") { (out, error) -> Void in
+                if error != nil {
+                    responseHandler([], error)
+                    return
+                }
+                guard let jobs = out as? [[String:Any]] else {
+                    responseHandler([],IBMQuantumExperienceError.invalidResponseData)
+                    return
+                }
+                responseHandler(jobs, error)
+            }
+            reqTask.add(r)
+        }
+        reqTask.add(r)
+        return reqTask
+    }
+
     /**
      Get the status of a chip
      */
@@ -1098,7 +1208,7 @@ public final class IBMQuantumExperience {
         return self.backend_statusInternal(backend,
                                            access_token,
                                            user_id) { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -1108,6 +1218,22 @@ public final class IBMQuantumExperience {
                                         _ access_token: String?,
                                         _ user_id: String?,
                                         _ responseHandler: @escaping ((_:[String:Any], _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
+        if access_token != nil || user_id != nil {
+            return self.fetch_backend_status(backend, access_token, user_id, responseHandler)
+        }
+        return self.backend_cache.get(.status, self.cache_key(backend), fetch: { (done) in
+            return self.fetch_backend_status(backend, nil, nil) { (status,error) in
+                done(status,error)
+            }
+        }) { (value,error) in
+            responseHandler(value as? [String:Any] ?? [:],error)
+        }
+    }
+
+    private func fetch_backend_status(_ backend: String,
+                                      _ access_token: String?,
+                                      _ user_id: String?,
+                                      _ responseHandler: @escaping ((_:[String:Any], _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
         let reqTask = RequestTask()
         let r = self._check_backend(backend, "status") { (backend_type,error) -> Void in
             if error != nil {
@@ -1166,7 +1292,7 @@ public final class IBMQuantumExperience {
                                                 hub,
                                                 access_token,
                                                 user_id) { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -1177,6 +1303,23 @@ public final class IBMQuantumExperience {
                                              _ access_token: String?,
                                              _ user_id: String?,
                                              _ responseHandler: @escaping ((_:[String:Any], _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
+        if access_token != nil || user_id != nil {
+            return self.fetch_backend_calibration(backend, hub, access_token, user_id, responseHandler)
+        }
+        return self.backend_cache.get(.calibration, self.cache_key("calibration", backend, hub), fetch: { (done) in
+            return self.fetch_backend_calibration(backend, hub, nil, nil) { (calibration,error) in
+                done(calibration,error)
+            }
+        }) { (value,error) in
+            responseHandler(value as? [String:Any] ?? [:],error)
+        }
+    }
+
+    private func fetch_backend_calibration(_ backend: String,
+                                           _ hub: String?,
+                                           _ access_token: String?,
+                                           _ user_id: String?,
+                                           _ responseHandler: @escaping ((_:[String:Any], _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
         let reqTask = RequestTask()
         let r = self.getRequest() { (req,error) -> Void in
             if error != nil {
@@ -1240,7 +1383,7 @@ public final class IBMQuantumExperience {
                                                hub,
                                                access_token,
                                                user_id) { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -1251,6 +1394,23 @@ public final class IBMQuantumExperience {
                                             _ access_token: String?,
                                             _ user_id: String?,
                                             _ responseHandler: @escaping ((_:[String:Any], _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
+        if access_token != nil || user_id != nil {
+            return self.fetch_backend_parameters(backend, hub, access_token, user_id, responseHandler)
+        }
+        return self.backend_cache.get(.calibration, self.cache_key("parameters", backend, hub), fetch: { (done) in
+            return self.fetch_backend_parameters(backend, hub, nil, nil) { (parameters,error) in
+                done(parameters,error)
+            }
+        }) { (value,error) in
+            responseHandler(value as? [String:Any] ?? [:],error)
+        }
+    }
+
+    private func fetch_backend_parameters(_ backend: String,
+                                          _ hub: String?,
+                                          _ access_token: String?,
+                                          _ user_id: String?,
+                                          _ responseHandler: @escaping ((_:[String:Any], _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
         let reqTask = RequestTask()
         let r = self.getRequest() { (req,error) -> Void in
             if error != nil {
@@ -1316,7 +1476,7 @@ public final class IBMQuantumExperience {
                                                group,
                                                project,
                                                user_id) { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -1328,6 +1488,24 @@ public final class IBMQuantumExperience {
                                             _ project: String?,
                                             _ user_id: String?,
                                             _ responseHandler: @escaping ((_:[[String:Any]], _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
+        if access_token != nil || user_id != nil {
+            return self.fetch_available_backends(access_token, hub, group, project, user_id, responseHandler)
+        }
+        return self.backend_cache.get(.configuration, self.cache_key(hub, group, project), fetch: { (done) in
+            return self.fetch_available_backends(nil, hub, group, project, nil) { (backends,error) in
+                done(backends,error)
+            }
+        }) { (value,error) in
+            responseHandler(value as? [[String:Any]] ?? [],error)
+        }
+    }
+
+    private func fetch_available_backends(_ access_token: String?,
+                                          _ hub: String?,
+                                          _ group: String?,
+                                          _ project: String?,
+                                          _ user_id: String?,
+                                          _ responseHandler: @escaping ((_:[[String:Any]], _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
         let reqTask = RequestTask()
         let r = self.getRequest() { (req,error) -> Void in
             if error != nil {
@@ -1379,7 +1557,7 @@ public final class IBMQuantumExperience {
                                              responseHandler: @escaping ((_:[[String:Any]], _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
         return self.available_backend_simulatorsInternal(access_token,
                                                          user_id) { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -1418,7 +1596,7 @@ public final class IBMQuantumExperience {
                                responseHandler: @escaping ((_:[String:Any], _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
         return self.get_my_creditsInternal(access_token,
                                            user_id) { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -1476,7 +1654,7 @@ public final class IBMQuantumExperience {
     @discardableResult
     public func api_version(responseHandler: @escaping ((_:String, _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
         return self.api_versionInternal() { (res,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 responseHandler(res,error)
             }
         }
@@ -0,0 +1,341 @@
+// Copyright 2017 IBM RESEARCH. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+
+import Foundation
+#if os(Linux)
+import Dispatch
+#endif
+
+/**
+ Waits for the remote jobs of a connector to finish.
+
+ The status of all the jobs waited for is asked with a single request per
+ tick. The first tick comes initial_interval seconds after a job is added,
+ the next ones backoff times later each, up to the smallest wait of the
+ jobs, with a random jitter so that several processes do not poll in step.
+ A job is waited for once however many callers wait for it, and only one
+ status request is in flight at a time. The job itself is fetched as soon
+ as its status leaves RUNNING. A failed status request, or a job missing
+ from its answer, leaves the jobs pending until their timeout. Every
+ caller is answered exactly once, with an error if it cancels.
+ */
+final class JobPoller {
+
+    typealias StatusHandler = (_:[String:String], _:Error?) -> Void
+    typealias JobHandler = (_:[String:Any], _:Error?) -> Void
+
+    let initial_interval: Double
+    let backoff: Double
+    let jitter: Double
+
+    /**
+     Number of status requests sent.
+     */
+    var status_requests: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._status_requests
+    }
+
+    /**
+     Number of job requests sent.
+     */
+    var job_requests: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._job_requests
+    }
+
+    /**
+     Number of jobs waited for.
+     */
+    var pending: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.entries.count
+    }
+
+    private struct Waiter {
+        let task: RequestTask
+        let deadline: DispatchTime
+        let timeout: Int
+        let handler: JobHandler
+    }
+
+    private final class Entry {
+        var waiters: [Waiter] = []
+        var max_interval: Double
+        var fetching = false
+
+        init(_ max_interval: Double) {
+            self.max_interval = max_interval
+        }
+    }
+
+    private let fetch_status: (_:[String], _: @escaping StatusHandler) -> RequestTask
+    private let fetch_job: (_:String, _: @escaping JobHandler) -> RequestTask
+    private let lock = NSRecursiveLock()
+    private var entries: [String:Entry] = [:]
+    private var interval: Double
+    private var in_flight = false
+    private var reset = false
+    private var timer_deadline = DispatchTime.distantFuture
+    private let timer: DispatchSourceTimer
+    private let random = Random(time(nil))
+    private var _status_requests = 0
+    private var _job_requests = 0
+
+    /**
+     Poller asking fetch_status for the status of a list of job ids, by id,
+     and fetch_job for a job.
+     */
+    init(initial_interval: Double = 0.5,
+         backoff: Double = 2.0,
+         jitter: Double = 0.2,
+         fetch_status: @escaping (_:[String], _: @escaping StatusHandler) -> RequestTask,
+         fetch_job: @escaping (_:String, _: @escaping JobHandler) -> RequestTask) {
+        self.initial_interval = max(initial_interval, 0.0)
+        self.backoff = max(backoff, 1.0)
+        self.jitter = min(max(jitter, 0.0), 1.0)
+        self.interval = self.initial_interval
+        self.fetch_status = fetch_status
+        self.fetch_job = fetch_job
+        self.timer = DispatchSource.makeTimerSource(queue: DispatchQueue.global(qos: .background))
+        self.timer.setEventHandler { [weak self] in
+            self?._tick()
+        }
+        self.timer.schedule(deadline: .distantFuture)
+        self.timer.resume()
+    }
+
+    /**
+     Poller of the jobs run through api.
+     */
+    convenience init(_ api: IBMQuantumExperience) {
+        self.init(fetch_status: { [weak api] (ids, handler) -> RequestTask in
+            guard let api = api else {
+                handler([:], IBMQuantumExperienceError.requestCancelled(error: QISKitError.jobCancelled))
+                return RequestTask()
+            }
+            return api.get_status_jobsInternal(ids: ids,
+                                               hub: nil,
+                                               group: nil,
+                                               project: nil,
+                                               access_token: nil,
+                                               user_id: nil) { (jobs, error) -> Void in
+                var statuses: [String:String] = [:]
+                for job in jobs {
+                    if let id = job["id"] as? String,
+                        let status = job["status"] as? String {
+                        statuses[id] = status
+                    }
+                }
+                handler(statuses, error)
+            }
+        }, fetch_job: { [weak api] (id, handler) -> RequestTask in
+            guard let api = api else {
+                handler([:], IBMQuantumExperienceError.requestCancelled(error: QISKitError.jobCancelled))
+                return RequestTask()
+            }
+            return api.get_jobInternal(jobId: id,
+                                       hub: nil,
+                                       group: nil,
+                                       project: nil,
+                                       access_token: nil,
+                                       user_id: nil) { (job, error) -> Void in
+                handler(job, error)
+            }
+        })
+    }
+
+    deinit {
+        self.timer.cancel()
+    }
+
+    /**
+     Calls handler with the job jobId once it is no longer running, or
+     with an error after timeout seconds. wait caps the seconds between
+     two status requests.
+     */
+    func wait(_ jobId: String, wait: Int = 5, timeout: Int = 60,
+              _ handler: @escaping JobHandler) -> RequestTask {
+        let task = RequestTask()
+        let max_interval = max(Double(wait), self.initial_interval)
+        self.lock.lock()
+        let entry: Entry
+        if let e = self.entries[jobId] {
+            entry = e
+            entry.max_interval = min(entry.max_interval, max_interval)
+        }
+        else {
+            entry = Entry(max_interval)
+            self.entries[jobId] = entry
+        }
+        entry.waiters.append(Waiter(task: task, deadline: .now() + .seconds(timeout), timeout: timeout, handler: handler))
+        if !entry.fetching {
+            self._hurry()
+        }
+        self.lock.unlock()
+        task.on_cancel { [weak self] in
+            self?._cancelled(jobId, task)
+        }
+        return task
+    }
+
+    /**
+     Brings the next tick to initial_interval from now, or right after the
+     status request in flight. Called locked.
+     */
+    private func _hurry() {
+        self.interval = self.initial_interval
+        if self.in_flight {
+            self.reset = true
+            return
+        }
+        let deadline = DispatchTime.now() + self.initial_interval
+        if deadline < self.timer_deadline {
+            self._schedule(deadline)
+        }
+    }
+
+    /**
+     Sets the timer to the next tick. Called locked.
+     */
+    private func _schedule(_ deadline: DispatchTime) {
+        self.timer_deadline = deadline
+        self.timer.schedule(deadline: deadline)
+    }
+
+    private func _tick() {
+        self.lock.lock()
+        if self.in_flight {
+            self.lock.unlock()
+            return
+        }
+        self._schedule(.distantFuture)
+        let ids = self.entries.filter { !$0.value.fetching }.map { $0.key }.sorted()
+        if ids.isEmpty {
+            self.lock.unlock()
+            return
+        }
+        self.in_flight = true
+        self._status_requests += 1
+        self.lock.unlock()
+        _ = self.fetch_status(ids) { (statuses, error) -> Void in
+            self._polled(ids, statuses, error)
+        }
+    }
+
+    private func _polled(_ ids: [String], _ statuses: [String:String], _ error: Error?) {
+        var deliveries: [(Waiter, Error)] = []
+        var fetch: [String] = []
+        self.lock.lock()
+        self.in_flight = false
+        if error != nil {
+            // keep the jobs pending, the next tick backs off
+            SDKLogger.logError("JobPoller: status request failed: \(error!.localizedDescription)")
+        }
+        let now = DispatchTime.now()
+        for id in ids {
+            guard let entry = self.entries[id], !entry.fetching else {
+                continue
+            }
+            if let status = statuses[id], error == nil {
+                if status != "RUNNING" {
+                    entry.fetching = true
+                    fetch.append(id)
+                    continue
+                }
+                SDKLogger.logInfo("status = \(status) (job \(id))")
+            }
+            var waiting: [Waiter] = []
+            for waiter in entry.waiters {
+                if waiter.deadline <= now {
+                    deliveries.append((waiter, QISKitError.jobTimeout(timeout: waiter.timeout)))
+                }
+                else {
+                    waiting.append(waiter)
+                }
+            }
+            entry.waiters = waiting
+            if waiting.isEmpty {
+                self.entries[id] = nil
+            }
+        }
+        var max_interval = Double.greatestFiniteMagnitude
+        for entry in self.entries.values where !entry.fetching {
+            max_interval = min(max_interval, entry.max_interval)
+        }
+        if max_interval < Double.greatestFiniteMagnitude {
+            if self.reset && error == nil {
+                self.interval = self.initial_interval
+            }
+            else {
+                self.interval = min(self.interval * self.backoff, max_interval)
+            }
+            self.reset = false
+            let delay = self.interval * (1.0 + self.jitter * (2.0 * self.random.random() - 1.0))
+            self._schedule(.now() + max(delay, 0.0))
+        }
+        self._job_requests += fetch.count
+        self.lock.unlock()
+        // the waiters taken out of entries under the lock are answered here
+        // and nowhere else, cancelled or not
+        for (waiter, e) in deliveries {
+            waiter.handler([:], e)
+        }
+        for id in fetch {
+            _ = self.fetch_job(id) { (job, error) -> Void in
+                self._fetched(id, job, error)
+            }
+        }
+    }
+
+    private func _fetched(_ id: String, _ job: [String:Any], _ error: Error?) {
+        self.lock.lock()
+        let entry = self.entries.removeValue(forKey: id)
+        self.lock.unlock()
+        guard let waiters = entry?.waiters else {
+            return
+        }
+        for waiter in waiters {
+            waiter.handler(job, error)
+        }
+    }
+
+    /**
+     Answers the waiter of task with a timeout if it is past its deadline,
+     as cancelled otherwise.
+     */
+    private func _cancelled(_ id: String, _ task: RequestTask) {
+        self.lock.lock()
+        guard let entry = self.entries[id],
+            let index = entry.waiters.index(where: { $0.task === task }) else {
+            self.lock.unlock()
+            return
+        }
+        let waiter = entry.waiters.remove(at: index)
+        if entry.waiters.isEmpty && !entry.fetching {
+            self.entries[id] = nil
+        }
+        self.lock.unlock()
+        if waiter.deadline <= DispatchTime.now() {
+            waiter.handler([:], QISKitError.jobTimeout(timeout: waiter.timeout))
+        }
+        else {
+            waiter.handler([:], IBMQuantumExperienceError.requestCancelled(error: QISKitError.jobCancelled))
+        }
+    }
+}
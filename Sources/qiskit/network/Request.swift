@@ -16,30 +16,93 @@
 import Foundation
 #if os(Linux)
 import Dispatch
+#else
+import Compression
 #endif
 
+/**
+ HTTP client of a connector.
+
+ The clients with the same proxies and NTLM credentials share a
+ URLSession, so that they reuse its connections, kept alive and pipelined,
+ or multiplexed where the server speaks HTTP/2. The session is invalidated
+ once the last client using it is gone. Responses are accepted
+ gzip compressed; request bodies of at least GZIP_MIN_BYTES are sent gzip
+ compressed when the configuration sets "gzip_requests". A failed request
+ is sent again up to retries times, after timeout_interval seconds doubled
+ at each attempt and capped at max_backoff.
+ */
 final class Request {
 
     private static let HTTPSTATUSOK: Int = 200
     private static let REACHTIMEOUT: TimeInterval = 90.0
     private static let CONNTIMEOUT: TimeInterval = 120.0
+    private static let MAX_CONNECTIONS: Int = 6
+    private static let GZIP_MIN_BYTES: Int = 1024
     private static let HEADER_CLIENT_APPLICATION = "x-qx-client-application"
     private static let _max_qubit_error_re = ".*registers exceed the number of qubits, it can't be greater than (\\d+).*"
 
-    private let sessionDelegate: SessionDelegate
-    private var urlSession: URLSession
+    /**
+     A session of the pool and the number of clients using it.
+     */
+    private struct SharedSession {
+        let session: URLSession
+        var users: Int
+    }
+
+    private static let sessions_lock = NSLock()
+    private static var sessions: [String:SharedSession] = [:]
+
+    let credentials: Credentials
+    let metrics: RequestMetrics
+    let urlSession: URLSession
+    private let session_key: String
     private let retries: UInt
     private let timeout_interval: Double
-    var credentials: Credentials {
-        return self.sessionDelegate.credentials
-    }
+    private let max_backoff: Double
 
     init(_ credentials: Credentials,
          _ retries: UInt = 5,
-         _ timeout_interval: TimeInterval = 1.0) throws {
-        self.sessionDelegate = SessionDelegate(credentials)
+         _ timeout_interval: TimeInterval = 1.0,
+         _ max_backoff: TimeInterval = 30.0,
+         metrics: RequestMetrics = RequestMetrics()) throws {
+        self.credentials = credentials
+        self.metrics = metrics
         self.retries = retries
         self.timeout_interval = timeout_interval
+        self.max_backoff = max(max_backoff, timeout_interval)
+        self.session_key = Request.session_key(credentials)
+        self.urlSession = try Request.session(self.session_key, credentials)
+    }
+
+    deinit {
+        Request.release_session(self.session_key)
+    }
+
+    /**
+     Key of the session of credentials: a hash of their proxies and NTLM
+     credentials, so that the pool does not hold the password.
+     */
+    private static func session_key(_ credentials: Credentials) -> String {
+        var key = credentials.proxy_urls.joined(separator: ",")
+        if let username = credentials.ntlm_credentials["username"],
+            let password = credentials.ntlm_credentials["password"] {
+            key += "|\(username)|\(password)"
+        }
+        return CompileCache.hash(key)
+    }
+
+    /**
+     Session shared by the clients with the proxies and NTLM credentials
+     of credentials, counting the caller as one more client.
+     */
+    private static func session(_ key: String, _ credentials: Credentials) throws -> URLSession {
+        Request.sessions_lock.lock()
+        defer { Request.sessions_lock.unlock() }
+        if let shared = Request.sessions[key] {
+            Request.sessions[key]!.users += 1
+            return shared.session
+        }
         #if os(Linux)
             let sessionConfig = URLSessionConfiguration.default
             let networkProxiesHTTPEnable    = "HTTPEnable"
@@ -100,7 +163,33 @@ final class Request {
                 sessionConfig.connectionProxyDictionary = dict
             }
         }
-        self.urlSession = URLSession(configuration: sessionConfig, delegate: self.sessionDelegate, delegateQueue: nil)
+        sessionConfig.httpShouldUsePipelining = true
+        sessionConfig.httpMaximumConnectionsPerHost = Request.MAX_CONNECTIONS
+        let session = URLSession(configuration: sessionConfig, delegate: SessionDelegate(credentials), delegateQueue: nil)
+        Request.sessions[key] = SharedSession(session: session, users: 1)
+        return session
+    }
+
+    /**
+     Drop a client of the session of key. The last one removes the session
+     from the pool and invalidates it, which releases its delegate and
+     credentials once its running tasks finish.
+     */
+    private static func release_session(_ key: String) {
+        Request.sessions_lock.lock()
+        guard var shared = Request.sessions[key] else {
+            Request.sessions_lock.unlock()
+            return
+        }
+        shared.users -= 1
+        if shared.users > 0 {
+            Request.sessions[key] = shared
+            Request.sessions_lock.unlock()
+            return
+        }
+        Request.sessions.removeValue(forKey: key)
+        Request.sessions_lock.unlock()
+        shared.session.finishTasksAndInvalidate()
     }
 
     func initialize(responseHandler: @escaping ((_:Request, _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
@@ -127,6 +216,29 @@ final class Request {
         return RequestTask()
     }
 
+    /**
+     Seconds to wait before sending again a request that failed attempt + 1
+     times.
+     */
+    func retry_delay(_ attempt: UInt) -> TimeInterval {
+        let delay = self.timeout_interval * pow(2.0, Double(min(attempt, 32)))
+        return min(delay, self.max_backoff)
+    }
+
+    /**
+     Whether a request that failed with error may succeed if sent again.
+     */
+    static func is_retryable(_ error: IBMQuantumExperienceError) -> Bool {
+        switch error {
+        case .requestCancelled, .registerSizeError, .resultError, .invalidURL, .invalidToken, .invalidCredentials:
+            return false
+        case .httpError(let httpStatus, _, _, _):
+            return httpStatus < 400 || httpStatus >= 500 || httpStatus == 408 || httpStatus == 429
+        default:
+            return true
+        }
+    }
+
     func post(path: String,
               params: String = "",
               data: [String : Any] = [:],
@@ -142,8 +254,10 @@ final class Request {
         let reqTask = RequestTask()
         let r = self.postWithCheckToken(path: path, params: params, data: data) { (json, error) in
             if error != nil {
-                if retries > 0 {
-                    DispatchQueue.global(qos: .background).asyncAfter(deadline: .now() + self.timeout_interval) {
+                if retries > 0 && !reqTask.isCancelled() && Request.is_retryable(error!) {
+                    self.metrics.record_retry()
+                    let delay = self.retry_delay(self.retries - retries)
+                    DispatchQueue.global(qos: .background).asyncAfter(deadline: .now() + delay) {
                         let r = self.postRetry(path: path, params: params, data: data, retries: retries-1,responseHandler: responseHandler)
                         reqTask.add(r)
                     }
@@ -219,28 +333,12 @@ final class Request {
         request.addValue(client_application, forHTTPHeaderField: Request.HEADER_CLIENT_APPLICATION)
         request.addValue("application/json", forHTTPHeaderField: "Content-Type")
         do {
-            request.httpBody = try JSONSerialization.data(withJSONObject: data, options: .prettyPrinted)
+            try self.set_body(&request, data)
         } catch let error {
             responseHandler(nil, IBMQuantumExperienceError.internalError(error: error))
             return RequestTask()
         }
-        var reqTask = RequestTask()
-        let task = self.urlSession.dataTask(with: request) { (data, response, error) -> Void in
-            do {
-                let out = try Request.response_good(reqTask, url, data, response, error)
-                responseHandler(out, nil)
-            } catch let error {
-                if let e = error as? IBMQuantumExperienceError {
-                    responseHandler(nil, e)
-                }
-                else {
-                    responseHandler(nil, IBMQuantumExperienceError.internalError(error: error))
-                }
-            }
-        }
-        reqTask += RequestTask(task)
-        task.resume()
-        return reqTask
+        return self.send(request, url, responseHandler)
     }
 
     func put(path: String,
@@ -258,8 +356,10 @@ final class Request {
         let reqTask = RequestTask()
         let r = self.putWithCheckToken(path: path, params: params, data: data) { (json, error) in
             if error != nil {
-                if retries > 0 {
-                    DispatchQueue.global(qos: .background).asyncAfter(deadline: .now() + self.timeout_interval) {
+                if retries > 0 && !reqTask.isCancelled() && Request.is_retryable(error!) {
+                    self.metrics.record_retry()
+                    let delay = self.retry_delay(self.retries - retries)
+                    DispatchQueue.global(qos: .background).asyncAfter(deadline: .now() + delay) {
                         let r = self.putRetry(path: path, params: params, data: data, retries: retries-1,responseHandler: responseHandler)
                         reqTask.add(r)
                     }
@@ -335,27 +435,12 @@ final class Request {
         request.addValue(client_application, forHTTPHeaderField: Request.HEADER_CLIENT_APPLICATION)
         request.addValue("application/json", forHTTPHeaderField: "Content-Type")
         do {
-            request.httpBody = try JSONSerialization.data(withJSONObject: data, options: .prettyPrinted)
+            try self.set_body(&request, data)
         } catch let error {
             responseHandler(nil, IBMQuantumExperienceError.internalError(error: error))
             return RequestTask()
         }
-        var reqTask = RequestTask()
-        let task = self.urlSession.dataTask(with: request) { (data, response, error) -> Void in
-            do {
-                responseHandler(try Request.response_good(reqTask, url, data, response, error), nil)
-            } catch let error {
-                if let e = error as? IBMQuantumExperienceError {
-                    responseHandler(nil, e)
-                }
-                else {
-                    responseHandler(nil, IBMQuantumExperienceError.internalError(error: error))
-                }
-            }
-        }
-        reqTask += RequestTask(task)
-        task.resume()
-        return reqTask
+        return self.send(request, url, responseHandler)
     }
 
     func get(path: String, params: String = "", with_token: Bool = true,
@@ -371,8 +456,10 @@ final class Request {
         let reqTask = RequestTask()
         let r = self.getWithCheckToken(path: path, params: params, with_token: with_token) { (json, error) in
             if error != nil {
-                if retries > 0 {
-                    DispatchQueue.global(qos: .background).asyncAfter(deadline: .now() + self.timeout_interval) {
+                if retries > 0 && !reqTask.isCancelled() && Request.is_retryable(error!) {
+                    self.metrics.record_retry()
+                    let delay = self.retry_delay(self.retries - retries)
+                    DispatchQueue.global(qos: .background).asyncAfter(deadline: .now() + delay) {
                         let r = self.getRetry(path: path, params: params, with_token: with_token, retries: retries-1,responseHandler: responseHandler)
                         reqTask.add(r)
                     }
@@ -447,24 +534,101 @@ final class Request {
             client_application += ":" + c
         }
         request.addValue(client_application, forHTTPHeaderField: Request.HEADER_CLIENT_APPLICATION)
+        return self.send(request, url, responseHandler)
+    }
+
+    /**
+     Sends request and records its latency.
+     */
+    private func send(_ request: URLRequest,
+                      _ url: URL,
+                      _ responseHandler: @escaping ((_:Any?, _:IBMQuantumExperienceError?) -> Void)) -> RequestTask {
         var reqTask = RequestTask()
+        let start = DispatchTime.now()
         let task = self.urlSession.dataTask(with: request) { (data, response, error) -> Void in
+            var out: Any? = nil
+            var e: IBMQuantumExperienceError? = nil
             do {
-                responseHandler(try Request.response_good(reqTask, url, data, response, error), nil)
+                out = try Request.response_good(reqTask, url, data, response, error)
             } catch let error {
-                if let e = error as? IBMQuantumExperienceError {
-                    responseHandler(nil, e)
+                if let err = error as? IBMQuantumExperienceError {
+                    e = err
                 }
                 else {
-                    responseHandler(nil, IBMQuantumExperienceError.internalError(error: error))
+                    e = IBMQuantumExperienceError.internalError(error: error)
                 }
             }
+            let latency = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1e9
+            self.metrics.record(latency, failed: e != nil)
+            responseHandler(out, e)
         }
         reqTask += RequestTask(task)
         task.resume()
         return reqTask
     }
 
+    /**
+     Sets data as the JSON body of request, gzip compressed if large and
+     enabled in the configuration.
+     */
+    private func set_body(_ request: inout URLRequest, _ data: [String : Any]) throws {
+        let body = try JSONSerialization.data(withJSONObject: data, options: [])
+        let gzip_requests = self.credentials.config["gzip_requests"] as? Bool ?? false
+        if gzip_requests && body.count >= Request.GZIP_MIN_BYTES {
+            if let compressed = Request.gzip(body) {
+                request.addValue("gzip", forHTTPHeaderField: "Content-Encoding")
+                request.httpBody = compressed
+                return
+            }
+        }
+        request.httpBody = body
+    }
+
+    private static let crc_table: [UInt32] = (0..<256).map { (n: Int) -> UInt32 in
+        var c = UInt32(n)
+        for _ in 0..<8 {
+            c = c & 1 != 0 ? 0xEDB88320 ^ (c >> 1) : c >> 1
+        }
+        return c
+    }
+
+    /**
+     CRC-32 of data, as in the gzip trailer.
+     */
+    static func crc32(_ data: Data) -> UInt32 {
+        var crc: UInt32 = 0xffffffff
+        for byte in data {
+            crc = Request.crc_table[Int((crc ^ UInt32(byte)) & 0xff)] ^ (crc >> 8)
+        }
+        return crc ^ 0xffffffff
+    }
+
+    /**
+     data in the gzip format, nil if it cannot be compressed on this
+     platform.
+     */
+    static func gzip(_ data: Data) -> Data? {
+        #if os(Linux)
+            return nil
+        #else
+            let capacity = data.count + data.count / 100 + 64
+            var deflated = [UInt8](repeating: 0, count: capacity)
+            let size = data.withUnsafeBytes { (src: UnsafePointer<UInt8>) -> Int in
+                return compression_encode_buffer(&deflated, capacity, src, data.count, nil, COMPRESSION_ZLIB)
+            }
+            if size == 0 {
+                return nil
+            }
+            var out = Data(bytes: [0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff])
+            out.append(deflated, count: size)
+            for value in [Request.crc32(data), UInt32(truncatingIfNeeded: data.count)] {
+                out.append(contentsOf: [UInt8(value & 0xff), UInt8((value >> 8) & 0xff),
+                                        UInt8((value >> 16) & 0xff), UInt8(value >> 24)])
+            }
+            return out
+        #endif
+    }
+
     static private func encodeURLQueryParams(_ token: String, _ params: String) -> String {
         var query = ""
         if !token.isEmpty {
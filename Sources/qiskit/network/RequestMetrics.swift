@@ -0,0 +1,121 @@
+// Copyright 2017 IBM RESEARCH. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+
+import Foundation
+
+/**
+ Counters of the HTTP requests sent by a connector.
+
+ Every attempt counts as a request, retries included. Latencies are kept
+ as a histogram: latency_counts[i] is the number of requests that took at
+ most latency_bounds[i] seconds and more than the bound before it, the
+ last entry the number of requests slower than every bound.
+ */
+public final class RequestMetrics {
+
+    /**
+     Upper bounds in seconds of the latency buckets.
+     */
+    public static let latency_bounds: [Double] = [0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0, 60.0]
+
+    private let lock = NSLock()
+    private var _requests: Int = 0
+    private var _failures: Int = 0
+    private var _retries: Int = 0
+    private var _total_latency: Double = 0.0
+    private var _latency_counts = [Int](repeating: 0, count: RequestMetrics.latency_bounds.count + 1)
+
+    public init() {
+    }
+
+    /**
+     Number of requests that got a response or failed.
+     */
+    public var requests: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._requests
+    }
+
+    /**
+     Number of requests that failed.
+     */
+    public var failures: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._failures
+    }
+
+    /**
+     Number of requests sent again after a failure.
+     */
+    public var retries: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._retries
+    }
+
+    /**
+     Mean latency of the requests in seconds.
+     */
+    public var mean_latency: Double {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._requests > 0 ? self._total_latency / Double(self._requests) : 0.0
+    }
+
+    /**
+     Number of requests per latency bucket.
+     */
+    public var latency_counts: [Int] {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._latency_counts
+    }
+
+    /**
+     Sets every counter back to zero.
+     */
+    public func reset() {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        self._requests = 0
+        self._failures = 0
+        self._retries = 0
+        self._total_latency = 0.0
+        self._latency_counts = [Int](repeating: 0, count: RequestMetrics.latency_bounds.count + 1)
+    }
+
+    func record(_ latency: Double, failed: Bool) {
+        var bucket = 0
+        while bucket < RequestMetrics.latency_bounds.count && latency > RequestMetrics.latency_bounds[bucket] {
+            bucket += 1
+        }
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        self._requests += 1
+        if failed {
+            self._failures += 1
+        }
+        self._total_latency += latency
+        self._latency_counts[bucket] += 1
+    }
+
+    func record_retry() {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        self._retries += 1
+    }
+}
@@ -22,6 +22,7 @@ public final class RequestTask {
 
     private let task: URLSessionDataTask?
     private var children: [RequestTask] = []
+    private var cancel_handlers: [() -> Void] = []
     private var cancelled = false
     private let lock = NSRecursiveLock()
 
@@ -45,6 +46,20 @@ public final class RequestTask {
         self.lock.unlock()
     }
 
+    /**
+     Calls handler once the task is cancelled, right away if it already is
+     */
+    func on_cancel(_ handler: @escaping () -> Void) {
+        self.lock.lock()
+        if !self.cancelled {
+            self.cancel_handlers.append(handler)
+            self.lock.unlock()
+            return
+        }
+        self.lock.unlock()
+        handler()
+    }
+
     /**
      Checkes is is a task has been cancelled
      */
@@ -59,6 +74,7 @@ public final class RequestTask {
      */
     public func cancel() {
         self.lock.lock()
+        var handlers: [() -> Void] = []
         if !self.cancelled {
             if let t = self.task {
                 t.cancel()
@@ -67,8 +83,13 @@ public final class RequestTask {
                 requestTask.cancel()
             }
             self.cancelled = true
+            handlers = self.cancel_handlers
+            self.cancel_handlers = []
         }
         self.lock.unlock()
+        for handler in handlers {
+            handler()
+        }
     }
 
     public static func + (left: RequestTask, right: RequestTask) -> RequestTask {
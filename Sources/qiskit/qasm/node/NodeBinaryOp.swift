@@ -26,10 +26,16 @@ final class NodeBinaryOp: NodeRealValue {
 
     let op: String
     let _children: [Node]
+    /**
+     Value of the expression when it does not depend on gate parameters,
+     folded once when the node is built by the parser.
+     */
+    private(set) var constant: SymbolicValue? = nil
     
     init(op: String, children: [Node]) {
         self.op = op
         self._children = children
+        self.constant = try? self.real(nil)
     }
     
     var type: NodeType {
@@ -55,6 +61,9 @@ final class NodeBinaryOp: NodeRealValue {
     }
 
     func real(_ nested_scope: [[String:NodeRealValue]]? = nil) throws -> SymbolicValue {
+        if let value = self.constant {
+            return value
+        }
         let operation = self.op
         guard let lexpr = self._children[0] as? NodeRealValue else {
             throw QasmError.errorBinop(qasm: self.qasm(15))
@@ -81,4 +90,32 @@ final class NodeBinaryOp: NodeRealValue {
         }
         throw QasmError.errorBinop(qasm: self.qasm(15))
     }
+
+    func compile(_ slots: [String:Int]) throws -> CompiledRealValue {
+        if let value = self.constant {
+            return { _ in value }
+        }
+        guard let lexpr = self._children[0] as? NodeRealValue else {
+            throw QasmError.errorBinop(qasm: self.qasm(15))
+        }
+        guard let rexpr = self._children[1] as? NodeRealValue else {
+            throw QasmError.errorBinop(qasm: self.qasm(15))
+        }
+        let lhs = try lexpr.compile(slots)
+        let rhs = try rexpr.compile(slots)
+        switch self.op {
+        case "+":
+            return { try lhs($0) + rhs($0) }
+        case "-":
+            return { try lhs($0) - rhs($0) }
+        case "*":
+            return { try lhs($0) * rhs($0) }
+        case "/":
+            return { try lhs($0) / rhs($0) }
+        case "^":
+            return { try pow(lhs($0), rhs($0)) }
+        default:
+            throw QasmError.errorBinop(qasm: self.qasm(15))
+        }
+    }
 }
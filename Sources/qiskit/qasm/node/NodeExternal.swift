@@ -27,10 +27,16 @@ final class NodeExternal: NodeRealValue {
 
     let operation: String
     let expression: Node
+    /**
+     Value of the expression when it does not depend on gate parameters,
+     folded once when the node is built by the parser.
+     */
+    private(set) var constant: SymbolicValue? = nil
     
     init(operation: String, expression: Node) {
         self.operation = operation
         self.expression = expression
+        self.constant = try? self.real(nil)
     }
     
     var type: NodeType {
@@ -48,6 +54,9 @@ final class NodeExternal: NodeRealValue {
     }
 
     func real(_ nested_scope: [[String:NodeRealValue]]?) throws -> SymbolicValue {
+        if let value = self.constant {
+            return value
+        }
         if let expr = self.expression as? NodeRealValue {
             let arg = try expr.real(nested_scope)
             if self.operation == "sin" {
@@ -71,4 +80,30 @@ final class NodeExternal: NodeRealValue {
         }
         throw QasmError.errorExternal(qasm: self.qasm(15))
     }
+
+    func compile(_ slots: [String:Int]) throws -> CompiledRealValue {
+        if let value = self.constant {
+            return { _ in value }
+        }
+        guard let operand = self.expression as? NodeRealValue else {
+            throw QasmError.errorExternal(qasm: self.qasm(15))
+        }
+        let expr = try operand.compile(slots)
+        switch self.operation {
+        case "sin":
+            return { try sin(expr($0)) }
+        case "cos":
+            return { try cos(expr($0)) }
+        case "tan":
+            return { try tan(expr($0)) }
+        case "exp":
+            return { try exp(expr($0)) }
+        case "ln":
+            return { try log(expr($0)) }
+        case "sqrt":
+            return { try expr($0).squareRoot() }
+        default:
+            throw QasmError.errorExternal(qasm: self.qasm(15))
+        }
+    }
 }
@@ -66,4 +66,11 @@ final class NodeId: NodeRealValue {
         let endIndex: Int = scope.count - 1
         return try arg.real(Array(scope[0..<endIndex]))
     }
+
+    func compile(_ slots: [String:Int]) throws -> CompiledRealValue {
+        guard let slot = slots[self.name] else {
+            throw QasmError.errorLocalParameter(qasm: self.qasm(15))
+        }
+        return { $0[slot] }
+    }
 }
@@ -44,4 +44,9 @@ final class NodeNNInt: NodeRealValue {
     func real(_ nested_scope: [[String:NodeRealValue]]?) throws -> SymbolicValue {
         return SymbolicValue(Double(self.value))
     }
+
+    func compile(_ slots: [String:Int]) throws -> CompiledRealValue {
+        let value = SymbolicValue(Double(self.value))
+        return { _ in value }
+    }
 }
@@ -24,10 +24,16 @@ final class NodePrefix: NodeRealValue {
 
     let op: String
     let _children: [Node]
+    /**
+     Value of the expression when it does not depend on gate parameters,
+     folded once when the node is built by the parser.
+     */
+    private(set) var constant: SymbolicValue? = nil
 
     init(op: String, children: [Node]) {
         self.op = op
         self._children = children
+        self.constant = try? self.real(nil)
     }
     
     var type: NodeType {
@@ -47,6 +53,9 @@ final class NodePrefix: NodeRealValue {
     }
 
     func real(_ nested_scope: [[String:NodeRealValue]]?) throws -> SymbolicValue {
+        if let value = self.constant {
+            return value
+        }
         let operation = self.op
         guard let operand = self._children[0] as? NodeRealValue else {
             throw QasmError.errorPrefix(qasm: self.qasm(15))
@@ -60,4 +69,22 @@ final class NodePrefix: NodeRealValue {
         }
         throw QasmError.errorPrefix(qasm: self.qasm(15))
     }
+
+    func compile(_ slots: [String:Int]) throws -> CompiledRealValue {
+        if let value = self.constant {
+            return { _ in value }
+        }
+        guard let operand = self._children[0] as? NodeRealValue else {
+            throw QasmError.errorPrefix(qasm: self.qasm(15))
+        }
+        let expr = try operand.compile(slots)
+        switch self.op {
+        case "+":
+            return expr
+        case "-":
+            return { try -expr($0) }
+        default:
+            throw QasmError.errorPrefix(qasm: self.qasm(15))
+        }
+    }
 }
@@ -22,9 +22,20 @@ This node has no children. The data is in the value field.
 class NodeReal: NodeRealValue {
 
     let value: Double
+    /**
+     Value computed from a circuit parameter, kept so that it stays
+     symbolic when the node is evaluated.
+     */
+    private let symbolic: SymbolicValue?
     
     init(id: Double) {
         self.value = id
+        self.symbolic = nil
+    }
+
+    init(_ value: SymbolicValue) {
+        self.value = value.value
+        self.symbolic = !value.parameters.isEmpty ? value : nil
     }
     
     var type: NodeType {
@@ -40,8 +51,16 @@ class NodeReal: NodeRealValue {
     }
 
     func real(_ nested_scope: [[String:NodeRealValue]]?) throws -> SymbolicValue {
+        if let symbolic = self.symbolic {
+            return symbolic
+        }
         return SymbolicValue(self.value)
     }
+
+    func compile(_ slots: [String:Int]) throws -> CompiledRealValue {
+        let value = try self.real(nil)
+        return { _ in value }
+    }
 }
 
 final class NodeRealPI: NodeReal {
@@ -16,6 +16,17 @@
 
 import Foundation
 
+/**
+ Expression compiled against positional parameter slots.
+ */
+typealias CompiledRealValue = (_ slots: [SymbolicValue]) throws -> SymbolicValue
+
 protocol NodeRealValue: Node {
     func real(_ nested_scope: [[String:NodeRealValue]]?) throws -> SymbolicValue
+    /**
+     Compile the expression into a closure.
+     slots maps the local parameter ids to their position in the array
+     of values the closure is called with.
+     */
+    func compile(_ slots: [String:Int]) throws -> CompiledRealValue
 }
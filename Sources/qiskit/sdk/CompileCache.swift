@@ -0,0 +1,320 @@
+// Copyright 2017 IBM RESEARCH. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+
+import Foundation
+
+/**
+ Content addressed cache of OpenQuantumCompiler.compile results.
+
+ Entries are keyed by the QASM text together with every compile option, so
+ recompiling the same circuit with the same options returns the stored
+ result. The most recently used entries are kept in memory up to capacity.
+ When directory is set, entries are also written there as JSON files named
+ by the hash of their key and read back on a memory miss.
+
+ Each hit returns a deep copy of the stored DAG, which costs about as much
+ as the unrolling step of a compile: the cache pays off for mapped circuits
+ and repeated compilations, not for one shot compiles of small circuits.
+ */
+public final class CompileCache {
+
+    /**
+     Process wide cache for the programs that opt in by setting their
+     compile_cache to it.
+     */
+    public static let shared = CompileCache()
+
+    /**
+     Maximum number of entries kept in memory.
+     */
+    public var capacity: Int {
+        get {
+            self.lock.lock()
+            defer { self.lock.unlock() }
+            return self._capacity
+        }
+        set {
+            self.lock.lock()
+            defer { self.lock.unlock() }
+            self._capacity = max(newValue, 0)
+            self._evict()
+        }
+    }
+
+    /**
+     Directory holding the persisted entries, nil to keep them in memory only.
+     */
+    public var directory: URL? {
+        get {
+            self.lock.lock()
+            defer { self.lock.unlock() }
+            return self._directory
+        }
+        set {
+            self.lock.lock()
+            defer { self.lock.unlock() }
+            self._directory = newValue
+        }
+    }
+
+    /**
+     Number of lookups answered from memory or disk.
+     */
+    public var hits: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._hits
+    }
+
+    /**
+     Number of lookups that had to compile.
+     */
+    public var misses: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._misses
+    }
+
+    /**
+     Number of entries held in memory.
+     */
+    public var count: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.entries.count
+    }
+
+    private let lock = NSLock()
+    private var _capacity: Int
+    private var _directory: URL?
+    private var _hits: Int = 0
+    private var _misses: Int = 0
+    private var entries: OrderedDictionary<String,CompiledCircuit> = OrderedDictionary<String,CompiledCircuit>()
+
+    public init(capacity: Int = 256, directory: URL? = nil) {
+        self._capacity = max(capacity, 0)
+        self._directory = directory
+    }
+
+    /**
+     Drop the entries held in memory and reset the statistics. Persisted
+     entries are kept.
+     */
+    public func clear() {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        self.entries = OrderedDictionary<String,CompiledCircuit>()
+        self._hits = 0
+        self._misses = 0
+    }
+
+    /**
+     Canonical key of a compilation: the options, one per line, followed by
+     the QASM text.
+     */
+    static func key(_ qasm_circuit: String,
+                    _ basis_gates: String,
+                    _ coupling_map: [Int:[Int]]?,
+                    _ initial_layout: OrderedDictionary<RegBit,RegBit>?,
+                    _ get_layout: Bool,
+                    _ format: String,
+                    _ mapper: String) -> String {
+        var coupling = "None"
+        if let map = coupling_map {
+            coupling = map.keys.sorted().map { (k) -> String in
+                let targets = map[k]!.map { String($0) }
+                return "\(k):\(targets.joined(separator: ","))"
+            }.joined(separator: ";")
+        }
+        var layout = "None"
+        if let l = initial_layout {
+            layout = l.map { "\($0.0.qasm)->\($0.1.qasm)" }.joined(separator: ",")
+        }
+        return "basis_gates=\(basis_gates)\n" +
+            "coupling_map=\(coupling)\n" +
+            "initial_layout=\(layout)\n" +
+            "get_layout=\(get_layout)\n" +
+            "format=\(format)\n" +
+            "mapper=\(mapper)\n" +
+            qasm_circuit
+    }
+
+    /**
+     Return a copy of the result stored for key, nil on a miss.
+     */
+    func get(_ key: String) -> CompiledCircuit? {
+        self.lock.lock()
+        if let compiled = self.entries[key] {
+            // Move to the most recently used end
+            self.entries.removeValue(forKey: key)
+            self.entries[key] = compiled
+            self._hits += 1
+            self.lock.unlock()
+            // stored entries are never mutated, the copy needs no lock
+            return CompileCache.copy(compiled)
+        }
+        let url = self._url(key)
+        self.lock.unlock()
+        let loaded = url != nil ? CompileCache._load(key, url!) : nil
+        self.lock.lock()
+        if let compiled = loaded {
+            self._store(key, compiled)
+            self._hits += 1
+        }
+        else {
+            self._misses += 1
+        }
+        self.lock.unlock()
+        return loaded != nil ? CompileCache.copy(loaded!) : nil
+    }
+
+    /**
+     Store a copy of compiled under key, also writing it to the directory.
+     */
+    func put(_ key: String, _ compiled: CompiledCircuit) {
+        let stored = CompileCache.copy(compiled)
+        self.lock.lock()
+        self._store(key, stored)
+        let url = self._url(key)
+        self.lock.unlock()
+        if let url = url {
+            CompileCache._save(key, stored, url)
+        }
+    }
+
+    /**
+     Called locked.
+     */
+    private func _store(_ key: String, _ compiled: CompiledCircuit) {
+        if self._capacity == 0 {
+            return
+        }
+        self.entries.removeValue(forKey: key)
+        self.entries[key] = compiled
+        self._evict()
+    }
+
+    private func _evict() {
+        while self.entries.count > self._capacity {
+            self.entries.removeValue(forKey: self.entries.keys[0])
+        }
+    }
+
+    /**
+     Entries are returned and stored as copies, the DAG being mutable.
+     */
+    private static func copy(_ compiled: CompiledCircuit) -> CompiledCircuit {
+        let c = CompiledCircuit()
+        c.dag = compiled.dag?.deepcopy()
+        c.json = compiled.json
+        c.qasm = compiled.qasm
+        c.final_layout = compiled.final_layout
+        return c
+    }
+
+    /**
+     64 bit FNV-1a hash of key, in hex. Names the persisted entry.
+     */
+    static func hash(_ key: String) -> String {
+        var h: UInt64 = 0xcbf29ce484222325
+        for byte in key.utf8 {
+            h ^= UInt64(byte)
+            h = h &* 0x100000001b3
+        }
+        return String(format: "%016llx", h)
+    }
+
+    /**
+     File of the persisted entry. Called locked.
+     */
+    private func _url(_ key: String) -> URL? {
+        return self._directory?.appendingPathComponent("\(CompileCache.hash(key)).json")
+    }
+
+    /**
+     Write the entry as JSON. The DAG is stored as QASM with its basis.
+     Failures only cost the persisted copy.
+     */
+    private static func _save(_ key: String, _ compiled: CompiledCircuit, _ url: URL) {
+        do {
+            var entry: [String:Any] = ["key": key]
+            if let dag = compiled.dag {
+                entry["dag"] = try dag.qasm()
+                entry["basis"] = dag.basis.keys
+            }
+            if let json = compiled.json {
+                entry["json"] = json.dictionary
+            }
+            if let qasm = compiled.qasm {
+                entry["qasm"] = qasm
+            }
+            if let final_layout = compiled.final_layout {
+                var list_layout: [[[Any]]] = []
+                for (k,v) in final_layout {
+                    list_layout.append([[k.name, k.index], [v.name, v.index]])
+                }
+                entry["final_layout"] = list_layout
+            }
+            try FileManager.default.createDirectory(at: url.deletingLastPathComponent(), withIntermediateDirectories: true, attributes: nil)
+            let data = try JSONSerialization.data(withJSONObject: entry, options: [])
+            try data.write(to: url, options: .atomic)
+        } catch {
+            SDKLogger.logError("CompileCache: could not save \(url.path): \(error)")
+        }
+    }
+
+    /**
+     Read a persisted entry, nil if it is missing, unreadable or was written
+     for another key with the same hash.
+     */
+    private static func _load(_ key: String, _ url: URL) -> CompiledCircuit? {
+        guard FileManager.default.fileExists(atPath: url.path) else {
+            return nil
+        }
+        do {
+            let data = try Data(contentsOf: url)
+            guard let entry = try JSONSerialization.jsonObject(with: data, options: []) as? [String:Any],
+                let stored_key = entry["key"] as? String, stored_key == key else {
+                return nil
+            }
+            let compiled = CompiledCircuit()
+            if let qasm = entry["dag"] as? String {
+                let basis = entry["basis"] as? [String] ?? []
+                let unroller = Unroller(try Qasm(data: qasm).parse(), DAGBackend(basis))
+                compiled.dag = try unroller.execute() as? DAGCircuit
+            }
+            if let json = entry["json"] as? [String:Any] {
+                compiled.json = QobjCompiledCircuit(json)
+            }
+            compiled.qasm = entry["qasm"] as? String
+            if let list_layout = entry["final_layout"] as? [[[Any]]] {
+                var final_layout = OrderedDictionary<RegBit,RegBit>()
+                for pair in list_layout {
+                    guard pair.count == 2, pair[0].count == 2, pair[1].count == 2,
+                        let kname = pair[0][0] as? String, let kindex = pair[0][1] as? Int,
+                        let vname = pair[1][0] as? String, let vindex = pair[1][1] as? Int else {
+                        return nil
+                    }
+                    final_layout[RegBit(kname, kindex)] = RegBit(vname, vindex)
+                }
+                compiled.final_layout = final_layout
+            }
+            return compiled
+        } catch {
+            SDKLogger.logError("CompileCache: could not load \(url.path): \(error)")
+            return nil
+        }
+    }
+}
@@ -0,0 +1,98 @@
+// Copyright 2017 IBM RESEARCH. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+
+import Foundation
+#if os(Linux)
+import Dispatch
+#endif
+
+/**
+ Where the SDK calls back with the results of its asynchronous calls.
+
+ By default the callbacks run on the main queue, which the application has
+ to drive. Processes without a main loop can have them delivered on a
+ queue of their own, on a serial queue of the SDK, or synchronously on the
+ thread that produced the result.
+ */
+public final class CompletionExecutor {
+
+    /**
+     Delivers on the main queue.
+     */
+    public static let main = CompletionExecutor(queue: DispatchQueue.main)
+
+    /**
+     Delivers on the thread that produced the result, without a hop.
+     */
+    public static let synchronous = CompletionExecutor()
+
+    /**
+     Delivers in order on a new serial queue.
+     */
+    public static func serial(_ label: String = "qiskit.completion") -> CompletionExecutor {
+        return CompletionExecutor(queue: DispatchQueue(label: label))
+    }
+
+    /**
+     Executor used by the SDK unless a QuantumProgram sets its own.
+     */
+    public static var shared: CompletionExecutor {
+        get {
+            CompletionExecutor.lock.lock()
+            defer { CompletionExecutor.lock.unlock() }
+            return CompletionExecutor._shared
+        }
+        set {
+            CompletionExecutor.lock.lock()
+            defer { CompletionExecutor.lock.unlock() }
+            CompletionExecutor._shared = newValue
+        }
+    }
+
+    private static let lock = NSLock()
+    private static var _shared: CompletionExecutor = CompletionExecutor.main
+
+    private let queue: DispatchQueue?
+
+    /**
+     Delivers on queue.
+     */
+    public init(queue: DispatchQueue) {
+        self.queue = queue
+    }
+
+    private init() {
+        self.queue = nil
+    }
+
+    /**
+     Whether the callbacks run on the main queue.
+     */
+    var isMain: Bool {
+        guard let queue = self.queue else {
+            return false
+        }
+        return queue.label == DispatchQueue.main.label
+    }
+
+    public func execute(_ block: @escaping () -> Void) {
+        if let queue = self.queue {
+            queue.async(execute: block)
+        }
+        else {
+            block()
+        }
+    }
+}
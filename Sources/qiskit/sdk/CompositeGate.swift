@@ -26,9 +26,13 @@ public protocol CompositeGate: Gate {
 extension CompositeGate {
 
     public var description: String {
+        return self._statements_qasm(false)
+    }
+
+    func _statements_qasm(_ symbolic: Bool) -> String {
         var text = ""
         for statement in self.compositeGateComponent.data {
-            text.append("\n\(statement.description);")
+            text.append("\n\(statement._qasm(symbolic: symbolic));")
         }
         return text
     }
@@ -30,6 +30,13 @@ protocol CopyableInstruction {
     func copy(_ c: QuantumCircuit) -> Instruction
 }
 
+/**
+ Instruction with params that can be bound to circuit parameters.
+ */
+protocol ParameterizedInstruction {
+    func _qasm(_ symbolic: Bool) -> String
+}
+
 extension Instruction {
 
     public var name: String {
@@ -52,6 +59,20 @@ extension Instruction {
         return self.description
     }
 
+    /**
+     Qasm of the instruction, with symbolic the bound params printed as
+     their parameter names.
+     */
+    func _qasm(symbolic: Bool) -> String {
+        if let instruction = self as? ParameterizedInstruction {
+            return instruction._qasm(symbolic)
+        }
+        if let gate = self as? CompositeGate {
+            return gate._statements_qasm(symbolic)
+        }
+        return self.description
+    }
+
     /**
      Apply any modifiers of this instruction to another one.
      */
@@ -66,6 +87,20 @@ extension Instruction {
         return self.instructionComponent._qasmif(string)
     }
 
+    /**
+     Bind param index to the circuit parameter name. The qasm keeps
+     printing the param value, the parameter being read by
+     QuantumProgram.compile. The parameter is added to the circuit with the
+     param value unless it exists already. The compiled circuit can then be
+     bound to new parameter values without compiling it again.
+     Inverting the instruction unbinds the params it changes.
+     */
+    @discardableResult
+    public func parameterize(_ name: String, _ index: Int = 0) throws -> Self {
+        try self.instructionComponent.parameterize(index, name)
+        return self
+    }
+
     @discardableResult
     public func c_if(_ classical: ClassicalRegister, _ val: Int) throws -> Instruction {
         try self.instructionComponent.c_if(classical,val)
@@ -21,7 +21,19 @@ import Foundation
 public final class InstructionComponent {
 
     let name: String
-    var params: [Double]
+    var params: [Double] {
+        didSet {
+            // A param given a new value is no longer bound to its parameter
+            for index in Array(self.symbols.keys) where index >= self.params.count || index >= oldValue.count ||
+                self.params[index] != oldValue[index] {
+                self.symbols[index] = nil
+            }
+        }
+    }
+    /**
+     Names of the circuit parameters the params are bound to, by index.
+     */
+    var symbols: [Int:String] = [:]
     let args: [RegisterArgument]
     unowned var circuit: QuantumCircuit
     private var control: (ClassicalRegister, Int)? = nil
@@ -43,6 +55,36 @@ public final class InstructionComponent {
         self.control = (classical, val)
     }
 
+    /**
+     Bind param index to the circuit parameter name. The parameter is added
+     to the circuit with the param value unless it exists already, in which
+     case the param takes the parameter value.
+     */
+    func parameterize(_ index: Int, _ name: String) throws {
+        if index < 0 || index >= self.params.count {
+            throw QISKitError.paramIndexRange
+        }
+        if let value = self.circuit.parameters[name] {
+            self.params[index] = value
+        }
+        else {
+            try self.circuit.add_parameter(name, self.params[index])
+        }
+        self.symbols[index] = name
+    }
+
+    /**
+     Return the qasm text of param index: its value, or with symbolic the
+     name of the parameter it is bound to, which only the Unroller given
+     the parameter values can read.
+     */
+    func param_qasm(_ index: Int, _ symbolic: Bool = false) -> String {
+        if symbolic, let name = self.symbols[index] {
+            return name
+        }
+        return self.params[index].format(15)
+    }
+
     /**
      Apply any modifiers of this instruction to another one.
      */
@@ -53,6 +95,9 @@ public final class InstructionComponent {
             }
             try instruction.c_if(self.control!.0, self.control!.1)
         }
+        for (index, name) in self.symbols {
+            try instruction.instructionComponent.parameterize(index, name)
+        }
     }
 
     /**
@@ -20,116 +20,184 @@ import Dispatch
 
 /**
  Process a bunch of jobs and collect the results
+
+ The jobs are started by a JobScheduler, which bounds how many of them run
+ at once. Results are collected in the order of the jobs, and responses
+ are called on the thread that produced them.
 */
 final class JobProcessor {
 
     let identifier: String
     private let backendUtils: BackendUtils
+    private let scheduler: JobScheduler
     private let q_jobs: [QuantumJob]
     private let callback: ((_:String, _:[Result]) -> Void)?
     private var num_jobs: Int
-    private var jobs_results: [Result] = []
+    private var jobs_results: [Result?] = []
     private let lock = NSRecursiveLock()
 
     init(_ backendUtils: BackendUtils,
          _ q_jobs: [QuantumJob],
-         _ callback: ((_:String, _:[Result]) -> Void)?) {
+         _ callback: ((_:String, _:[Result]) -> Void)?,
+         scheduler: JobScheduler = JobScheduler.shared) {
         self.identifier = UUID().uuidString
         self.backendUtils = backendUtils
+        self.scheduler = scheduler
         self.q_jobs = q_jobs
         self.callback = callback
         self.num_jobs = self.q_jobs.count
+        self.jobs_results = [Result?](repeating: nil, count: self.q_jobs.count)
     }
 
     init() {
         self.identifier = UUID().uuidString
         self.backendUtils = BackendUtils()
+        self.scheduler = JobScheduler.shared
         self.q_jobs = []
         self.callback = nil
         self.num_jobs = self.q_jobs.count
     }
 
-    private func _job_done_callback(_ result: Result) {
+    private func _job_done_callback(_ index: Int, _ result: Result) {
         self.lock.lock()
-        self.jobs_results.append(result)
-        if self.num_jobs > 0 {
-            self.num_jobs -= 1
+        if self.jobs_results[index] != nil {
+            self.lock.unlock()
+            return
         }
-        self.lock.unlock()
+        self.jobs_results[index] = result
+        self.num_jobs -= 1
         // Call the callback when all jobs have finished
+        var results: [Result]? = nil
         if self.num_jobs == 0 {
+            results = self.jobs_results.map { $0! }
+        }
+        self.lock.unlock()
+        if let jobs_results = results {
             SDKLogger.logInfo(SDKLogger.debugString(result))
-            self.callback?(self.identifier,self.jobs_results)
+            self.callback?(self.identifier,jobs_results)
         }
     }
 
     func submit() -> RequestTask {
         let reqTask = RequestTask()
-        for q_job in self.q_jobs {
-            let r = self.run_backend(q_job, self._job_done_callback)
+        for (index, q_job) in self.q_jobs.enumerated() {
+            let r = self.run_backend(q_job) { (result) in
+                self._job_done_callback(index, result)
+            }
             reqTask.add(r)
         }
         return reqTask
     }
 
+    /**
+     Bytes of the quantum states a local simulator holds at once for
+     q_job: the state vector, or the unitary, of its widest circuit.
+     */
+    static func estimated_memory(_ q_job: QuantumJob) -> Int {
+        let unitary = q_job.backend.contains("unitary")
+        var memory = 0
+        for circuit in q_job._qobj.circuits {
+            let qubits = circuit.compiled_circuit?.header.number_of_qubits ?? 0
+            let bits = unitary ? 2 * qubits : qubits
+            // 16 bytes per complex amplitude
+            if bits + 4 >= Int.bitWidth - 1 {
+                return Int.max
+            }
+            memory = max(memory, 16 << bits)
+        }
+        return memory
+    }
+
     @discardableResult
     func run_backend(_ q_job: QuantumJob, _ response: @escaping ((_:Result) -> Void)) -> RequestTask {
         let reqTask = RequestTask()
         do {
             let backend_name = q_job.backend
-            var qobj = q_job.qobj
+            let local = self.backendUtils.local_backends().contains(backend_name)
             // remove condition when api gets qobj
-            if self.backendUtils.local_backends().contains(backend_name) {
-                if let circuits = qobj["circuits"] as? [[String:Any]] {
-                    var newCircuits: [[String:Any]] = []
-                    for var circuit in circuits {
-                        if circuit["compiled_circuit"] == nil {
-                            circuit["compiled_circuit"] = try OpenQuantumCompiler.compile(circuit["circuit"] as! String, format: "json")
-                        }
-                        newCircuits.append(circuit)
+            if local {
+                for i in 0..<q_job._qobj.circuits.count {
+                    if q_job._qobj.circuits[i].compiled_circuit != nil {
+                        continue
+                    }
+                    if let dag = q_job._qobj.circuits[i].circuit {
+                        q_job._qobj.circuits[i].compiled_circuit = try OpenQuantumCompiler.compile(dag.qasm(), format: "json").json
                     }
-                    qobj["circuits"] = newCircuits
                 }
-                q_job._qobj = qobj
             }
-            let startDate = Date()
-            let r = self.backendUtils.get_backend_instance(backend_name) { (backend,error) in
-                if error != nil {
-                    response(Result("0",error!,q_job.qobj))
-                    return
+            // a job expired at its deadline may still report back later
+            let lock = NSLock()
+            var responded = false
+            func respond(_ result: Result) {
+                lock.lock()
+                let first = !responded
+                responded = true
+                lock.unlock()
+                if first {
+                    response(result)
                 }
-                let timeInterval = Int(Date().timeIntervalSince(startDate))
-                if timeInterval >= q_job.timeout {
-                    response(Result("0",QISKitError.jobTimeout(timeout: q_job.timeout),q_job.qobj))
-                    return
+            }
+            self.scheduler.submit(backend_name,
+                                  local: local,
+                                  priority: q_job.priority,
+                                  memory: local ? JobProcessor.estimated_memory(q_job) : 0,
+                                  timeout: q_job.timeout,
+                                  task: reqTask,
+                                  start: { (done) in
+                // the timeout counts from the start, not the time spent queued
+                self._run_backend(q_job, Date(), reqTask) { (result) in
+                    done()
+                    respond(result)
                 }
-                let r = backend!.run(q_job) { (r) in
-                    var result = r
-                    if let error = result.get_error() {
-                        let timeInterval = Int(Date().timeIntervalSince(startDate))
-                        if timeInterval >= q_job.timeout {
-                            switch error {
-                            case QISKitError.jobTimeout(_):
-                                break
-                            default:
-                                result._result["result"] = QISKitError.jobTimeout(timeout: q_job.timeout)
-                            }
+            }, expire: { (timed_out) in
+                let error: Error = timed_out ? QISKitError.jobTimeout(timeout: q_job.timeout) : QISKitError.jobCancelled
+                respond(Result("0",error,q_job.qobj))
+            })
+        } catch {
+            response(Result("0",error,q_job.qobj))
+        }
+        return reqTask
+    }
+
+    /**
+     Runs q_job once the scheduler started it.
+     */
+    private func _run_backend(_ q_job: QuantumJob,
+                              _ startDate: Date,
+                              _ reqTask: RequestTask,
+                              _ response: @escaping ((_:Result) -> Void)) {
+        let backend_name = q_job.backend
+        let r = self.backendUtils.get_backend_instance(backend_name) { (backend,error) in
+            if error != nil {
+                response(Result("0",error!,q_job.qobj))
+                return
+            }
+            let timeInterval = Int(Date().timeIntervalSince(startDate))
+            if timeInterval >= q_job.timeout {
+                self.backendUtils.release_backend_instance(backend_name, backend!)
+                response(Result("0",QISKitError.jobTimeout(timeout: q_job.timeout),q_job.qobj))
+                return
+            }
+            // The results come back to the processor without a hop
+            backend!.executor = CompletionExecutor.synchronous
+            let r = backend!.run(q_job) { (r) in
+                self.backendUtils.release_backend_instance(backend_name, backend!)
+                var result = r
+                if let error = result.get_error() {
+                    let timeInterval = Int(Date().timeIntervalSince(startDate))
+                    if timeInterval >= q_job.timeout {
+                        switch error {
+                        case QISKitError.jobTimeout(_):
+                            break
+                        default:
+                            result._result["result"] = QISKitError.jobTimeout(timeout: q_job.timeout)
                         }
                     }
-                    response(result)
                 }
-                reqTask.add(r)
+                response(result)
             }
             reqTask.add(r)
-            // cancel in case of timeout
-            DispatchQueue.global(qos: .background).asyncAfter(deadline: .now() + .seconds(q_job.timeout)) {
-                reqTask.cancel()
-            }
-        } catch {
-            DispatchQueue.main.async {
-                response(Result("0",error,q_job.qobj))
-            }
         }
-        return reqTask
+        reqTask.add(r)
     }
 }
@@ -0,0 +1,361 @@
+// Copyright 2017 IBM RESEARCH. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+
+import Foundation
+#if os(Linux)
+import Dispatch
+#endif
+
+/**
+ Decides when the jobs submitted by JobProcessor start.
+
+ Waiting jobs are kept in a queue ordered by priority, higher first, then
+ by submission, until they start or are cancelled. A job starts once its
+ backend runs fewer than its maximum number of jobs, max_jobs for local
+ backends and remote_max_jobs for remote ones unless the backend has its
+ own, and, when it holds quantum states in memory, once its estimated
+ memory fits in memory_limit next to the running jobs. A job larger than
+ memory_limit runs alone, and while it waits no smaller job overtakes it
+ for memory.
+
+ A job has its timeout from the time it starts. A single timer handles
+ the deadlines: running jobs past theirs are cancelled and expire. A
+ remote job frees its slot right away, whether or not it ever reports
+ back; a local job keeps its slot and its memory until it stops.
+ */
+public final class JobScheduler {
+
+    /**
+     Scheduler used by QuantumProgram.
+     */
+    public static let shared = JobScheduler()
+
+    /**
+     Maximum number of jobs running at once on a local backend without its
+     own limit.
+     */
+    public var max_jobs: Int {
+        get {
+            self.lock.lock()
+            defer { self.lock.unlock() }
+            return self._max_jobs
+        }
+        set {
+            self.lock.lock()
+            self._max_jobs = max(newValue, 1)
+            let (ready, expired) = self._dequeue()
+            self.lock.unlock()
+            self._dispatch(ready, expired)
+        }
+    }
+
+    /**
+     Maximum number of jobs running at once on a remote backend without its
+     own limit.
+     */
+    public var remote_max_jobs: Int {
+        get {
+            self.lock.lock()
+            defer { self.lock.unlock() }
+            return self._remote_max_jobs
+        }
+        set {
+            self.lock.lock()
+            self._remote_max_jobs = max(newValue, 1)
+            let (ready, expired) = self._dequeue()
+            self.lock.unlock()
+            self._dispatch(ready, expired)
+        }
+    }
+
+    /**
+     Bytes available to the quantum states of the running local jobs.
+     */
+    public var memory_limit: Int {
+        get {
+            self.lock.lock()
+            defer { self.lock.unlock() }
+            return self._memory_limit
+        }
+        set {
+            self.lock.lock()
+            self._memory_limit = max(newValue, 0)
+            let (ready, expired) = self._dequeue()
+            self.lock.unlock()
+            self._dispatch(ready, expired)
+        }
+    }
+
+    /**
+     Number of jobs waiting to start.
+     */
+    public var queued: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.queue.count
+    }
+
+    /**
+     Number of jobs started and not finished.
+     */
+    public var running: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.running_jobs.count
+    }
+
+    /**
+     A submitted job. start runs it and calls its argument once the job
+     has finished. expire reports a job that did not finish, with whether
+     its deadline passed: false for a job cancelled while waiting, true for
+     a running job at its deadline.
+     */
+    private final class Job {
+        let backend: String
+        let local: Bool
+        let priority: Int
+        let sequence: Int
+        let memory: Int
+        let timeout: Int
+        let task: RequestTask
+        let start: (@escaping () -> Void) -> Void
+        let expire: (Bool) -> Void
+        /**
+         Set when the job starts.
+         */
+        var deadline: DispatchTime = .distantFuture
+        /**
+         Whether a running job reached its deadline but holds its slot
+         until it stops.
+         */
+        var timed_out = false
+
+        init(_ backend: String,
+             _ local: Bool,
+             _ priority: Int,
+             _ sequence: Int,
+             _ memory: Int,
+             _ timeout: Int,
+             _ task: RequestTask,
+             _ start: @escaping (@escaping () -> Void) -> Void,
+             _ expire: @escaping (Bool) -> Void) {
+            self.backend = backend
+            self.local = local
+            self.priority = priority
+            self.sequence = sequence
+            self.memory = memory
+            self.timeout = timeout
+            self.task = task
+            self.start = start
+            self.expire = expire
+        }
+    }
+
+    private let lock = NSRecursiveLock()
+    private var _max_jobs: Int
+    private var _remote_max_jobs: Int
+    private var _memory_limit: Int
+    private var backend_max_jobs: [String:Int] = [:]
+    private var queue: [Job] = []
+    private var running_jobs: [Int:Job] = [:]
+    private var running_count: [String:Int] = [:]
+    private var memory_in_use: Int = 0
+    private var sequence: Int = 0
+    private let timer: DispatchSourceTimer
+
+    public init(max_jobs: Int = ProcessInfo.processInfo.activeProcessorCount,
+                memory_limit: Int = Int(min(ProcessInfo.processInfo.physicalMemory / 2, UInt64(Int.max))),
+                remote_max_jobs: Int = 10) {
+        self._max_jobs = max(max_jobs, 1)
+        self._remote_max_jobs = max(remote_max_jobs, 1)
+        self._memory_limit = max(memory_limit, 0)
+        self.timer = DispatchSource.makeTimerSource(queue: DispatchQueue.global(qos: .background))
+        self.timer.setEventHandler { [weak self] in
+            self?._deadline_reached()
+        }
+        self.timer.schedule(deadline: .distantFuture)
+        self.timer.resume()
+    }
+
+    deinit {
+        self.timer.cancel()
+    }
+
+    /**
+     Maximum number of jobs running at once on backend, local or not.
+     */
+    public func max_jobs(_ backend: String, local: Bool = true) -> Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.backend_max_jobs[backend] ?? (local ? self._max_jobs : self._remote_max_jobs)
+    }
+
+    /**
+     Sets the maximum number of jobs running at once on backend, nil to
+     use max_jobs or remote_max_jobs.
+     */
+    public func set_max_jobs(_ max_jobs: Int?, backend: String) {
+        self.lock.lock()
+        self.backend_max_jobs[backend] = max_jobs != nil ? max(max_jobs!, 1) : nil
+        let (ready, expired) = self._dequeue()
+        self.lock.unlock()
+        self._dispatch(ready, expired)
+    }
+
+    /**
+     Queues a job on backend, with memory the bytes of quantum states it
+     holds at once, and timeout the seconds it has to finish once started.
+     */
+    func submit(_ backend: String,
+                local: Bool,
+                priority: Int,
+                memory: Int,
+                timeout: Int,
+                task: RequestTask,
+                start: @escaping (@escaping () -> Void) -> Void,
+                expire: @escaping (Bool) -> Void) {
+        self.lock.lock()
+        let job = Job(backend, local, priority, self.sequence, max(memory, 0), timeout, task, start, expire)
+        self.sequence += 1
+        var position = self.queue.count
+        while position > 0 && self.queue[position - 1].priority < priority {
+            position -= 1
+        }
+        self.queue.insert(job, at: position)
+        let (ready, expired) = self._dequeue()
+        self.lock.unlock()
+        self._dispatch(ready, expired)
+        task.on_cancel { [weak self] in
+            self?._cancelled(job)
+        }
+    }
+
+    /**
+     Takes out of the queue the jobs that can start and the jobs that
+     were cancelled, updating the accounting and the timer. Called locked.
+     */
+    private func _dequeue() -> ([Job],[Job]) {
+        var ready: [Job] = []
+        var expired: [Job] = []
+        var waiting: [Job] = []
+        var memory_blocked = false
+        let now = DispatchTime.now()
+        for job in self.queue {
+            if job.task.isCancelled() {
+                expired.append(job)
+                continue
+            }
+            let count = self.running_count[job.backend, default: 0]
+            let max_jobs = self.backend_max_jobs[job.backend] ?? (job.local ? self._max_jobs : self._remote_max_jobs)
+            if count >= max_jobs {
+                waiting.append(job)
+                continue
+            }
+            if job.memory > 0 {
+                let fits = self.memory_in_use == 0 ||
+                           self.memory_in_use <= self._memory_limit - job.memory
+                if memory_blocked || !fits {
+                    memory_blocked = true
+                    waiting.append(job)
+                    continue
+                }
+            }
+            self.running_count[job.backend] = count + 1
+            self.memory_in_use += job.memory
+            job.deadline = now + .seconds(job.timeout)
+            self.running_jobs[job.sequence] = job
+            ready.append(job)
+        }
+        self.queue = waiting
+        self._schedule_timer()
+        return (ready, expired)
+    }
+
+    /**
+     Starts and expires jobs, outside the lock.
+     */
+    private func _dispatch(_ ready: [Job], _ expired: [Job]) {
+        for job in expired {
+            job.expire(false)
+        }
+        for job in ready {
+            job.start { [weak self] in
+                self?._finished(job)
+            }
+        }
+    }
+
+    private func _finished(_ job: Job) {
+        self.lock.lock()
+        if self.running_jobs.removeValue(forKey: job.sequence) == nil {
+            self.lock.unlock()
+            return
+        }
+        self.running_count[job.backend, default: 1] -= 1
+        self.memory_in_use -= job.memory
+        let (ready, expired) = self._dequeue()
+        self.lock.unlock()
+        self._dispatch(ready, expired)
+    }
+
+    private func _cancelled(_ job: Job) {
+        self.lock.lock()
+        if !self.queue.contains(where: { $0 === job }) {
+            self.lock.unlock()
+            return
+        }
+        let (ready, expired) = self._dequeue()
+        self.lock.unlock()
+        self._dispatch(ready, expired)
+    }
+
+    /**
+     Cancels and expires the running jobs past their deadline. Jobs without
+     quantum states in memory give back their slot right away, the done
+     call they make later doing nothing. The others keep it, with their
+     memory, until they stop and call done.
+     */
+    private func _deadline_reached() {
+        self.lock.lock()
+        let now = DispatchTime.now()
+        var timed_out: [Job] = []
+        for job in Array(self.running_jobs.values) where !job.timed_out && job.deadline <= now {
+            job.timed_out = true
+            if job.memory == 0 {
+                self.running_jobs[job.sequence] = nil
+                self.running_count[job.backend, default: 1] -= 1
+            }
+            timed_out.append(job)
+        }
+        let (ready, expired) = self._dequeue()
+        self.lock.unlock()
+        for job in timed_out {
+            job.task.cancel()
+            job.expire(true)
+        }
+        self._dispatch(ready, expired)
+    }
+
+    /**
+     Sets the timer to the earliest deadline still to handle. Called locked.
+     */
+    private func _schedule_timer() {
+        var deadline = DispatchTime.distantFuture
+        for job in self.running_jobs.values where !job.timed_out && job.deadline < deadline {
+            deadline = job.deadline
+        }
+        self.timer.schedule(deadline: deadline)
+    }
+}
@@ -16,7 +16,7 @@
 import Foundation
 
 final class CompiledCircuit {
-    var json: [String:Any]? = nil
+    var json: QobjCompiledCircuit? = nil
     var qasm: String? = nil
     var dag: DAGCircuit? = nil
     var final_layout: OrderedDictionary<RegBit,RegBit>? = nil
@@ -57,6 +57,14 @@ final class OpenQuantumCompiler {
              }
          format (str): The target format of the compilation:
              {'dag', 'json', 'qasm'}
+         mapper (str): The router used with a coupling map:
+             {'swap', 'lookahead'}
+         parameters (dict): Values of the circuit parameters used in
+             qasm_circuit. Params computed from them stay symbolic in the
+             compiled circuit so that it can be bound to new values.
+         cache (CompileCache): Cache of earlier results, nil to always
+             compile. Hits return deep copies, see CompileCache. Circuits
+             with parameters are always compiled
      Returns:
          Compiled circuit
      */
@@ -65,9 +73,33 @@ final class OpenQuantumCompiler {
                         coupling_map: [Int:[Int]]? = nil,
                         initial_layout: OrderedDictionary<RegBit,RegBit>? = nil,
                         get_layout: Bool = false,
-                        format: String = "dag") throws -> CompiledCircuit {
+                        format: String = "dag",
+                        mapper: String = "swap",
+                        parameters: [String:Double] = [:],
+                        cache: CompileCache? = nil) throws -> CompiledCircuit {
+        // every parameter value would be an entry of its own
+        guard let cache = cache, parameters.isEmpty else {
+            return try _compile(qasm_circuit, basis_gates, coupling_map, initial_layout, get_layout, format, mapper, parameters)
+        }
+        let key = CompileCache.key(qasm_circuit, basis_gates, coupling_map, initial_layout, get_layout, format, mapper)
+        if let compiled_circuit = cache.get(key) {
+            return compiled_circuit
+        }
+        let compiled_circuit = try _compile(qasm_circuit, basis_gates, coupling_map, initial_layout, get_layout, format, mapper, parameters)
+        cache.put(key, compiled_circuit)
+        return compiled_circuit
+    }
+
+    private static func _compile(_ qasm_circuit: String,
+                                 _ basis_gates: String,
+                                 _ coupling_map: [Int:[Int]]?,
+                                 _ initial_layout: OrderedDictionary<RegBit,RegBit>?,
+                                 _ get_layout: Bool,
+                                 _ format: String,
+                                 _ mapper: String,
+                                 _ parameters: [String:Double]) throws -> CompiledCircuit {
 
-        var compiled_dag_circuit = try _unroller_code(qasm_circuit, basis_gates)
+        var compiled_dag_circuit = try _unroller_code(qasm_circuit, basis_gates, parameters)
         var final_layout:OrderedDictionary<RegBit,RegBit>? = nil
 
         // if a coupling map is given compile to the map
@@ -77,17 +109,23 @@ final class OpenQuantumCompiler {
             let coupling = try Coupling(coupling_map)
             SDKLogger.logInfo("initial layout: \(SDKLogger.debugString(initial_layout ?? OrderedDictionary<RegBit,RegBit>()))")
             var layout:OrderedDictionary<RegBit,RegBit> = OrderedDictionary<RegBit,RegBit>()
-            (compiled_dag_circuit, layout) = try Mapping.swap_mapper(compiled_dag_circuit, coupling, initial_layout, trials: 20, seed: 13)
+            if mapper == "swap" {
+                (compiled_dag_circuit, layout) = try Mapping.swap_mapper(compiled_dag_circuit, coupling, initial_layout, trials: 20, seed: 13)
+            }
+            else if mapper == "lookahead" {
+                (compiled_dag_circuit, layout) = try Mapping.lookahead_mapper(compiled_dag_circuit, coupling, initial_layout)
+            }
+            else {
+                throw QisKitCompilerError.unknownMapper(name: mapper)
+            }
             final_layout = layout
             SDKLogger.logInfo("final layout: \(SDKLogger.debugString(final_layout!))")
             // Expand swaps
-            compiled_dag_circuit = try _unroller_code(try compiled_dag_circuit.qasm())
+            try Mapping.expand_swaps(compiled_dag_circuit)
             // Change cx directions
             compiled_dag_circuit = try Mapping.direction_mapper(compiled_dag_circuit,coupling)
-            // Simplify cx gates
-            try Mapping.cx_cancellation(compiled_dag_circuit)
-            // Simplify single qubit gates
-            compiled_dag_circuit = try Mapping.optimize_1q_gates(compiled_dag_circuit)
+            // Simplify cx and single qubit gates
+            compiled_dag_circuit = try Mapping.peephole_optimize(compiled_dag_circuit)
             SDKLogger.logInfo("post-mapping properties: \(SDKLogger.debugString(try compiled_dag_circuit.property_summary()))")
         }
 
@@ -97,7 +135,7 @@ final class OpenQuantumCompiler {
             compiled_circuit.dag = compiled_dag_circuit
         }
         else if format == "json" {
-            compiled_circuit.json = try dag2json(compiled_dag_circuit)
+            compiled_circuit.json = try dag2qobj(compiled_dag_circuit)
         }
         else if format == "qasm" {
             compiled_circuit.qasm = try compiled_dag_circuit.qasm()
@@ -119,18 +157,22 @@ final class OpenQuantumCompiler {
              qasm_circuit: a circuit representation as qasm text.
              basis_gates (str): a comma seperated string and are the base gates,
                  which by default are: u1,u2,u3,cx,id
+             parameters (dict): values of the circuit parameters
          Return:
              dag_ciruit (dag object): a dag representation of the circuit
                  unrolled to basis gates
      */
-    private static func _unroller_code(_ qasm_circuit: String, _ basis_gates: String? = nil) throws -> DAGCircuit {
+    private static func _unroller_code(_ qasm_circuit: String,
+                                       _ basis_gates: String? = nil,
+                                       _ parameters: [String:Double] = [:]) throws -> DAGCircuit {
         var basis = "u1,u2,u3,cx,id"  // QE target basis
         if let b = basis_gates {
             basis = b
         }
         let program_node_circuit = try Qasm(data: qasm_circuit).parse()
         let unrolled_circuit = Unroller(program_node_circuit,
-                                        DAGBackend(basis.components(separatedBy:",")))
+                                        DAGBackend(basis.components(separatedBy:",")),
+                                        parameters: parameters)
         let dag_circuit_unrolled = try unrolled_circuit.execute() as! DAGCircuit
         return dag_circuit_unrolled
     }
@@ -147,14 +189,30 @@ final class OpenQuantumCompiler {
          the json version of the dag
      */
     static func dag2json(_ dag_circuit: DAGCircuit, basis_gates: String = "u1,u2,u3,cx,id") throws -> [String:Any] {
-        // TODO: Jay: I think this needs to become a method like .qasm() for the DAG.
+        return try dag2qobj(dag_circuit, basis_gates: basis_gates).dictionary
+    }
+
+    /**
+     Make a typed qobj compiled circuit of the dag.
+     See dag2json.
+     */
+    static func dag2qobj(_ dag_circuit: DAGCircuit, basis_gates: String = "u1,u2,u3,cx,id") throws -> QobjCompiledCircuit {
+        // The DAG is emitted directly when all of its operations are already
+        // in the target basis, otherwise it is unrolled through qasm.
+        var emit: Set<String> = ["U", "CX", "measure", "reset", "barrier"]
+        emit.formUnion(basis_gates.components(separatedBy:","))
+        if Set<String>(dag_circuit.basis.keys).isSubset(of: emit) {
+            return try dag_circuit.compiled_circuit()
+        }
         var circuit_string: String = ""
         do {
             circuit_string = try dag_circuit.qasm(qeflag: true)
         } catch {
             circuit_string = try dag_circuit.qasm()
         }
-        let unroller = Unroller(try Qasm(data: circuit_string).parse(), JsonBackend(basis_gates.components(separatedBy:",")))
-        return try unroller.execute() as! [String:Any]
+        let backend = JsonBackend(basis_gates.components(separatedBy:","))
+        let unroller = Unroller(try Qasm(data: circuit_string).parse(), backend)
+        _ = try unroller.execute()
+        return backend.get_compiled_circuit()
     }
 }
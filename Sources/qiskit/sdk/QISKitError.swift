@@ -50,8 +50,14 @@ public enum QISKitError: LocalizedError, CustomStringConvertible {
     case noCounts(name: String)
     case invalidResultsCombine
     case invalidFile(file: String)
+    case invalidFileFormat(format: String)
     case jobTimeout(timeout: Int)
+    case jobCancelled
+    case blockingMainQueue
     case unknownHPC
+    case parameterName(name: String)
+    case paramIndexRange
+    case parameterNotBindable(name: String)
     case internalError(error: Error)
 
     public var errorDescription: String? {
@@ -119,10 +125,22 @@ public enum QISKitError: LocalizedError, CustomStringConvertible {
             return "Result objects have different configs and cannot be combined."
         case .invalidFile(let file):
             return "Invalid file '\(file)'."
+        case .invalidFileFormat(let format):
+            return "Invalid file format '\(format)'."
         case .jobTimeout(let timeout):
             return "Error waiting for Job results: Timeout after \(timeout) seconds."
+        case .jobCancelled:
+            return "Job cancelled before it started."
+        case .blockingMainQueue:
+            return "Cannot wait on the main thread for callbacks delivered on the main queue, set CompletionExecutor.shared to another executor."
         case .unknownHPC:
             return "Unknown HPC parameter format!"
+        case .parameterName(let name):
+            return "invalid OPENQASM parameter name '\(name)'"
+        case .paramIndexRange:
+            return "param index out of range"
+        case .parameterNotBindable(let name):
+            return "parameter '\(name)' is not an affine input of every param computed from it, compile the circuit again to change it"
         case .internalError(let error):
             return error.localizedDescription
         }
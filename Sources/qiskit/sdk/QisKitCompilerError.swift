@@ -21,6 +21,7 @@ import Foundation
 public enum QisKitCompilerError: LocalizedError, CustomStringConvertible {
 
     case unknownFormat(name: String)
+    case unknownMapper(name: String)
     case internalError(error: Error)
 
     public var errorDescription: String? {
@@ -30,6 +31,8 @@ public enum QisKitCompilerError: LocalizedError, CustomStringConvertible {
         switch self {
         case .unknownFormat(let name):
             return "Unrecognized circuit format '\(name)'"
+        case .unknownMapper(let name):
+            return "Unrecognized mapper '\(name)'"
         case .internalError(let error):
             return error.localizedDescription
         }
@@ -0,0 +1,664 @@
+// Copyright 2017 IBM RESEARCH. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+
+import Foundation
+
+/**
+ Typed model of the qobj passed between the compiler, the job processor and
+ the backends. The dictionary form is only produced at the public boundary
+ through the dictionary properties:
+
+     {
+     "id": --job id (string),
+     "config": -- dictionary of config settings (dict)--,
+         {
+         "max_credits" (online only): -- credits (int) --,
+         "shots": -- number of shots (int) --.
+         "backend": -- backend name (str) --
+         }
+     "circuits":
+         [
+             {
+             "name": --circuit name (string)--,
+             "compiled_circuit": --compiled quantum circuit (JSON format)--,
+             "compiled_circuit_qasm": --compiled quantum circuit (QASM format)--,
+             "config": --dictionary of additional config settings (dict)--,
+             },
+             ...
+         ]
+     }
+ */
+struct Qobj {
+
+    var id: String
+    var config: QobjConfig
+    var circuits: [QobjCircuit]
+
+    init(id: String, config: QobjConfig, circuits: [QobjCircuit] = []) {
+        self.id = id
+        self.config = config
+        self.circuits = circuits
+    }
+
+    init(_ dictionary: [String:Any]) {
+        self.id = ""
+        if let id = dictionary["id"] as? String {
+            self.id = id
+        }
+        self.config = QobjConfig([:])
+        if let config = dictionary["config"] as? [String:Any] {
+            self.config = QobjConfig(config)
+        }
+        self.circuits = []
+        if let circuits = dictionary["circuits"] as? [[String:Any]] {
+            self.circuits = circuits.map { QobjCircuit($0) }
+        }
+    }
+
+    var dictionary: [String:Any] {
+        return ["id": self.id,
+                "config": self.config.dictionary,
+                "circuits": self.circuits.map { $0.dictionary }]
+    }
+}
+
+/**
+ Qobj level configuration. Keys other than backend, shots and max_credits
+ (e.g. hpc) are kept as they are.
+ */
+struct QobjConfig {
+
+    var backend: String
+    var shots: Int
+    var max_credits: Int?
+    var extra: [String:Any]
+
+    init(backend: String, shots: Int, max_credits: Int? = nil, extra: [String:Any] = [:]) {
+        self.backend = backend
+        self.shots = shots
+        self.max_credits = max_credits
+        self.extra = extra
+    }
+
+    init(_ dictionary: [String:Any]) {
+        var extra = dictionary
+        self.backend = ""
+        if let backend = extra.removeValue(forKey: "backend") as? String {
+            self.backend = backend
+        }
+        self.shots = 0
+        if let shots = extra.removeValue(forKey: "shots") as? Int {
+            self.shots = shots
+        }
+        self.max_credits = extra.removeValue(forKey: "max_credits") as? Int
+        self.extra = extra
+    }
+
+    var dictionary: [String:Any] {
+        var config = self.extra
+        config["backend"] = self.backend
+        config["shots"] = self.shots
+        if let max_credits = self.max_credits {
+            config["max_credits"] = max_credits
+        }
+        return config
+    }
+}
+
+/**
+ A circuit entry of the qobj. The circuit configuration is backend specific
+ and is kept as a dictionary.
+ */
+struct QobjCircuit {
+
+    var name: String
+    var config: [String:Any]
+    var compiled_circuit: QobjCompiledCircuit?
+    var compiled_circuit_qasm: String?
+    var circuit: DAGCircuit?
+    /**
+     Circuit given in qasm form instead of a DAGCircuit, kept as is.
+     */
+    var circuit_qasm: String?
+
+    init(name: String,
+                config: [String:Any] = [:],
+                compiled_circuit: QobjCompiledCircuit? = nil,
+                compiled_circuit_qasm: String? = nil,
+                circuit: DAGCircuit? = nil) {
+        self.name = name
+        self.config = config
+        self.compiled_circuit = compiled_circuit
+        self.compiled_circuit_qasm = compiled_circuit_qasm
+        self.circuit = circuit
+    }
+
+    init(_ dictionary: [String:Any]) {
+        self.name = ""
+        if let name = dictionary["name"] as? String {
+            self.name = name
+        }
+        self.config = [:]
+        if let config = dictionary["config"] as? [String:Any] {
+            self.config = config
+        }
+        self.compiled_circuit = nil
+        if let compiled_circuit = dictionary["compiled_circuit"] as? [String:Any] {
+            self.compiled_circuit = QobjCompiledCircuit(compiled_circuit)
+        }
+        self.compiled_circuit_qasm = nil
+        if let qasm = dictionary["compiled_circuit_qasm"] as? String {
+            self.compiled_circuit_qasm = qasm
+        }
+        else if let bytes = dictionary["compiled_circuit_qasm"] as? [UInt8] {
+            self.compiled_circuit_qasm = String(bytes: bytes, encoding: .utf8)
+        }
+        self.circuit = dictionary["circuit"] as? DAGCircuit
+        self.circuit_qasm = dictionary["circuit"] as? String
+    }
+
+    /**
+     Simulator seed from the circuit configuration, if any.
+     */
+    var seed: Int? {
+        return self.config["seed"] as? Int
+    }
+
+    var dictionary: [String:Any] {
+        var circuit: [String:Any] = [:]
+        circuit["name"] = self.name
+        circuit["config"] = self.config
+        circuit["compiled_circuit"] = self.compiled_circuit != nil ? self.compiled_circuit!.dictionary : NSNull()
+        circuit["compiled_circuit_qasm"] = self.compiled_circuit_qasm != nil ? self.compiled_circuit_qasm! : NSNull()
+        if let dag = self.circuit {
+            circuit["circuit"] = dag
+        }
+        else if let qasm = self.circuit_qasm {
+            circuit["circuit"] = qasm
+        }
+        return circuit
+    }
+}
+
+/**
+ Compiled circuit in the json format produced by the JsonBackend.
+ */
+struct QobjCompiledCircuit: Codable {
+
+    var header: QobjHeader
+    var operations: [QobjOperation]
+    /**
+     Operation params computed from circuit parameters, nil if the circuit
+     has none.
+     */
+    var parameters: [QobjParameter]?
+    /**
+     Circuit parameters some params were computed from by other than an
+     affine function, nil if none. Those params cannot be bound.
+     */
+    var untracked: [String]?
+
+    init(header: QobjHeader, operations: [QobjOperation], parameters: [QobjParameter]? = nil,
+         untracked: [String]? = nil) {
+        self.header = header
+        self.operations = operations
+        self.parameters = parameters
+        self.untracked = untracked
+    }
+
+    init(_ dictionary: [String:Any]) {
+        self.header = QobjHeader([:])
+        if let header = dictionary["header"] as? [String:Any] {
+            self.header = QobjHeader(header)
+        }
+        self.operations = []
+        if let operations = dictionary["operations"] as? [[String:Any]] {
+            self.operations = operations.map { QobjOperation($0) }
+        }
+        self.parameters = nil
+        if let parameters = dictionary["parameters"] as? [[String:Any]] {
+            self.parameters = parameters.compactMap { QobjParameter($0) }
+        }
+        self.untracked = dictionary["untracked"] as? [String]
+    }
+
+    var dictionary: [String:Any] {
+        var circuit: [String:Any] = ["header": self.header.dictionary,
+                                     "operations": self.operations.map { $0.dictionary }]
+        if let parameters = self.parameters {
+            circuit["parameters"] = parameters.map { $0.dictionary }
+        }
+        if let untracked = self.untracked {
+            circuit["untracked"] = untracked
+        }
+        return circuit
+    }
+
+    /**
+     Set the circuit parameters to values, updating only the operation
+     params that depend on them. Parameters missing from values keep their
+     current value. Throws if values sets an untracked parameter, the
+     circuit having to be compiled again for it.
+     */
+    mutating func bind(_ values: [String:Double]) throws {
+        for name in self.untracked ?? [] where values[name] != nil {
+            throw QISKitError.parameterNotBindable(name: name)
+        }
+        guard let parameters = self.parameters else {
+            return
+        }
+        for parameter in parameters {
+            if let value = values[parameter.name] {
+                self.operations[parameter.operation].params![parameter.param] = parameter.scale * value + parameter.offset
+            }
+        }
+    }
+
+    /**
+     OPENQASM text of the operations, in the form the DAG prints with
+     qeflag set.
+     */
+    func qasm() -> String {
+        var qubits: [String] = []
+        var qregs: [(String,Int)] = []
+        for label in self.header.qubit_labels ?? [] {
+            qubits.append("\(label.name)[\(label.index)]")
+            if let last = qregs.last, last.0 == label.name {
+                qregs[qregs.count - 1].1 = max(last.1, label.index + 1)
+            }
+            else {
+                qregs.append((label.name, label.index + 1))
+            }
+        }
+        var clbits: [String] = []
+        var cregs: [(String,Int,Int)] = []
+        for label in self.header.clbit_labels ?? [] {
+            cregs.append((label.name, label.index, clbits.count))
+            for j in 0..<label.index {
+                clbits.append("\(label.name)[\(j)]")
+            }
+        }
+        var out = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\n"
+        for (name, size) in qregs {
+            out += "qreg \(name)[\(size)];\n"
+        }
+        for (name, size, _) in cregs {
+            out += "creg \(name)[\(size)];\n"
+        }
+        for operation in self.operations {
+            if let conditional = operation.conditional {
+                for (name, size, start) in cregs where conditional.mask == ((1 << size) - 1) << start {
+                    out += "if(\(name)==\(conditional.val)) "
+                    break
+                }
+            }
+            let args = operation.qubits.map { qubits[$0] }
+            switch operation.name {
+            case "measure":
+                out += "measure \(args[0]) -> \(clbits[operation.clbits![0]]);\n"
+            case "barrier":
+                out += "barrier \(args.joined(separator: ","));\n"
+            default:
+                var name = operation.name
+                if let params = operation.params, !params.isEmpty {
+                    name += "(\(params.map { SymbolicValue($0).format(15) }.joined(separator: ",")))"
+                }
+                out += "\(name) \(args.joined(separator: ","));\n"
+            }
+        }
+        return out
+    }
+}
+
+/**
+ Operation param computed from a circuit parameter:
+ operations[operation].params[param] is scale * value + offset for the
+ parameter name set to value.
+ */
+struct QobjParameter: Codable {
+
+    var name: String
+    var operation: Int
+    var param: Int
+    var scale: Double
+    var offset: Double
+
+    init(name: String, operation: Int, param: Int, scale: Double, offset: Double) {
+        self.name = name
+        self.operation = operation
+        self.param = param
+        self.scale = scale
+        self.offset = offset
+    }
+
+    init?(_ dictionary: [String:Any]) {
+        guard let name = dictionary["name"] as? String,
+            let operation = dictionary["operation"] as? Int,
+            let param = dictionary["param"] as? Int,
+            let scale = dictionary["scale"] as? Double,
+            let offset = dictionary["offset"] as? Double else {
+            return nil
+        }
+        self.init(name: name, operation: operation, param: param, scale: scale, offset: offset)
+    }
+
+    var dictionary: [String:Any] {
+        return ["name": self.name,
+                "operation": self.operation,
+                "param": self.param,
+                "scale": self.scale,
+                "offset": self.offset]
+    }
+}
+
+/**
+ Register layout of a compiled circuit. qubit_labels holds (register,index)
+ pairs, clbit_labels holds (register,size) pairs.
+ */
+struct QobjHeader: Codable {
+
+    var number_of_qubits: Int?
+    var qubit_labels: [RegBit]?
+    var number_of_clbits: Int?
+    var clbit_labels: [RegBit]?
+
+    private enum CodingKeys: String, CodingKey {
+        case number_of_qubits
+        case qubit_labels
+        case number_of_clbits
+        case clbit_labels
+    }
+
+    init(qubit_labels: [RegBit]?, clbit_labels: [RegBit]?) {
+        if let labels = qubit_labels {
+            self.number_of_qubits = labels.count
+            self.qubit_labels = labels
+        }
+        if let labels = clbit_labels {
+            self.number_of_clbits = labels.reduce(0) { $0 + $1.index }
+            self.clbit_labels = labels
+        }
+    }
+
+    init(_ dictionary: [String:Any]) {
+        self.number_of_qubits = dictionary["number_of_qubits"] as? Int
+        self.qubit_labels = QobjHeader.labels(dictionary["qubit_labels"])
+        self.number_of_clbits = dictionary["number_of_clbits"] as? Int
+        self.clbit_labels = QobjHeader.labels(dictionary["clbit_labels"])
+    }
+
+    init(from decoder: Decoder) throws {
+        let container = try decoder.container(keyedBy: CodingKeys.self)
+        self.number_of_qubits = try container.decodeIfPresent(Int.self, forKey: .number_of_qubits)
+        self.qubit_labels = try QobjHeader.decodeLabels(container, .qubit_labels)
+        self.number_of_clbits = try container.decodeIfPresent(Int.self, forKey: .number_of_clbits)
+        self.clbit_labels = try QobjHeader.decodeLabels(container, .clbit_labels)
+    }
+
+    func encode(to encoder: Encoder) throws {
+        var container = encoder.container(keyedBy: CodingKeys.self)
+        try container.encodeIfPresent(self.number_of_qubits, forKey: .number_of_qubits)
+        try QobjHeader.encodeLabels(&container, .qubit_labels, self.qubit_labels)
+        try container.encodeIfPresent(self.number_of_clbits, forKey: .number_of_clbits)
+        try QobjHeader.encodeLabels(&container, .clbit_labels, self.clbit_labels)
+    }
+
+    var dictionary: [String:Any] {
+        var header: [String:Any] = [:]
+        if let n = self.number_of_qubits {
+            header["number_of_qubits"] = n
+        }
+        if let labels = self.qubit_labels {
+            header["qubit_labels"] = labels.map { [$0.name,$0.index] }
+        }
+        if let n = self.number_of_clbits {
+            header["number_of_clbits"] = n
+        }
+        if let labels = self.clbit_labels {
+            header["clbit_labels"] = labels.map { [$0.name,$0.index] }
+        }
+        return header
+    }
+
+    private static func labels(_ value: Any?) -> [RegBit]? {
+        guard let list = value as? [[Any]] else {
+            return nil
+        }
+        var labels: [RegBit] = []
+        for label in list {
+            if label.count == 2, let name = label[0] as? String, let index = label[1] as? Int {
+                labels.append(RegBit(name, index))
+            }
+        }
+        return labels
+    }
+
+    private static func decodeLabels(_ container: KeyedDecodingContainer<CodingKeys>, _ key: CodingKeys) throws -> [RegBit]? {
+        if !container.contains(key) {
+            return nil
+        }
+        var list = try container.nestedUnkeyedContainer(forKey: key)
+        var labels: [RegBit] = []
+        while !list.isAtEnd {
+            var label = try list.nestedUnkeyedContainer()
+            let name = try label.decode(String.self)
+            let index = try label.decode(Int.self)
+            labels.append(RegBit(name, index))
+        }
+        return labels
+    }
+
+    private static func encodeLabels(_ container: inout KeyedEncodingContainer<CodingKeys>, _ key: CodingKeys, _ labels: [RegBit]?) throws {
+        guard let labels = labels else {
+            return
+        }
+        var list = container.nestedUnkeyedContainer(forKey: key)
+        for regBit in labels {
+            var label = list.nestedUnkeyedContainer()
+            try label.encode(regBit.name)
+            try label.encode(regBit.index)
+        }
+    }
+}
+
+/**
+ An operation of a compiled circuit.
+ */
+struct QobjOperation: Codable {
+
+    var name: String
+    var params: [Double]?
+    var qubits: [Int]
+    var clbits: [Int]?
+    var conditional: QobjConditional?
+
+    init(_ name: String,
+                params: [Double]? = nil,
+                qubits: [Int],
+                clbits: [Int]? = nil,
+                conditional: QobjConditional? = nil) {
+        self.name = name
+        self.params = params
+        self.qubits = qubits
+        self.clbits = clbits
+        self.conditional = conditional
+    }
+
+    init(_ dictionary: [String:Any]) {
+        self.name = ""
+        if let name = dictionary["name"] as? String {
+            self.name = name
+        }
+        self.params = QobjOperation.doubles(dictionary["params"])
+        self.qubits = QobjOperation.ints(dictionary["qubits"]) ?? []
+        self.clbits = QobjOperation.ints(dictionary["clbits"])
+        self.conditional = nil
+        if let conditional = dictionary["conditional"] as? [String:Any] {
+            self.conditional = QobjConditional(conditional)
+        }
+    }
+
+    var dictionary: [String:Any] {
+        var operation: [String:Any] = [:]
+        operation["name"] = self.name
+        if let params = self.params {
+            operation["params"] = params
+        }
+        operation["qubits"] = self.qubits
+        if let clbits = self.clbits {
+            operation["clbits"] = clbits
+        }
+        if let conditional = self.conditional {
+            operation["conditional"] = conditional.dictionary
+        }
+        return operation
+    }
+
+    /**
+     Numbers are converted one by one: arrays decoded from json may come as
+     [NSNumber] or [Any], which do not cast to [Double] on every platform.
+     */
+    private static func doubles(_ value: Any?) -> [Double]? {
+        guard let list = value as? [Any] else {
+            return nil
+        }
+        var doubles: [Double] = []
+        for element in list {
+            if let d = element as? Double {
+                doubles.append(d)
+            }
+            else if let n = element as? NSNumber {
+                doubles.append(n.doubleValue)
+            }
+            else {
+                return nil
+            }
+        }
+        return doubles
+    }
+
+    private static func ints(_ value: Any?) -> [Int]? {
+        guard let list = value as? [Any] else {
+            return nil
+        }
+        var ints: [Int] = []
+        for element in list {
+            if let i = element as? Int {
+                ints.append(i)
+            }
+            else if let n = element as? NSNumber {
+                ints.append(n.intValue)
+            }
+            else {
+                return nil
+            }
+        }
+        return ints
+    }
+}
+
+/**
+ Classical condition of an operation. mask and val are hexadecimal strings
+ in the dictionary and json forms and are parsed once here.
+ */
+struct QobjConditional: Codable {
+
+    var type: String
+    var mask: Int
+    var val: Int
+
+    private enum CodingKeys: String, CodingKey {
+        case type
+        case mask
+        case val
+    }
+
+    init(mask: Int, val: Int, type: String = "equals") {
+        self.type = type
+        self.mask = mask
+        self.val = val
+    }
+
+    init?(_ dictionary: [String:Any]) {
+        guard let mask = QobjConditional.parseHex(dictionary["mask"] as? String) else {
+            return nil
+        }
+        self.type = "equals"
+        if let type = dictionary["type"] as? String {
+            self.type = type
+        }
+        self.mask = mask
+        self.val = 0
+        if let val = QobjConditional.parseHex(dictionary["val"] as? String) {
+            self.val = val
+        }
+    }
+
+    init(from decoder: Decoder) throws {
+        let container = try decoder.container(keyedBy: CodingKeys.self)
+        self.type = try container.decode(String.self, forKey: .type)
+        let mask = try container.decode(String.self, forKey: .mask)
+        guard let m = QobjConditional.parseHex(mask) else {
+            throw DecodingError.dataCorruptedError(forKey: .mask, in: container, debugDescription: "Invalid hex value \(mask)")
+        }
+        self.mask = m
+        let val = try container.decode(String.self, forKey: .val)
+        guard let v = QobjConditional.parseHex(val) else {
+            throw DecodingError.dataCorruptedError(forKey: .val, in: container, debugDescription: "Invalid hex value \(val)")
+        }
+        self.val = v
+    }
+
+    func encode(to encoder: Encoder) throws {
+        var container = encoder.container(keyedBy: CodingKeys.self)
+        try container.encode(self.type, forKey: .type)
+        try container.encode(String(format: "0x%X", self.mask), forKey: .mask)
+        try container.encode(String(format: "0x%X", self.val), forKey: .val)
+    }
+
+    var dictionary: [String:String] {
+        return ["type": self.type,
+                "mask": String(format: "0x%X", self.mask),
+                "val": String(format: "0x%X", self.val)]
+    }
+
+    /**
+     Returns true if the masked classical register equals val.
+     */
+    func isSatisfied(_ classical_state: Int) -> Bool {
+        var mask = self.mask
+        if mask <= 0 {
+            return true
+        }
+        var value: Int = classical_state & mask
+        while ((mask & 0x1) == 0) {
+            mask >>= 1
+            value >>= 1
+        }
+        return value == self.val
+    }
+
+    private static func parseHex(_ string: String?) -> Int? {
+        guard let s = string else {
+            return nil
+        }
+        let scanner = Scanner(string: s)
+        var n: UInt64 = 0
+        if scanner.scanHexInt64(&n) {
+            return Int(n)
+        }
+        return nil
+    }
+}
@@ -50,6 +50,10 @@ public final class QuantumCircuit: CustomStringConvertible {
      This is a map of registers bound to this circuit, by name.
      */
     private(set) var regs: OrderedDictionary<String,Register> = OrderedDictionary<String,Register>()
+    /**
+     Circuit parameters by name, with their values.
+     */
+    public private(set) var parameters: OrderedDictionary<String,Double> = OrderedDictionary<String,Double>()
 
     /**
      Return number of operations in circuit
@@ -74,8 +78,11 @@ public final class QuantumCircuit: CustomStringConvertible {
 
     public func copy() -> QuantumCircuit {
         let qc = QuantumCircuit(self.header.copy(),self.regs)
+        qc.parameters = self.parameters
         for instruction in self.data {
-            qc.data.append((instruction as! CopyableInstruction).copy(qc))
+            let copy = (instruction as! CopyableInstruction).copy(qc)
+            copy.instructionComponent.symbols = instruction.instructionComponent.symbols
+            qc.data.append(copy)
         }
         return qc
     }
@@ -133,6 +140,10 @@ public final class QuantumCircuit: CustomStringConvertible {
             }
         }
         let circuit = try QuantumCircuit(rhs.regs.values, rhs.header)
+        circuit.parameters = self.parameters
+        for (name, value) in rhs.parameters where circuit.parameters[name] == nil {
+            circuit.parameters[name] = value
+        }
         for instruction in self.data {
             try instruction.reapply(circuit)
         }
@@ -153,6 +164,9 @@ public final class QuantumCircuit: CustomStringConvertible {
                 throw QISKitError.circuitsNotCompatible
             }
         }
+        for (name, value) in rhs.parameters where self.parameters[name] == nil {
+            self.parameters[name] = value
+        }
         for instruction in rhs.data {
             try instruction.reapply(self)
         }
@@ -192,13 +206,43 @@ public final class QuantumCircuit: CustomStringConvertible {
         }
     }
 
+    /**
+     OPENQASM keywords, which cannot name a parameter.
+     */
+    private static let reserved: Set<String> = ["pi", "sin", "cos", "tan", "exp", "ln", "sqrt",
+                                                "qreg", "creg", "gate", "opaque", "measure",
+                                                "reset", "barrier", "if", "include"]
+
+    /**
+     Add the circuit parameter name with value, or set its value if it
+     exists. Params bound to it take the new value when the circuit is
+     compiled.
+     */
+    public func add_parameter(_ name: String, _ value: Double) throws {
+        let wholeRange = name.startIndex..<name.endIndex
+        guard let match = name.range(of: "[a-z][a-zA-Z0-9_]*", options: .regularExpression),
+            wholeRange == match, !QuantumCircuit.reserved.contains(name), self.regs[name] == nil else {
+            throw QISKitError.parameterName(name: name)
+        }
+        self.parameters[name] = value
+    }
+
     public var description: String {
+        return self._qasm(symbolic: false)
+    }
+
+    /**
+     Qasm of the circuit, with symbolic the params bound to circuit
+     parameters printed as the parameter names. That text declares no
+     parameters and is only read by the Unroller given their values.
+     */
+    func _qasm(symbolic: Bool) -> String {
         var text = self.header.value
         for (_,register) in self.regs {
             text.append("\n\(register.description);")
         }
         for instruction in self.data {
-            text.append("\n\(instruction.description);")
+            text.append("\n\(instruction._qasm(symbolic: symbolic));")
         }
         text.append("\n")
         return text
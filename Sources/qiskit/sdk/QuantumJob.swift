@@ -23,16 +23,27 @@ public final class QuantumJob {
     public private(set) var names: [String]
     public let timeout: Int
     public let wait: Int
+    /**
+     Jobs of higher priority start first, from resources["priority"].
+     */
+    public let priority: Int
     public var qobj: [String:Any] {
-        return self._qobj
+        return self._qobj.dictionary
     }
-    var _qobj: [String:Any] = [:]
+    var _qobj: Qobj
     public private(set) var backend: String = ""
     public private(set) var resources: [String:Any] = [:]
     public let seed: Int?
     public private(set) var result: Result? = nil
 
-    init(_ qobj: [String:Any],
+    convenience init(_ qobj: [String:Any],
+                     seed: Int? = nil,
+                     resources: [String:Any] = ["max_credits":10, "wait":5, "timeout":120],
+                     names: [String]? = nil) {
+        self.init(Qobj(qobj), seed: seed, resources: resources, names: names)
+    }
+
+    init(_ qobj: Qobj,
          seed: Int? = nil,
          resources: [String:Any] = ["max_credits":10, "wait":5, "timeout":120],
          names: [String]? = nil) {
@@ -55,13 +66,10 @@ public final class QuantumJob {
         else {
             self.wait = 5
         }
+        self.priority = resources["priority"] as? Int ?? 0
         self._qobj = qobj
         self.seed = seed
-        if let config = self.qobj["config"] as? [String:Any] {
-            if let backend = config["backend"] as? String {
-                self.backend = backend
-            }
-        }
+        self.backend = self._qobj.config.backend
         self.resources = resources
     }
 
@@ -96,43 +104,23 @@ public final class QuantumJob {
         else {
             self.wait = 5
         }
+        self.priority = resources["priority"] as? Int ?? 0
         self.seed = seed
-        self._qobj = try self._create_qobj(circuits, circuit_config, backend, self.seed, shots, do_compile,backendUtils)
-        if let config = self.qobj["config"] as? [String:Any] {
-            if let backend = config["backend"] as? String {
-                self.backend = backend
-            }
-        }
         self.resources = resources
+        self._qobj = try QuantumJob._create_qobj(circuits, circuit_config, backend, self.seed, shots,
+                                                 self.names, resources, do_compile, backendUtils)
+        self.backend = self._qobj.config.backend
     }
 
-    private func _create_qobj(_ circuits: [DAGCircuit],
-                              _ circuit_conf: [[String:Any]]?,
-                              _ backend: String,
-                              _ seed: Int?,
-                              _ shots: Int,
-                              _ do_compile: Bool,
-                              _ backendUtils: BackendUtils) throws -> [String:Any] {
-        // local and remote backends currently need different
-        // compilied circuit formats
-        var formatted_circuits: [Any] = []
-        if do_compile {
-            for _ in circuits {
-                formatted_circuits.append(NSNull())
-            }
-        }
-        else {
-            if backendUtils.local_backends().contains(backend) {
-                for circuit in circuits {
-                    formatted_circuits.append(try OpenQuantumCompiler.dag2json(circuit))
-                }
-            }
-            else {
-                for circuit in circuits {
-                    formatted_circuits.append(try circuit.qasm(qeflag: true))
-                }
-            }
-        }
+    private static func _create_qobj(_ circuits: [DAGCircuit],
+                                     _ circuit_conf: [[String:Any]]?,
+                                     _ backend: String,
+                                     _ seed: Int?,
+                                     _ shots: Int,
+                                     _ names: [String],
+                                     _ resources: [String:Any],
+                                     _ do_compile: Bool,
+                                     _ backendUtils: BackendUtils) throws -> Qobj {
         // create circuit component of qobj
         var circuit_config: [[String:Any]] = []
         if let c = circuit_conf {
@@ -145,23 +133,26 @@ public final class QuantumJob {
                                         "seed": seed != nil ? seed! : NSNull()]
             circuit_config = [[String:Any]](repeating: config, count: circuits.count)
         }
-        var circuit_records: [[String:Any]] = []
-        for ((circuit, fcircuit), (name, config)) in zip(zip(circuits,formatted_circuits),zip(self.names,circuit_config)) {
-            let record: [String:Any] = [
-                "name": name,
-                "compiled_circuit": do_compile ? NSNull() : fcircuit,
-                "compiled_circuit_qasm": do_compile ? NSNull() : fcircuit,
-                "circuit": circuit,
-                "config": config
-            ]
+        // local and remote backends currently need different
+        // compilied circuit formats
+        let local = backendUtils.local_backends().contains(backend)
+        var circuit_records: [QobjCircuit] = []
+        for (circuit, (name, config)) in zip(circuits,zip(names,circuit_config)) {
+            var record = QobjCircuit(name: name, config: config, circuit: circuit)
+            if !do_compile {
+                if local {
+                    record.compiled_circuit = try OpenQuantumCompiler.dag2qobj(circuit)
+                }
+                else {
+                    record.compiled_circuit_qasm = try circuit.qasm(qeflag: true)
+                }
+            }
             circuit_records.append(record)
         }
-        return ["id": String.randomAlphanumeric(length: 10),
-                "config": [
-                    "max_credits": resources["max_credits"],
-                    "shots": shots,
-                    "backend": backend
-                ],
-                "circuits": circuit_records]
+        return Qobj(id: String.randomAlphanumeric(length: 10),
+                    config: QobjConfig(backend: backend,
+                                       shots: shots,
+                                       max_credits: resources["max_credits"] as? Int),
+                    circuits: circuit_records)
     }
 }
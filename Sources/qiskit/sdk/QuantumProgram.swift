@@ -64,19 +64,58 @@ public final class QuantumProgram: CustomStringConvertible {
         let jobProcessor: JobProcessor
         let callbackSingle: ((_:Result) -> Void)?
         let callbackMultiple: ((_:[Result]) -> Void)?
+        let executor: CompletionExecutor
 
         init(_ jobProcessor: JobProcessor,
             _ callbackSingle: ((_:Result) -> Void)?,
-            _ callbackMultiple: ((_:[Result]) -> Void)?) {
+            _ callbackMultiple: ((_:[Result]) -> Void)?,
+            _ executor: CompletionExecutor) {
             self.jobProcessor = jobProcessor
             self.callbackSingle = callbackSingle
             self.callbackMultiple = callbackMultiple
+            self.executor = executor
         }
     }
 
     private let lock = NSRecursiveLock()
     private var jobProcessors: [String: JobProcessorData] = [:]
 
+    /**
+     Executor of the run and execute callbacks, CompletionExecutor.shared
+     unless set.
+     */
+    public var completion_executor: CompletionExecutor {
+        get {
+            self.lock.lock()
+            defer { self.lock.unlock() }
+            return self._completion_executor ?? CompletionExecutor.shared
+        }
+        set {
+            self.lock.lock()
+            defer { self.lock.unlock() }
+            self._completion_executor = newValue
+        }
+    }
+    private var _completion_executor: CompletionExecutor? = nil
+
+    /**
+     Cache of the compiled circuits, nil not to cache them. Circuits with
+     parameters are always compiled.
+     */
+    public var compile_cache: CompileCache? {
+        get {
+            self.lock.lock()
+            defer { self.lock.unlock() }
+            return self._compile_cache
+        }
+        set {
+            self.lock.lock()
+            defer { self.lock.unlock() }
+            self._compile_cache = newValue
+        }
+    }
+    private var _compile_cache: CompileCache? = nil
+
     /**
      only exists once you set the api to use the online backends
      */
@@ -677,7 +716,7 @@ public final class QuantumProgram: CustomStringConvertible {
                 responseHandler(error)
             }
         }
-        DispatchQueue.main.async {
+        self.completion_executor.execute {
             responseHandler(IBMQuantumExperienceError.invalidCredentials)
         }
         return RequestTask()
@@ -1147,14 +1186,43 @@ public final class QuantumProgram: CustomStringConvertible {
                         qobj_id: String? = nil,
                         hpc: [String:Any]? = nil,
                         _ responseHandler: @escaping ((_:[String:Any], _:QISKitError?) -> Void)) -> RequestTask {
+        return self._compile(name_of_circuits,
+                             backend: backend,
+                             config: config,
+                             basis_gates: basis_gates,
+                             coupling_map: coupling_map,
+                             initial_layout: initial_layout,
+                             shots: shots,
+                             max_credits: max_credits,
+                             seed: seed,
+                             qobj_id: qobj_id,
+                             hpc: hpc) { (qobj,error) in
+            responseHandler(qobj != nil ? qobj!.dictionary : [:],error)
+        }
+    }
+
+    /**
+     Compile the circuits into a typed qobj, nil if it could not be started.
+     See compile.
+     */
+    private func _compile(_ name_of_circuits: [String],
+                          backend: String,
+                          config: [String:Any]?,
+                          basis_gates: String?,
+                          coupling_map: [Int:[Int]]?,
+                          initial_layout: OrderedDictionary<RegBit,RegBit>?,
+                          shots: Int,
+                          max_credits: Int,
+                          seed: Int?,
+                          qobj_id: String?,
+                          hpc: [String:Any]?,
+                          _ responseHandler: @escaping ((_:Qobj?, _:QISKitError?) -> Void)) -> RequestTask {
         // TODO: Jay: currently basis_gates, coupling_map, initial_layout, shots,
         // max_credits and seed are extra inputs but I would like them to go
         // into the config.
 
-        var qobj: [String:Any] = [:]
         let qobjId: String = (qobj_id != nil) ? qobj_id! : String.randomAlphanumeric(length: 30)
-        qobj["id"] = qobjId
-        qobj["config"] = ["max_credits": max_credits, "backend": backend, "shots": shots]
+        var qobj = Qobj(id: qobjId, config: QobjConfig(backend: backend, shots: shots, max_credits: max_credits))
 
         // TODO This backend needs HPC parameters to be passed in order to work
         if backend == "ibmqx_hpc_qasm_simulator" {
@@ -1170,15 +1238,12 @@ public final class QuantumProgram: CustomStringConvertible {
             }
             let m = h.keys.filter() { $0 != "multi_shot_optimization" && $0 != "omp_num_threads" }
             if !m.isEmpty {
-                DispatchQueue.main.async {
-                    responseHandler([:],QISKitError.unknownHPC)
+                self.completion_executor.execute {
+                    responseHandler(nil,QISKitError.unknownHPC)
                 }
                 return RequestTask()
             }
-            if var config = qobj["config"] as? [String:Any] {
-                config["hpc"] = h
-                qobj["config"] = config
-            }
+            qobj.config.extra["hpc"] = h
         }
         else if hpc != nil {
             SDKLogger.logInfo("HPC paramter is only available for " +
@@ -1187,10 +1252,9 @@ public final class QuantumProgram: CustomStringConvertible {
                         "ignore it.")
         }
 
-        qobj["circuits"] = []
         let r = self.backendUtils.get_backend_configuration(backend) { (backend_conf,error) in
             if error != nil {
-                responseHandler([:],QISKitError.internalError(error: error!))
+                responseHandler(nil,QISKitError.internalError(error: error!))
                 return
             }
             do {
@@ -1236,14 +1300,19 @@ public final class QuantumProgram: CustomStringConvertible {
                     if num_qubits == 1 {
                         cm = nil
                     }
-                    let compiledCircuit = try OpenQuantumCompiler.compile(qCircuit.qasm(),
+                    var parameters: [String:Double] = [:]
+                    for (name, value) in qCircuit.parameters {
+                        parameters[name] = value
+                    }
+                    let compiledCircuit = try OpenQuantumCompiler.compile(qCircuit._qasm(symbolic: true),
                                                                                   basis_gates: basis,
                                                                                   coupling_map: cm,
                                                                                   initial_layout: initial_layout,
-                                                                                  get_layout: true)
+                                                                                  get_layout: true,
+                                                                                  parameters: parameters,
+                                                                                  cache: self.compile_cache)
                     // making the job to be added to qoj
-                    var job: [String:Any] = [:]
-                    job["name"] = name
+                    var job = QobjCircuit(name: name)
                     // config parameters used by the runner
                     var conf: [String:Any] = config != nil ? config! : [:]
                     conf["coupling_map"] = cm != nil ? Coupling.coupling_dict2list(cm!) : NSNull()
@@ -1264,15 +1333,13 @@ public final class QuantumProgram: CustomStringConvertible {
                     conf["basis_gates"] = basis
                     conf["seed"] = seed != nil ? seed! : NSNull()
 
-                    job["config"] = conf
+                    job.config = conf
 
                     // the compuled circuit to be run saved as a dag
-                    job["compiled_circuit"] = try OpenQuantumCompiler.dag2json(compiledCircuit.dag!,basis_gates: basis)
-                    job["compiled_circuit_qasm"] = try compiledCircuit.dag!.qasm(qeflag:true)
+                    job.compiled_circuit = try OpenQuantumCompiler.dag2qobj(compiledCircuit.dag!,basis_gates: basis)
+                    job.compiled_circuit_qasm = try compiledCircuit.dag!.qasm(qeflag:true)
                     // add job to the qobj
-                    var circuits = qobj["circuits"] as! [Any]
-                    circuits.append(job)
-                    qobj["circuits"] = circuits
+                    qobj.circuits.append(job)
                 }
                 responseHandler(qobj,nil)
             } catch let error as QISKitError {
@@ -1345,6 +1412,38 @@ public final class QuantumProgram: CustomStringConvertible {
         return newQobj
     }
 
+    /**
+     Bind the circuit parameters of a compiled qobj to new values without
+     compiling it again. Only the operation params computed from the
+     parameters are updated, and the compiled qasm of those circuits is
+     printed again from the bound operations.
+
+     Args:
+         qobj (dict): already compiled qobj
+         values (dict): new values of the circuit parameters, by name.
+            Parameters left out keep their value.
+
+     Returns:
+        qobj: bound qobj
+     Throws parameterNotBindable if a param computed from one of the
+     parameters other than by an affine function would keep its old value.
+     */
+    public func bind_parameters(_ qobj: [String:Any], _ values: [String:Double]) throws -> [String:Any] {
+        var bound = Qobj(qobj)
+        for i in 0..<bound.circuits.count {
+            guard var compiled_circuit = bound.circuits[i].compiled_circuit,
+                compiled_circuit.parameters != nil || compiled_circuit.untracked != nil else {
+                continue
+            }
+            try compiled_circuit.bind(values)
+            bound.circuits[i].compiled_circuit = compiled_circuit
+            if bound.circuits[i].compiled_circuit_qasm != nil {
+                bound.circuits[i].compiled_circuit_qasm = compiled_circuit.qasm()
+            }
+        }
+        return bound.dictionary
+    }
+
     /**
      Print the compiled circuits that are ready to run.
      */
@@ -1437,6 +1536,8 @@ public final class QuantumProgram: CustomStringConvertible {
      run or list of qobj.
      wait (int): Time interval to wait between requests for results
      timeout (int): Total time to wait until the execution stops
+     priority (int): jobs of higher priority are started first by
+     JobScheduler.shared
      callback (fn(result)): A function with signature:
      fn(result):
      The result param will be a Result object.
@@ -1445,10 +1546,13 @@ public final class QuantumProgram: CustomStringConvertible {
     public func run_async(_ qobj: [String:Any],
                           wait: Int = 5,
                           timeout: Int = 60,
+                          priority: Int = 0,
                           _ callback:  @escaping ((_:Result) -> Void)) -> RequestTask {
-        return self._run_internal([qobj],
+        return self._run_internal([Qobj(qobj)],
                            wait: wait,
                            timeout: timeout,
+                           priority: priority,
+                           executor: self.completion_executor,
                            callbackSingle: callback)
     }
 
@@ -1463,6 +1567,8 @@ public final class QuantumProgram: CustomStringConvertible {
      qobj_list (list(dict)): The list of quantum objects to run.
      wait (int): Time interval to wait between requests for results
      timeout (int): Total time to wait until the execution stops
+     priority (int): jobs of higher priority are started first by
+     JobScheduler.shared
      callback (fn(results)): A function with signature:
      fn(results):
      The results param will be a list of Result objects, one
@@ -1472,32 +1578,33 @@ public final class QuantumProgram: CustomStringConvertible {
     public func run_batch_async(_ qobj_list: [[String:Any]],
                                 wait: Int = 5,
                                 timeout: Int = 120,
+                                priority: Int = 0,
                                 _ callback: ((_:[Result]) -> Void)?) -> RequestTask {
-        return self._run_internal(qobj_list,
+        return self._run_internal(qobj_list.map { Qobj($0) },
                            wait: wait,
                            timeout: timeout,
+                           priority: priority,
+                           executor: self.completion_executor,
                            callbackMultiple: callback)
     }
 
-    private func _run_internal(_ qobj_list: [[String:Any]],
+    private func _run_internal(_ qobj_list: [Qobj],
                                wait: Int,
                                timeout: Int,
+                               priority: Int,
+                               executor: CompletionExecutor,
                                callbackSingle: ((_:Result) -> Void)? = nil,
                                callbackMultiple: ((_:[Result]) -> Void)? = nil) -> RequestTask {
         var q_job_list: [QuantumJob] = []
         for qobj in qobj_list {
-            var max_credits = 0
-            if let config = qobj["config"] as? [String:Any] {
-                if let m = config["max_credits"] as? Int {
-                    max_credits = m
-                }
-            }
-            q_job_list.append(QuantumJob(qobj, resources: [ "max_credits": max_credits, "wait": wait, "timeout":timeout]))
+            q_job_list.append(QuantumJob(qobj, resources: [ "max_credits": qobj.config.max_credits ?? 0, "wait": wait, "timeout":timeout,
+                                                            "priority": priority]))
         }
         let job_processor = JobProcessor(self.backendUtils,q_job_list,self._jobs_done_callback)
         let data = JobProcessorData(job_processor,
                                     callbackSingle,
-                                    callbackMultiple)
+                                    callbackMultiple,
+                                    executor)
         self.lock.lock()
         self.jobProcessors[data.jobProcessor.identifier] = data
         self.lock.unlock()
@@ -1517,7 +1624,7 @@ public final class QuantumProgram: CustomStringConvertible {
         let data = self.jobProcessors.removeValue(forKey:identifier)
         self.lock.unlock()
         if data != nil {
-            DispatchQueue.main.async {
+            data!.executor.execute {
                 if data!.callbackSingle != nil {
                     data!.callbackSingle?(jobs_results[0])
                 }
@@ -1594,8 +1701,88 @@ public final class QuantumProgram: CustomStringConvertible {
                         seed: Int? = nil,
                         hpc: [String:Any]? = nil,
                         _ callback: @escaping ((_:Result) -> Void)) -> RequestTask {
+        return self._execute(name_of_circuits,
+                             backend: backend,
+                             config: config,
+                             wait: wait,
+                             timeout: timeout,
+                             basis_gates: basis_gates,
+                             coupling_map: coupling_map,
+                             initial_layout: initial_layout,
+                             shots: shots,
+                             max_credits: max_credits,
+                             seed: seed,
+                             hpc: hpc,
+                             executor: self.completion_executor,
+                             callback)
+    }
+
+    /**
+     Blocking form of execute: compiles and runs the circuits, waiting for
+     the result on the calling thread.
+
+     The callbacks the SDK waits for internally are delivered by
+     CompletionExecutor.shared and completion_executor, so this cannot be
+     called from the main thread while either of them is the main queue.
+
+     Args: see execute
+     Returns:
+        the Result of the execution
+     */
+    public func execute_and_wait(_ name_of_circuits: [String],
+                                 backend: String = "local_qasm_simulator",
+                                 config: [String:Any]? = nil,
+                                 wait: Int = 5,
+                                 timeout: Int = 60,
+                                 basis_gates: String? = nil,
+                                 coupling_map: [Int:[Int]]? = nil,
+                                 initial_layout: OrderedDictionary<RegBit,RegBit>? = nil,
+                                 shots: Int = 1024,
+                                 max_credits: Int = 3,
+                                 seed: Int? = nil,
+                                 hpc: [String:Any]? = nil) throws -> Result {
+        if Thread.isMainThread && (CompletionExecutor.shared.isMain || self.completion_executor.isMain) {
+            throw QISKitError.blockingMainQueue
+        }
+        let semaphore = DispatchSemaphore(value: 0)
+        var result: Result? = nil
+        self._execute(name_of_circuits,
+                      backend: backend,
+                      config: config,
+                      wait: wait,
+                      timeout: timeout,
+                      basis_gates: basis_gates,
+                      coupling_map: coupling_map,
+                      initial_layout: initial_layout,
+                      shots: shots,
+                      max_credits: max_credits,
+                      seed: seed,
+                      hpc: hpc,
+                      executor: CompletionExecutor.synchronous) { (r) in
+            result = r
+            semaphore.signal()
+        }
+        semaphore.wait()
+        return result!
+    }
+
+    @discardableResult
+    private func _execute(_ name_of_circuits: [String],
+                          backend: String,
+                          config: [String:Any]?,
+                          wait: Int,
+                          timeout: Int,
+                          basis_gates: String?,
+                          coupling_map: [Int:[Int]]?,
+                          initial_layout: OrderedDictionary<RegBit,RegBit>?,
+                          shots: Int,
+                          max_credits: Int,
+                          seed: Int?,
+                          hpc: [String:Any]?,
+                          executor: CompletionExecutor,
+                          _ callback: @escaping ((_:Result) -> Void)) -> RequestTask {
         let reqTask = RequestTask()
-        let r = self.compile(name_of_circuits,
+        let r = self._compile(name_of_circuits,
                          backend: backend,
                          config: config,
                          basis_gates: basis_gates,
@@ -1604,15 +1791,20 @@ public final class QuantumProgram: CustomStringConvertible {
                          shots: shots,
                          max_credits: max_credits,
                          seed: seed,
+                         qobj_id: nil,
                          hpc: hpc) { (qobj,error) in
             if error != nil {
-                callback(Result("0",error!,[:]))
+                executor.execute {
+                    callback(Result("0",error!,[:]))
+                }
                 return
             }
-            let r = self.run_async(qobj,
-                                   wait: wait,
-                                   timeout: timeout,
-                                   callback)
+            let r = self._run_internal([qobj!],
+                                       wait: wait,
+                                       timeout: timeout,
+                                       priority: 0,
+                                       executor: executor,
+                                       callbackSingle: callback)
             reqTask.add(r)
         }
         reqTask.add(r)
@@ -45,19 +45,40 @@ import Foundation
  */
 public struct Result: CustomStringConvertible {
 
-    var _qobj: [String:Any] = [:]
-    var _result: [String:Any] = [:]
+    var _store: ResultStore
+
+    /**
+     The qobj, built from the store on each access.
+     */
+    var _qobj: [String:Any] {
+        get {
+            return self._store.qobj
+        }
+        set {
+            self._store.set_qobj(newValue)
+        }
+    }
+
+    /**
+     The result, built from the store on each access.
+     */
+    var _result: [String:Any] {
+        get {
+            return self._store.result
+        }
+        set {
+            self._store.set_result(newValue)
+        }
+    }
 
     init(_ qobj_result: [String:Any], _ qobj: [String:Any]) {
-        self._qobj = qobj
-        self._result = qobj_result
+        self._store = ResultStore(qobj, qobj_result)
     }
 
     init(_ jobId: String, _ error: Error, _ qobj: [String:Any]) {
-        self._qobj = qobj
-        self._result = ["job_id": jobId,
-                         "status": "ERROR",
-                         "result": error]
+        self._store = ResultStore(qobj, ["job_id": jobId,
+                                         "status": "ERROR",
+                                         "result": error])
     }
 
     /**
@@ -70,19 +91,14 @@ public struct Result: CustomStringConvertible {
     }
 
     public subscript(index: Int) -> [String:Any]? {
-        if let results = self._result["result"] as? [[String:Any]] {
-            if index < results.count {
-                return results[index]
-            }
+        if index >= 0 && index < self._store.count {
+            return self._store.row(index)
         }
         return [:]
     }
 
     public var count: Int {
-        if let results = self._result["result"] as? [[String:Any]] {
-            return results.count
-        }
-        return 0
+        return self._store.count
     }
 
     /**
@@ -93,8 +109,8 @@ public struct Result: CustomStringConvertible {
         The current object with appended results.
      */
     public mutating func append(_ right: Result) throws {
-        if let leftConfig = self._qobj["config"] as? [String:AnyHashable],
-            let rightConfig = right._qobj["config"] as? [String:AnyHashable] {
+        if let leftConfig = self._store.qobj_fields["config"] as? [String:AnyHashable],
+            let rightConfig = right._store.qobj_fields["config"] as? [String:AnyHashable] {
             // comparison di=one this way due to Linux limitations
             if leftConfig.count != rightConfig.count {
                 throw QISKitError.invalidResultsCombine
@@ -107,36 +123,20 @@ public struct Result: CustomStringConvertible {
                     throw QISKitError.invalidResultsCombine
                 }
             }
-            if let leftId = self._qobj["id"] as? String {
-                self._qobj["id"] = [leftId]
+            if let leftId = self._store.qobj_fields["id"] as? String {
+                self._store.set_qobj_field("id", [leftId])
             }
-            if var leftIds = self._qobj["id"] as? [String] {
-                if let rightId = right._qobj["id"] as? String {
+            if var leftIds = self._store.qobj_fields["id"] as? [String] {
+                if let rightId = right._store.qobj_fields["id"] as? String {
                     leftIds.append(rightId)
                 }
-                else if let rightIds = right._qobj["id"] as? [String] {
+                else if let rightIds = right._store.qobj_fields["id"] as? [String] {
                     leftIds.append(contentsOf:rightIds)
                 }
-                self._qobj["id"] = leftIds
-            }
-            if let rightCircuits = right._qobj["circuits"] as? [Any] {
-                if var leftCircuits = self._qobj["circuits"] as? [Any] {
-                    leftCircuits.append(contentsOf: rightCircuits)
-                    self._qobj["circuits"] = leftCircuits
-                }
-                else {
-                    self._qobj["circuits"] = rightCircuits
-                }
-            }
-            if let rightResults = right._result["result"] as? [Any] {
-                if var leftResults = self._result["result"] as? [Any] {
-                    leftResults.append(contentsOf: rightResults)
-                    self._result["result"] = leftResults
-                }
-                else {
-                    self._result["result"] = rightResults
-                }
+                self._store.set_qobj_field("id", leftIds)
             }
+            // Circuits and results are appended to the columns in place
+            self._store.append(right._store)
             return
         }
         throw QISKitError.invalidResultsCombine
@@ -152,13 +152,13 @@ public struct Result: CustomStringConvertible {
         A new Result object consisting of combined objects.
      */
     public static func add(left: Result, right: Result) throws -> Result {
-        var ret =  Result(left._result, left._qobj)
+        var ret = left
         try ret.append(right)
         return ret
     }
 
     public func is_error() -> Bool {
-        if let status = self._result["status"] as? String {
+        if let status = self._store.result_fields["status"] as? String {
             return status == "ERROR"
         }
         return false
@@ -170,7 +170,7 @@ public struct Result: CustomStringConvertible {
      the status of the results.
      */
     public func get_status() -> String? {
-        guard let status = self._result["status"] as? String else {
+        guard let status = self._store.result_fields["status"] as? String else {
             return nil
         }
         return status
@@ -184,11 +184,9 @@ public struct Result: CustomStringConvertible {
      */
     public func circuit_statuses() -> [String] {
         var ret: [String] = []
-        if let results = self._result["result"] as? [[String:Any]] {
-            for result in results {
-                if let status = result["status"] as? String {
-                    ret.append(status)
-                }
+        for index in 0..<self._store.count {
+            if let status = self._store.status(index) {
+                ret.append(status)
             }
         }
         return ret
@@ -201,12 +199,8 @@ public struct Result: CustomStringConvertible {
      icircuit (int): index of circuit
      */
     public func get_circuit_status(icircuit: Int) -> String? {
-        if let results = self._result["result"] as? [[String:Any]] {
-            if !results.isEmpty && icircuit >= 0 && icircuit < results.count {
-                if let status = results[icircuit]["status"] as? String {
-                    return status
-                }
-            }
+        if icircuit >= 0 && icircuit < self._store.count {
+            return self._store.status(icircuit)
         }
         return nil
     }
@@ -218,17 +212,14 @@ public struct Result: CustomStringConvertible {
      a string containing the job id.
      */
     public func get_job_id() -> String {
-        if let job_id = self._result["job_id"] as? String {
+        if let job_id = self._store.result_fields["job_id"] as? String {
             return job_id
         }
         return ""
     }
 
     public func get_error() -> Error? {
-        if let result = self._result["result"] as? Error {
-            return result
-        }
-        return nil
+        return self._store.error
     }
 
     /**
@@ -239,15 +230,10 @@ public struct Result: CustomStringConvertible {
      A text version of the qasm file that has been run
      */
     public func get_ran_qasm(_ name: String) throws -> String {
-        let qobj = self._qobj
-        if let circuits = qobj["circuits"] as? [[String:Any]] {
-            for circuit in circuits {
-                if let n = circuit["name"] as? String {
-                    if n == name {
-                        if let ret = circuit["compiled_circuit_qasm"] as? String {
-                            return ret
-                        }
-                    }
+        if let circuits = self._store.circuits {
+            for (index, n) in self._store.names.enumerated() where n == name {
+                if let ret = circuits[index]["compiled_circuit_qasm"] as? String {
+                    return ret
                 }
             }
         }
@@ -273,6 +259,8 @@ public struct Result: CustomStringConvertible {
      [ XX + XXj
      ...
      XX + XXj]]
+     When the job asked for memory mapped outputs, 'quantum_state' and
+     'unitary' are the ComplexBuffer the simulator wrote, not copies.
      Args:
      name (str): the name of the quantum circuit.
      Returns:
@@ -282,18 +270,9 @@ public struct Result: CustomStringConvertible {
         if let error = self.get_error() {
             throw error
         }
-        let qobj = self._qobj
-        if let circuits = qobj["circuits"] as? [[String:Any]], 
-            let results = self._result["result"] as? [[String:Any]] {
-            for (index, circuit) in circuits.enumerated() {
-                if let n = circuit["name"] as? String {
-                    if n == name {
-                        if let data = results[index]["data"] as? [String:Any] {
-                            return data
-                        }
-                    }
-                }
-            }
+        if let index = self._store.index(name),
+            let data = self._store.data(index) {
+            return data
         }
         throw QISKitError.noData(name: name)
     }
@@ -309,12 +288,29 @@ public struct Result: CustomStringConvertible {
      A dictionary of counts {’00000’: XXXX, ’00001’: XXXXX}.
      */
     public func get_counts(_ name: String) throws -> [String:Int] {
+        if let histogram = try self.get_count_histogram(name) {
+            return histogram.dictionary
+        }
         if let counts = try self.get_data(name)["counts"] as? [String:Int] {
             return counts
         }
         throw QISKitError.noCounts(name: name)
     }
 
+    /**
+     The counts of circuit name as an integer histogram, nil if they could
+     not be parsed into one.
+     */
+    func get_count_histogram(_ name: String) throws -> CountHistogram? {
+        if let error = self.get_error() {
+            throw error
+        }
+        guard let index = self._store.index(name) else {
+            throw QISKitError.noData(name: name)
+        }
+        return self._store.row_counts[index]
+    }
+
     /**
      Get the circuit names of the results.
 
@@ -323,11 +319,9 @@ public struct Result: CustomStringConvertible {
      */
     public func get_names() -> [String] {
         var names: [String] = []
-        if let circuits = self._qobj["circuits"] as? [[String:Any]] {
-            for circuit in circuits {
-                if let name = circuit["name"] as? String {
-                    names.append(name)
-                }
+        for name in self._store.names {
+            if let n = name {
+                names.append(n)
             }
         }
         return names
@@ -360,6 +354,42 @@ public struct Result: CustomStringConvertible {
         return temp
     }
 
+    /**
+     Compute the mean values of several Z strings on the counts of a
+     circuit, in one pass over the counts.
+
+     Args:
+     name (str): the name of the quantum circuit
+     masks: one mask per Z string, bit i set if the string has a Z on the
+     i-th classical bit from the right of the outcome (register spaces
+     aside)
+     Returns:
+     for each mask, the mean of +1 on outcomes with an even number of the
+     masked bits set and -1 on the others
+     */
+    public func average_z_parities(_ name: String, _ masks: [Int]) throws -> [Double] {
+        if let histogram = try self.get_count_histogram(name) {
+            return histogram.z_parities(masks)
+        }
+        let counts = try self.get_counts(name)
+        var tot: Double = 0
+        for (_,countValue) in counts {
+            tot += Double(countValue)
+        }
+        var temp = [Double](repeating: 0.0, count: masks.count)
+        for (key,countValue) in counts {
+            let bits = Array(key.replacingOccurrences(of: " ", with: "").reversed())
+            for (i, mask) in masks.enumerated() {
+                var value: Double = 1.0
+                for (j, bit) in bits.enumerated() where bit == "1" && j < Int.bitWidth && (mask >> j) & 1 == 1 {
+                    value = -value
+                }
+                temp[i] += value * Double(countValue) / tot
+            }
+        }
+        return temp
+    }
+
     /**
      Compute the polarization of each qubit for all circuits and pull out each circuits
      xval into an array. Assumes that each circuit has the same number of qubits and that
@@ -374,7 +404,7 @@ public struct Result: CustomStringConvertible {
      xvals: mx1 array of the circuit xvals
      */
     public func get_qubitpol_vs_xval(xvals_dict: [String:Double]? = nil) throws -> ([[Double]],[Double]) {
-        guard let circuits = self._qobj["circuits"] as? [[String:Any]] else {
+        guard let circuits = self._store.circuits else {
             return ([],[])
         }
         if circuits.isEmpty {
@@ -394,6 +424,32 @@ public struct Result: CustomStringConvertible {
         var qubitpol: [[Double]] = [[Double]](repeating: [Double](repeating: 0.0, count: nqubits), count: ncircuits)
         var xvals: [Double] = [Double](repeating: 0.0, count: ncircuits)
 
+        // Counts held as a single register of nqubits bits give every
+        // polarization in one pass over the histogram
+        var pending: [Int] = []
+        let masks = (0..<nqubits).map { 1 << $0 }
+        for circuit_ind in 0..<ncircuits {
+            guard let name = circuits[circuit_ind]["name"] as? String else {
+                continue
+            }
+            if let dict = xvals_dict,
+                let val = dict[name] {
+                xvals[circuit_ind] = val
+            }
+            if nqubits < Int.bitWidth - 1,
+                let histogram = try self.get_count_histogram(name),
+                histogram.register_sizes == [nqubits] {
+                // Z parity is +1 on 0 while the polarization is +1 on 1
+                qubitpol[circuit_ind] = histogram.z_parities(masks).map { -$0 }
+            }
+            else {
+                pending.append(circuit_ind)
+            }
+        }
+        if pending.isEmpty {
+            return (qubitpol,xvals)
+        }
+
         //build Z operators for each qubit
         var z_dicts:[[String:Int]] = []
         for qubit_ind in 0..<nqubits {
@@ -409,12 +465,8 @@ public struct Result: CustomStringConvertible {
             }
         }
         //go through each circuit and for eqch qubit and apply the operators using "average_data"
-        for circuit_ind in 0..<ncircuits {
+        for circuit_ind in pending {
             if let name = circuits[circuit_ind]["name"] as? String {
-                if let dict = xvals_dict,
-                    let val = dict[name] {
-                    xvals[circuit_ind] = val
-                }
                 for qubit_ind in 0..<nqubits {
                     qubitpol[circuit_ind][qubit_ind] = try self.average_data(name, z_dicts[qubit_ind])
                 }
@@ -0,0 +1,386 @@
+// Copyright 2017 IBM RESEARCH. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+
+import Foundation
+
+/**
+ Counts of one circuit, with the outcomes held as integers.
+
+ Bit strings such as '01 1' are parsed into their integer value, most
+ significant bit first, and the register sizes (2 and 1 here) are kept to
+ format them back.
+ */
+struct CountHistogram {
+
+    /**
+     Number of bits of each register, in the order they appear in the keys.
+     */
+    let register_sizes: [Int]
+    private(set) var states: [Int] = []
+    private(set) var counts: [Int] = []
+
+    init(_ register_sizes: [Int], _ states: [Int], _ counts: [Int]) {
+        self.register_sizes = register_sizes
+        self.states = states
+        self.counts = counts
+    }
+
+    /**
+     Parses counts, nil if a key is not made of 0 and 1 in registers of
+     the same sizes as the other keys, or is too wide for an Int.
+     */
+    init?(_ counts: [String:Int]) {
+        var register_sizes: [Int]? = nil
+        for (key, count) in counts {
+            var sizes: [Int] = []
+            var size = 0
+            var state = 0
+            for c in key.utf8 {
+                switch c {
+                case 48, 49: // "0", "1"
+                    state = (state << 1) | Int(c - 48)
+                    size += 1
+                case 32: // " "
+                    sizes.append(size)
+                    size = 0
+                default:
+                    return nil
+                }
+            }
+            sizes.append(size)
+            if sizes.reduce(0, +) > Int.bitWidth - 2 {
+                return nil
+            }
+            if let expected = register_sizes {
+                if sizes != expected {
+                    return nil
+                }
+            }
+            else {
+                register_sizes = sizes
+            }
+            self.states.append(state)
+            self.counts.append(count)
+        }
+        self.register_sizes = register_sizes ?? []
+    }
+
+    /**
+     Total number of bits of an outcome.
+     */
+    var number_of_bits: Int {
+        return self.register_sizes.reduce(0, +)
+    }
+
+    /**
+     Sum of the counts.
+     */
+    var shots: Int {
+        return self.counts.reduce(0, +)
+    }
+
+    /**
+     Bit string of state, with spaces at register boundaries.
+     */
+    func format(_ state: Int) -> String {
+        var key: [Character] = []
+        var bit = self.number_of_bits - 1
+        for (reg, size) in self.register_sizes.enumerated() {
+            if reg > 0 {
+                key.append(" ")
+            }
+            for _ in 0..<size {
+                key.append((state >> bit) & 1 == 1 ? "1" : "0")
+                bit -= 1
+            }
+        }
+        return String(key)
+    }
+
+    /**
+     Averages of the Z strings selected by masks, bit i of a mask standing
+     for the i-th bit from the right of the outcome. An outcome counts +1
+     when an even number of the selected bits are set and -1 otherwise.
+     All masks are evaluated in a single pass over the outcomes.
+     */
+    func z_parities(_ masks: [Int]) -> [Double] {
+        var sums = [Int](repeating: 0, count: masks.count)
+        for (state, count) in zip(self.states, self.counts) {
+            for (i, mask) in masks.enumerated() {
+                sums[i] += (state & mask).nonzeroBitCount & 1 == 0 ? count : -count
+            }
+        }
+        let tot = self.shots
+        if tot == 0 {
+            return [Double](repeating: 0.0, count: masks.count)
+        }
+        return sums.map { Double($0) / Double(tot) }
+    }
+
+    /**
+     The counts in the {'00000': XXXX, '00001': XXXXX} format.
+     */
+    var dictionary: [String:Int] {
+        var counts: [String:Int] = [:]
+        for (state, count) in zip(self.states, self.counts) {
+            counts[self.format(state)] = count
+        }
+        return counts
+    }
+}
+
+/**
+ Typed, columnar storage behind Result.
+
+ The qobj circuits and the per circuit results are kept as parallel
+ columns, indexed by circuit position, with counts parsed once into a
+ CountHistogram and quantum states kept as typed arrays. The dictionary
+ forms of the qobj and of the result are built on demand.
+ */
+struct ResultStore {
+
+    /**
+     Qobj entries other than "circuits".
+     */
+    private(set) var qobj_fields: [String:Any] = [:]
+    /**
+     Result entries other than "result".
+     */
+    private(set) var result_fields: [String:Any] = [:]
+    /**
+     Qobj circuits, nil if the qobj had none.
+     */
+    private(set) var circuits: [[String:Any]]? = nil
+    private(set) var names: [String?] = []
+    private var name_index: [String:Int] = [:]
+    /**
+     The error the job failed with, if any.
+     */
+    private(set) var error: Error? = nil
+    /**
+     Whether the result holds a list of circuit results.
+     */
+    private(set) var has_rows: Bool = false
+    /**
+     Circuit result entries other than "data".
+     */
+    private(set) var rows: [[String:Any]] = []
+    /**
+     Circuit data entries other than the parsed counts and quantum state.
+     */
+    private(set) var row_data: [[String:Any]?] = []
+    private(set) var row_counts: [CountHistogram?] = []
+    private(set) var row_quantum_states: [[Complex]?] = []
+
+    init(_ qobj: [String:Any], _ result: [String:Any]) {
+        self.set_qobj(qobj)
+        self.set_result(result)
+    }
+
+    var qobj: [String:Any] {
+        var qobj = self.qobj_fields
+        if let circuits = self.circuits {
+            qobj["circuits"] = circuits
+        }
+        return qobj
+    }
+
+    var result: [String:Any] {
+        var result = self.result_fields
+        if let error = self.error {
+            result["result"] = error
+        }
+        else if self.has_rows {
+            result["result"] = (0..<self.rows.count).map { self.row($0) }
+        }
+        return result
+    }
+
+    var count: Int {
+        return self.rows.count
+    }
+
+    mutating func set_qobj(_ qobj: [String:Any]) {
+        var fields = qobj
+        self.circuits = nil
+        self.names = []
+        self.name_index = [:]
+        if let circuits = qobj["circuits"] as? [[String:Any]] {
+            fields["circuits"] = nil
+            self.circuits = []
+            self.append_circuits(circuits)
+        }
+        self.qobj_fields = fields
+    }
+
+    mutating func set_result(_ result: [String:Any]) {
+        var fields = result
+        self.error = nil
+        self.has_rows = false
+        self.rows = []
+        self.row_data = []
+        self.row_counts = []
+        self.row_quantum_states = []
+        if let error = result["result"] as? Error {
+            fields["result"] = nil
+            self.error = error
+        }
+        else if let rows = result["result"] as? [[String:Any]] {
+            fields["result"] = nil
+            self.has_rows = true
+            self.append_rows(rows)
+        }
+        self.result_fields = fields
+    }
+
+    mutating func set_qobj_field(_ key: String, _ value: Any?) {
+        self.qobj_fields[key] = value
+    }
+
+    /**
+     Adds circuits at the end of the circuit column.
+     */
+    mutating func append_circuits(_ circuits: [[String:Any]]) {
+        if self.circuits == nil {
+            self.circuits = []
+        }
+        for circuit in circuits {
+            let name = circuit["name"] as? String
+            if let n = name, self.name_index[n] == nil {
+                self.name_index[n] = self.names.count
+            }
+            self.names.append(name)
+            self.circuits!.append(circuit)
+        }
+    }
+
+    /**
+     Adds circuit results at the end of the result columns.
+     */
+    mutating func append_rows(_ rows: [[String:Any]]) {
+        self.has_rows = true
+        for row in rows {
+            var fields = row
+            var counts: CountHistogram? = nil
+            var quantum_state: [Complex]? = nil
+            var data: [String:Any]? = nil
+            if var d = row["data"] as? [String:Any] {
+                fields["data"] = nil
+                if let c = d["counts"] as? [String:Int], let histogram = CountHistogram(c) {
+                    d["counts"] = nil
+                    counts = histogram
+                }
+                if let q = d["quantum_state"] as? [Complex] {
+                    d["quantum_state"] = nil
+                    quantum_state = q
+                }
+                data = d
+            }
+            self.rows.append(fields)
+            self.row_data.append(data)
+            self.row_counts.append(counts)
+            self.row_quantum_states.append(quantum_state)
+        }
+    }
+
+    /**
+     Adds the circuits and circuit results of other.
+     */
+    mutating func append(_ other: ResultStore) {
+        if let circuits = other.circuits {
+            self.append_circuits(circuits)
+        }
+        if other.has_rows {
+            self.has_rows = true
+            self.rows.append(contentsOf: other.rows)
+            self.row_data.append(contentsOf: other.row_data)
+            self.row_counts.append(contentsOf: other.row_counts)
+            self.row_quantum_states.append(contentsOf: other.row_quantum_states)
+        }
+    }
+
+    /**
+     Position of the first circuit called name that has data.
+     */
+    func index(_ name: String) -> Int? {
+        guard let first = self.name_index[name] else {
+            return nil
+        }
+        for index in first..<self.names.count where self.names[index] == name {
+            if index < self.row_data.count && self.row_data[index] != nil {
+                return index
+            }
+        }
+        return nil
+    }
+
+    /**
+     Circuit result entry at index, in its dictionary form.
+     */
+    func row(_ index: Int) -> [String:Any] {
+        var row = self.rows[index]
+        if let data = self.data(index) {
+            row["data"] = data
+        }
+        return row
+    }
+
+    /**
+     Circuit data at index, in its dictionary form.
+     */
+    func data(_ index: Int) -> [String:Any]? {
+        guard var data = self.row_data[index] else {
+            return nil
+        }
+        if let counts = self.row_counts[index] {
+            data["counts"] = counts.dictionary
+        }
+        if let quantum_state = self.row_quantum_states[index] {
+            data["quantum_state"] = quantum_state
+        }
+        return data
+    }
+
+    /**
+     Sets the counts of the circuit result at index.
+     */
+    mutating func set_counts(_ index: Int, _ counts: CountHistogram) {
+        if self.row_data[index] == nil {
+            self.row_data[index] = [:]
+        }
+        self.row_data[index]!["counts"] = nil
+        self.row_counts[index] = counts
+    }
+
+    /**
+     Sets a data entry of the circuit result at index.
+     */
+    mutating func set_data_value(_ index: Int, _ key: String, _ value: Any) {
+        if self.row_data[index] == nil {
+            self.row_data[index] = [:]
+        }
+        if key == "quantum_state", let quantum_state = value as? [Complex] {
+            self.row_data[index]!["quantum_state"] = nil
+            self.row_quantum_states[index] = quantum_state
+        }
+        else {
+            self.row_data[index]![key] = value
+        }
+    }
+
+    func status(_ index: Int) -> String? {
+        return self.rows[index]["status"] as? String
+    }
+}
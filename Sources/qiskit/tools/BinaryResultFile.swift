@@ -0,0 +1,470 @@
+// Copyright 2017 IBM RESEARCH. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+
+import Foundation
+
+/**
+ Binary container for a result (qobj + result) and its metadata.
+
+ Layout, all integers and doubles little endian::
+
+     "QRES" (4 bytes) | version (UInt32)
+     record*
+
+ where each record is::
+
+     kind (UInt8) | circuit index (UInt32) | key length (UInt32) | key (utf8)
+     payload length (UInt64) | payload
+
+ The first record holds the JSON of the qobj, the metadata and the result
+ without the buffers below. The result of a job that failed keeps the
+ description of its error under "result_error" instead of its circuits.
+ The following records hold the buffers of the circuit results, keyed by
+ their data entry:
+
+ - complex vectors: (real, imag) pairs of doubles
+ - complex matrices: rows (UInt64), columns (UInt64), then the elements
+   row by row as (real, imag) pairs
+ - counts: number of registers (UInt32), bits of each register (UInt32),
+   then (outcome, count) pairs of Int64
+
+ Buffers are written to the file as they are produced. Loading maps the
+ file but does not share its pages: every buffer is copied out of the
+ mapping into a new array of the result.
+ */
+final class BinaryResultFile {
+
+    static let magic: [UInt8] = Array("QRES".utf8)
+    static let version: UInt32 = 1
+
+    fileprivate enum Kind: UInt8 {
+        case json = 1
+        case vector = 2
+        case matrix = 3
+        case counts = 4
+    }
+
+    fileprivate static let noCircuit: UInt32 = UInt32.max
+    fileprivate static let errorKey: String = "result_error"
+    fileprivate static let chunkSize: Int = 1 << 20
+
+    /**
+     Whether Complex arrays can be copied to and from the file as they
+     are in memory: two doubles, real first, on a little endian host.
+     */
+    fileprivate static let nativeComplex: Bool = MemoryLayout<Complex>.size == 16 &&
+                                                 MemoryLayout<Complex>.stride == 16 &&
+                                                 UInt32(1).littleEndian == 1
+
+    private init() {
+    }
+
+    /**
+     Whether data starts like a binary result file.
+     */
+    static func isBinary(_ url: URL) -> Bool {
+        guard let handle = try? FileHandle(forReadingFrom: url) else {
+            return false
+        }
+        defer { handle.closeFile() }
+        return Array(handle.readData(ofLength: magic.count)) == magic
+    }
+
+    /**
+     Writes resultobj and metadata to url.
+     */
+    static func save(_ resultobj: Result, _ metadata: [String:Any], _ url: URL) throws {
+        let store = resultobj._store
+        var buffers: [(Int, String, Any)] = []
+        var result = store.result_fields
+        if let error = store.error {
+            result["status"] = "ERROR"
+            result[BinaryResultFile.errorKey] = String(describing: error)
+        }
+        else if store.has_rows {
+            var rows: [[String:Any]] = []
+            for index in 0..<store.count {
+                var row = store.rows[index]
+                if let data = store.row_data[index] {
+                    var json_data: [String:Any] = [:]
+                    for (key, value) in data {
+                        if value is [Complex] || value is Vector<Complex> || value is Matrix<Complex> ||
+                            value is ComplexBuffer {
+                            buffers.append((index, key, value))
+                        }
+                        else {
+                            json_data[key] = value
+                        }
+                    }
+                    if let quantum_state = store.row_quantum_states[index] {
+                        buffers.append((index, "quantum_state", quantum_state))
+                    }
+                    if let counts = store.row_counts[index] {
+                        buffers.append((index, "counts", counts))
+                    }
+                    row["data"] = FileIO.convert_qobj_to_json(json_data)
+                }
+                rows.append(row)
+            }
+            result["result"] = rows
+        }
+        let master_dict: [String:Any] = ["qobj": store.qobj,
+                                         "result": result,
+                                         "metadata": metadata]
+        let json = try JSONSerialization.data(withJSONObject: master_dict, options: [])
+
+        if !FileManager.default.createFile(atPath: url.path, contents: nil, attributes: nil) {
+            throw QISKitError.invalidFile(file: url.path)
+        }
+        let writer = Writer(try FileHandle(forWritingTo: url))
+        defer { writer.close() }
+        writer.append(BinaryResultFile.magic)
+        writer.append(BinaryResultFile.version)
+        writer.header(.json, nil, "", UInt64(json.count))
+        writer.append(json)
+        for (index, key, value) in buffers {
+            if let counts = value as? CountHistogram {
+                let length = 4 + 4 * counts.register_sizes.count + 16 * counts.states.count
+                writer.header(.counts, index, key, UInt64(length))
+                writer.append(UInt32(counts.register_sizes.count))
+                for size in counts.register_sizes {
+                    writer.append(UInt32(size))
+                }
+                for (state, count) in zip(counts.states, counts.counts) {
+                    writer.append(Int64(state))
+                    writer.append(Int64(count))
+                }
+            }
+            else if let buffer = value as? ComplexBuffer {
+                if buffer.dimensions.count == 2 {
+                    writer.header(.matrix, index, key, UInt64(16 + 16 * buffer.count))
+                    writer.append(UInt64(buffer.dimensions[0]))
+                    writer.append(UInt64(buffer.dimensions[1]))
+                }
+                else {
+                    writer.header(.vector, index, key, UInt64(16 * buffer.count))
+                }
+                writer.append(buffer)
+            }
+            else if let matrix = value as? Matrix<Complex> {
+                let (rows, cols) = matrix.shape
+                writer.header(.matrix, index, key, UInt64(16 + 16 * rows * cols))
+                writer.append(UInt64(rows))
+                writer.append(UInt64(cols))
+                for row in matrix.value {
+                    writer.append(row)
+                }
+            }
+            else {
+                var values: [Complex] = []
+                if let list = value as? [Complex] {
+                    values = list
+                }
+                else if let vector = value as? Vector<Complex> {
+                    values = vector.value
+                }
+                writer.header(.vector, index, key, UInt64(16 * values.count))
+                writer.append(values)
+            }
+        }
+        writer.flush()
+    }
+
+    /**
+     Reads the result and metadata stored at url.
+     */
+    static func load(_ url: URL) throws -> (Result,[String:Any]) {
+        let data = try Data(contentsOf: url, options: .alwaysMapped)
+        return try data.withUnsafeBytes { (bytes: UnsafePointer<UInt8>) -> (Result,[String:Any]) in
+            let reader = Reader(bytes, data.count, url.path)
+            if Array(try reader.bytes(BinaryResultFile.magic.count)) != BinaryResultFile.magic {
+                throw QISKitError.invalidFile(file: url.path)
+            }
+            let version: UInt32 = try reader.integer()
+            if version != BinaryResultFile.version {
+                throw QISKitError.invalidFile(file: url.path)
+            }
+            var resultobj: Result? = nil
+            var metadata: [String:Any] = [:]
+            while !reader.atEnd {
+                guard let kind = Kind(rawValue: try reader.integer()) else {
+                    throw QISKitError.invalidFile(file: url.path)
+                }
+                let circuit: UInt32 = try reader.integer()
+                let key_length: UInt32 = try reader.integer()
+                guard let key = String(data: try reader.bytes(try reader.length(UInt64(key_length))), encoding: .utf8) else {
+                    throw QISKitError.invalidFile(file: url.path)
+                }
+                let length = try reader.length(try reader.integer() as UInt64)
+                let end = reader.offset + length
+                if kind == .json {
+                    guard let master_dict = try JSONSerialization.jsonObject(with: try reader.bytes(length), options: []) as? [String:Any],
+                        let qobj = master_dict["qobj"] as? [String:Any],
+                        let qresult_dict = master_dict["result"] as? [String:Any] else {
+                        throw QISKitError.invalidFile(file: url.path)
+                    }
+                    var qresult = try FileIO.convert_json_to_qobj(qresult_dict)
+                    if let message = qresult[BinaryResultFile.errorKey] as? String {
+                        qresult[BinaryResultFile.errorKey] = nil
+                        qresult["result"] = QISKitError.errorStatus(status: message)
+                    }
+                    resultobj = Result(qresult, qobj)
+                    metadata = master_dict["metadata"] as? [String:Any] ?? [:]
+                    continue
+                }
+                guard resultobj != nil, circuit != BinaryResultFile.noCircuit,
+                    Int(circuit) < resultobj!._store.count else {
+                    throw QISKitError.invalidFile(file: url.path)
+                }
+                let index = Int(circuit)
+                switch kind {
+                case .vector:
+                    if length % 16 != 0 {
+                        throw QISKitError.invalidFile(file: url.path)
+                    }
+                    resultobj!._store.set_data_value(index, key, try reader.complex(length / 16))
+                case .matrix:
+                    // the payload must hold exactly rows * cols elements, and
+                    // rows without columns would cost memory but no bytes
+                    let rows = try reader.length(try reader.integer() as UInt64)
+                    let cols = try reader.length(try reader.integer() as UInt64)
+                    let (elements, overflow) = rows.multipliedReportingOverflow(by: cols)
+                    let (size, size_overflow) = elements.multipliedReportingOverflow(by: 16)
+                    if overflow || size_overflow || size != end - reader.offset || (cols == 0 && rows != 0) {
+                        throw QISKitError.invalidFile(file: url.path)
+                    }
+                    var value: [[Complex]] = []
+                    value.reserveCapacity(rows)
+                    for _ in 0..<rows {
+                        value.append(try reader.complex(cols))
+                    }
+                    resultobj!._store.set_data_value(index, key, Matrix<Complex>(value: value))
+                case .counts:
+                    let nregs = try reader.length(UInt64(try reader.integer() as UInt32))
+                    if nregs > (end - reader.offset) / 4 {
+                        throw QISKitError.invalidFile(file: url.path)
+                    }
+                    var sizes: [Int] = []
+                    for _ in 0..<nregs {
+                        let size: UInt32 = try reader.integer()
+                        sizes.append(Int(size))
+                    }
+                    if (end - reader.offset) % 16 != 0 {
+                        throw QISKitError.invalidFile(file: url.path)
+                    }
+                    var states: [Int] = []
+                    var counts: [Int] = []
+                    while reader.offset < end {
+                        let state: Int64 = try reader.integer()
+                        let count: Int64 = try reader.integer()
+                        guard let s = Int(exactly: state), let c = Int(exactly: count) else {
+                            throw QISKitError.invalidFile(file: url.path)
+                        }
+                        states.append(s)
+                        counts.append(c)
+                    }
+                    resultobj!._store.set_counts(index, CountHistogram(sizes, states, counts))
+                case .json:
+                    break
+                }
+                if reader.offset != end {
+                    throw QISKitError.invalidFile(file: url.path)
+                }
+            }
+            guard let ret = resultobj else {
+                throw QISKitError.invalidFile(file: url.path)
+            }
+            return (ret, metadata)
+        }
+    }
+
+    /**
+     Buffered little endian writer.
+     */
+    fileprivate final class Writer {
+
+        private let handle: FileHandle
+        private var buffer = Data()
+
+        init(_ handle: FileHandle) {
+            self.handle = handle
+        }
+
+        func header(_ kind: Kind, _ circuit: Int?, _ key: String, _ length: UInt64) {
+            let key_bytes = Array(key.utf8)
+            self.append(kind.rawValue)
+            self.append(circuit != nil ? UInt32(circuit!) : BinaryResultFile.noCircuit)
+            self.append(UInt32(key_bytes.count))
+            self.append(key_bytes)
+            self.append(length)
+        }
+
+        func append<T: FixedWidthInteger>(_ value: T) {
+            var le = value.littleEndian
+            withUnsafeBytes(of: &le) { (raw) in
+                self.buffer.append(raw.baseAddress!.assumingMemoryBound(to: UInt8.self), count: raw.count)
+            }
+        }
+
+        func append(_ bytes: [UInt8]) {
+            self.buffer.append(contentsOf: bytes)
+        }
+
+        func append(_ data: Data) {
+            self.flush()
+            self.handle.write(data)
+        }
+
+        func append(_ values: [Complex]) {
+            if BinaryResultFile.nativeComplex {
+                self.flush()
+                values.withUnsafeBytes { (raw) in
+                    guard let base = raw.baseAddress, raw.count > 0 else {
+                        return
+                    }
+                    self.handle.write(Data(bytesNoCopy: UnsafeMutableRawPointer(mutating: base),
+                                           count: raw.count,
+                                           deallocator: .none))
+                }
+                return
+            }
+            for value in values {
+                self.append(value.real.bitPattern)
+                self.append(value.imag.bitPattern)
+                if self.buffer.count >= BinaryResultFile.chunkSize {
+                    self.flush()
+                }
+            }
+        }
+
+        func append(_ values: ComplexBuffer) {
+            if BinaryResultFile.nativeComplex {
+                self.flush()
+                values.withUnsafeBytes { (raw) in
+                    guard let base = raw.baseAddress, raw.count > 0 else {
+                        return
+                    }
+                    self.handle.write(Data(bytesNoCopy: UnsafeMutableRawPointer(mutating: base),
+                                           count: raw.count,
+                                           deallocator: .none))
+                }
+                return
+            }
+            for value in values {
+                self.append(value.real.bitPattern)
+                self.append(value.imag.bitPattern)
+                if self.buffer.count >= BinaryResultFile.chunkSize {
+                    self.flush()
+                }
+            }
+        }
+
+        func flush() {
+            if !self.buffer.isEmpty {
+                self.handle.write(self.buffer)
+                self.buffer = Data()
+            }
+        }
+
+        func close() {
+            self.flush()
+            self.handle.closeFile()
+        }
+    }
+
+    /**
+     Bounds checked little endian reader over a memory mapped file.
+     */
+    fileprivate final class Reader {
+
+        private let base: UnsafePointer<UInt8>
+        private let count: Int
+        private let file: String
+        private(set) var offset: Int = 0
+
+        init(_ base: UnsafePointer<UInt8>, _ count: Int, _ file: String) {
+            self.base = base
+            self.count = count
+            self.file = file
+        }
+
+        var atEnd: Bool {
+            return self.offset >= self.count
+        }
+
+        /**
+         Bytes left to read.
+         */
+        var remaining: Int {
+            return self.count - self.offset
+        }
+
+        private func check(_ length: Int) throws {
+            if length < 0 || length > self.remaining {
+                throw QISKitError.invalidFile(file: self.file)
+            }
+        }
+
+        /**
+         A length read from the file, checked against the bytes left before
+         it is converted.
+         */
+        func length(_ value: UInt64) throws -> Int {
+            if value > UInt64(self.remaining) {
+                throw QISKitError.invalidFile(file: self.file)
+            }
+            return Int(value)
+        }
+
+        func integer<T: FixedWidthInteger>() throws -> T {
+            try self.check(MemoryLayout<T>.size)
+            var value: T = 0
+            memcpy(&value, self.base + self.offset, MemoryLayout<T>.size)
+            self.offset += MemoryLayout<T>.size
+            return T(littleEndian: value)
+        }
+
+        func bytes(_ length: Int) throws -> Data {
+            try self.check(length)
+            let data = Data(bytes: self.base + self.offset, count: length)
+            self.offset += length
+            return data
+        }
+
+        func complex(_ n: Int) throws -> [Complex] {
+            let (size, overflow) = n.multipliedReportingOverflow(by: 16)
+            if n < 0 || overflow {
+                throw QISKitError.invalidFile(file: self.file)
+            }
+            try self.check(size)
+            var values = [Complex](repeating: Complex(), count: n)
+            if BinaryResultFile.nativeComplex {
+                values.withUnsafeMutableBytes { (raw) in
+                    if let dest = raw.baseAddress, n > 0 {
+                        memcpy(dest, self.base + self.offset, 16 * n)
+                    }
+                }
+                self.offset += 16 * n
+                return values
+            }
+            for i in 0..<n {
+                let real: UInt64 = try self.integer()
+                let imag: UInt64 = try self.integer()
+                values[i] = Complex(Double(bitPattern: real), Double(bitPattern: imag))
+            }
+            return values
+        }
+    }
+}
@@ -54,6 +54,12 @@ public final class FileIO {
                 jsonDict["\(key)_ndarray_imag"] = complexVector.imag().value
                 continue
             }
+            if let buffer = value as? ComplexBuffer {
+                let (real, imag) = FileIO.convert_buffer_to_json(buffer)
+                jsonDict["\(key)_ndarray_real"] = real
+                jsonDict["\(key)_ndarray_imag"] = imag
+                continue
+            }
             if let valueList = value as? [Any] {
                 jsonDict[key] = convert_qobj_to_json(valueList)
                 continue
@@ -63,6 +69,31 @@ public final class FileIO {
         return jsonDict
     }
 
+    /**
+     Real and imaginary parts of buffer, as lists of rows for a matrix.
+     */
+    private static func convert_buffer_to_json(_ buffer: ComplexBuffer) -> (Any,Any) {
+        let cols = buffer.dimensions.count == 2 ? buffer.dimensions[1] : buffer.count
+        var real_rows: [[Double]] = []
+        var imag_rows: [[Double]] = []
+        for start in stride(from: 0, to: buffer.count, by: max(cols, 1)) {
+            var real: [Double] = []
+            var imag: [Double] = []
+            real.reserveCapacity(cols)
+            imag.reserveCapacity(cols)
+            for i in start..<(start + cols) {
+                real.append(buffer[i].real)
+                imag.append(buffer[i].imag)
+            }
+            real_rows.append(real)
+            imag_rows.append(imag)
+        }
+        if buffer.dimensions.count == 2 {
+            return (real_rows, imag_rows)
+        }
+        return (real_rows.first ?? [], imag_rows.first ?? [])
+    }
+
     public static func convert_qobj_to_json(_ in_item: [Any]) -> [Any] {
         var jsonList: [Any] = []
         for value in in_item {
@@ -179,7 +210,8 @@ public final class FileIO {
     }
 
     /**
-     Load a results dictionary file (.json) to a Result object.
+     Load a results dictionary file (.json) or binary result file (.qres)
+     to a Result object. The format is recognized from the file contents.
      Note: The json file may not load properly if it was saved with a previous
      version of the SDK.
 
@@ -196,6 +228,9 @@ public final class FileIO {
             if !FileManager.default.fileExists(atPath: url.path) {
                 throw QISKitError.invalidFile(file: filename)
             }
+            if BinaryResultFile.isBinary(url) {
+                return try BinaryResultFile.load(url)
+            }
             let data = try Data(contentsOf: url)
             guard let master_dict = try JSONSerialization.jsonObject(with: data, options: .allowFragments) as? [String:Any] else {
                 throw QISKitError.invalidFile(file: filename)
@@ -229,14 +264,25 @@ public final class FileIO {
         E.g. if filename=test.json and that file exists then the file will be changed
         to test_1.json
         metadata (dict): Add another dictionary with custom data for the result (eg fit results)
+        format (str): "json" for a json file, "binary" for a binary file with the
+        .qres extension that keeps counts and complex arrays as raw buffers.
 
      Return:
         String: full file path
      */
     public static func save_result_to_file(_ resultobj: Result,
                                            _ file: String,
-                                           metadata: [String:Any]? = nil) throws -> String {
+                                           metadata: [String:Any]? = nil,
+                                           format: String = "json") throws -> String {
         do {
+            if format == "binary" {
+                let url = unique_url(file, "qres")
+                try BinaryResultFile.save(resultobj, metadata ?? [:], url)
+                return url.path
+            }
+            if format != "json" {
+                throw QISKitError.invalidFileFormat(format: format)
+            }
             var master_dict: [String: Any] = [:]
             master_dict["qobj"] = resultobj._qobj
             //need to convert any ndarray variables to lists so that they can be
@@ -251,20 +297,7 @@ public final class FileIO {
 
             let data = try JSONSerialization.data(withJSONObject: master_dict, options: .prettyPrinted)
 
-            //if the filename has .json appended strip it off
-            var filename = file
-            if filename.count > 4 && filename.suffix(5).lowercased() == ".json" {
-                filename = String(filename.dropLast(5))
-            }
-
-            var append_str = ""
-            var append_num = 0
-            var url = URL(fileURLWithPath: filename).appendingPathExtension("json")
-            while FileManager.default.fileExists(atPath: url.path) {
-                append_num += 1
-                append_str = "\(append_str)_\(append_num)"
-                url = URL(fileURLWithPath: "\(filename)\(append_str)").appendingPathExtension("json")
-            }
+            let url = unique_url(file, "json")
             try data.write(to: url)
             return url.path
         } catch let error as QISKitError {
@@ -273,4 +306,27 @@ public final class FileIO {
             throw QISKitError.internalError(error: error)
         }
     }
+
+    /**
+     Path of file with the extension, numbers being appended to the root
+     until no such file exists.
+     */
+    private static func unique_url(_ file: String, _ pathExtension: String) -> URL {
+        //if the filename has the extension appended strip it off
+        var filename = file
+        let suffix = ".\(pathExtension)"
+        if filename.count > suffix.count - 1 && filename.suffix(suffix.count).lowercased() == suffix {
+            filename = String(filename.dropLast(suffix.count))
+        }
+
+        var append_str = ""
+        var append_num = 0
+        var url = URL(fileURLWithPath: filename).appendingPathExtension(pathExtension)
+        while FileManager.default.fileExists(atPath: url.path) {
+            append_num += 1
+            append_str = "\(append_str)_\(append_num)"
+            url = URL(fileURLWithPath: "\(filename)\(append_str)").appendingPathExtension(pathExtension)
+        }
+        return url
+    }
 }
@@ -32,6 +32,7 @@ public enum ToolsError: LocalizedError, CustomStringConvertible {
     case invalidMethod(method: String)
     case errorVectorizedMatrix
     case errorConcurrence
+    case batchSize(expected: Int, received: Int)
 
     public var errorDescription: String? {
         return self.description
@@ -62,6 +63,8 @@ public enum ToolsError: LocalizedError, CustomStringConvertible {
             return "Input is not a vectorized square matrix"
         case .errorConcurrence:
             return "Concurrence is not defined for more than two qubits"
+        case .batchSize(let expected, let received):
+            return "Objective function returned \(received) values for \(expected) variable sets"
         }
     }
 }
@@ -114,6 +114,9 @@ public final class Fermion {
      of the existing pauli. If the new coefficient is less than
      threshold the pauli term is deleted from the list
 
+     Each call scans and copies the list. Sums of many terms are built
+     with PauliAccumulator instead.
+
      Args:
         pauli_term : list of [coeff, pauli]
         pauli_list : a list of pauli_terms
@@ -177,7 +180,7 @@ public final class Fermion {
         //############   DEFINING MAPPED FERMIONIC OPERATORS    ##############
         //####################################################################
 
-        var pauli_list: [(Complex,Pauli)] = []
+        var pauli_sum = PauliAccumulator()
         let n = h1.count  // number of fermionic modes / qubits
         var a: [[Pauli]] = []
         if map_type == "JORDAN_WIGNER" {
@@ -317,13 +320,12 @@ public final class Fermion {
                     for alpha in 0..<2 {
                         for beta in 0..<2 {
                             let pauli_prod = try Pauli.sgn_prod(a[i][alpha], a[j][beta])
-                            let pauli_term = (h1[i][j] *
-                                                1 / 4 *
-                                                pauli_prod.1 *
-                                                Complex(imag:-1).power(alpha) *
-                                                Complex(imag:1).power(beta),
-                                                pauli_prod.0)
-                            pauli_list = pauli_term_append(pauli_term, pauli_list, threshold)
+                            let coeff = h1[i][j] *
+                                        1 / 4 *
+                                        pauli_prod.1 *
+                                        Complex(imag:-1).power(alpha) *
+                                        Complex(imag:1).power(beta)
+                            pauli_sum.add(coeff, pauli_prod.0, threshold)
                         }
                     }
                 }
@@ -331,40 +333,48 @@ public final class Fermion {
         }
         //#######################    Two-body    #############################
 
-        for i in 0..<n {
-            for j in 0..<n {
+        // The (i,j) pairs are spread over the available cores, each pair
+        // summing its terms into its own accumulator. The accumulators are
+        // merged in pair order, so the result does not depend on scheduling.
+        var partial_sums = [PauliAccumulator](repeating: PauliAccumulator(), count: n * n)
+        var two_body_error: Error? = nil
+        let lock = NSLock()
+        let pauli_a = a
+        DispatchQueue.concurrentPerform(iterations: n * n) { (pair) in
+            let i = pair / n
+            let j = pair % n
+            var partial_sum = PauliAccumulator()
+            do {
                 for k in 0..<n {
                     for m in 0..<n {
-                        if h2[i][j][k][m] != 0 {
-                            for alpha in 0..<2 {
-                                for beta in 0..<2 {
-                                    for gamma in 0..<2 {
-                                        for delta in 0..<2 {
-
-                                            // Note: chemists' notation for the
-                                            // labeling,
-                                            // h2(i,j,k,m) adag_i adag_k a_m a_j
-
-                                            let pauli_prod_1 = try Pauli.sgn_prod(a[i][alpha], a[k][beta])
-                                            let pauli_prod_2 = try Pauli.sgn_prod(pauli_prod_1.0, a[m][gamma])
-                                            let pauli_prod_3 = try Pauli.sgn_prod(pauli_prod_2.0, a[j][delta])
-
-                                            let phase1 = pauli_prod_1.1 * pauli_prod_2.1 * pauli_prod_3.1
-                                            let phase2 = Complex(imag:-1).power(alpha + beta) *
-                                                         Complex(imag: 1).power(gamma + delta)
-                                            let pauli_term = (h2[i][j][k][m] * 1 / 16 * phase1 * phase2,
-                                                              pauli_prod_3.0)
-                                            pauli_list = pauli_term_append(pauli_term, pauli_list, threshold)
-                                        }
-                                    }
-                                }
-                            }
+                        guard let weights = Fermion.two_body_weights(h2, i, j, k, m) else {
+                            continue
                         }
+                        try Fermion.two_body_terms(pauli_a, h2[i][j][k][m], i, j, k, m,
+                                                   weights, threshold, &partial_sum)
                     }
                 }
+            } catch {
+                lock.lock()
+                if two_body_error == nil {
+                    two_body_error = error
+                }
+                lock.unlock()
+                return
             }
+            lock.lock()
+            partial_sums[pair] = partial_sum
+            lock.unlock()
+        }
+        if let error = two_body_error {
+            throw error
+        }
+        for partial_sum in partial_sums {
+            pauli_sum.add(partial_sum)
         }
 
+        let pauli_list = pauli_sum.pauli_list(threshold)
+
         //####################################################################
         //#################          WRITE TO FILE         ###################
         //####################################################################
@@ -380,6 +390,76 @@ public final class Fermion {
         return pauli_list
     }
 
+    /**
+     Multiplicities with which the two-body term (i,j,k,m) enters the
+     Hamiltonian, or nil if it is zero or accounted for by another term.
+
+     In chemists' notation (k,m,i,j) labels the same operator as (i,j,k,m)
+     and (j,i,m,k) its adjoint. When h2 holds the same value on all of
+     them, only the smallest index quadruple is expanded, its terms counted
+     once per distinct quadruple: the first count for the operator itself,
+     the second for its adjoint. Otherwise every quadruple is expanded on
+     its own.
+     */
+    static func two_body_weights(_ h2: [[[[Double]]]],
+                                 _ i: Int, _ j: Int, _ k: Int, _ m: Int) -> (Int,Int)? {
+        let value = h2[i][j][k][m]
+        if value == 0 {
+            return nil
+        }
+        let same = [i,j,k,m] == [k,m,i,j] ? [[i,j,k,m]] : [[i,j,k,m],[k,m,i,j]]
+        let adjoint = [[j,i,m,k],[m,k,j,i]].filter { !same.contains($0) }
+        var orbit = same
+        for q in adjoint where !orbit.contains(q) {
+            orbit.append(q)
+        }
+        for q in orbit where h2[q[0]][q[1]][q[2]][q[3]] != value {
+            return (1,0)
+        }
+        for q in orbit where q.lexicographicallyPrecedes([i,j,k,m]) {
+            return nil
+        }
+        return (same.count, orbit.count - same.count)
+    }
+
+    /**
+     Expands h2_ijkm adag_i adag_k a_m a_j into Paulis and adds them to
+     pauli_sum, weights.0 times as they are and weights.1 times as their
+     adjoint.
+     */
+    static func two_body_terms(_ a: [[Pauli]],
+                               _ h2_ijkm: Double,
+                               _ i: Int, _ j: Int, _ k: Int, _ m: Int,
+                               _ weights: (Int,Int),
+                               _ threshold: Double,
+                               _ pauli_sum: inout PauliAccumulator) throws {
+        for alpha in 0..<2 {
+            for beta in 0..<2 {
+                for gamma in 0..<2 {
+                    for delta in 0..<2 {
+
+                        // Note: chemists' notation for the
+                        // labeling,
+                        // h2(i,j,k,m) adag_i adag_k a_m a_j
+
+                        let pauli_prod_1 = try Pauli.sgn_prod(a[i][alpha], a[k][beta])
+                        let pauli_prod_2 = try Pauli.sgn_prod(pauli_prod_1.0, a[m][gamma])
+                        let pauli_prod_3 = try Pauli.sgn_prod(pauli_prod_2.0, a[j][delta])
+
+                        let phase1 = pauli_prod_1.1 * pauli_prod_2.1 * pauli_prod_3.1
+                        let phase2 = Complex(imag:-1).power(alpha + beta) *
+                                     Complex(imag: 1).power(gamma + delta)
+                        let coeff = h2_ijkm * 1 / 16 * phase1 * phase2
+                        // Paulis are hermitian, the adjoint only conjugates
+                        // the coefficient
+                        pauli_sum.add(Double(weights.0) * coeff + Double(weights.1) * coeff.conjugate(),
+                                      pauli_prod_3.0, threshold)
+                    }
+                }
+            }
+        }
+    }
+
     /**
      Eliminates the central and last qubit in a list of Pauli that has
      diagonal operators (Z,I) at those positions.abs
@@ -402,7 +482,7 @@ public final class Fermion {
                                            _ m: Int,
                                            _ out_file: String? = nil,
                                            _ threshold: Double = 0.000000000001) throws -> [(Complex,Pauli)] {
-        var ham_out: [(Complex,Pauli)] = []
+        var ham_sum = PauliAccumulator()
         var par_1: Double = 0
         var par_2: Double = 0
         if m % 4 == 0 {
@@ -455,9 +535,9 @@ public final class Fermion {
                     w_temp.append(pauli_term.1.w[j])
                 }
             }
-            let pauli_term_out = (coeff_out, Pauli(v_temp, w_temp))
-            ham_out = pauli_term_append(pauli_term_out, ham_out, threshold)
+            ham_sum.add(coeff_out, Pauli(v_temp, w_temp), threshold)
         }
+        let ham_out = ham_sum.pauli_list(threshold)
         //####################################################################
         //#################          WRITE TO FILE         ###################
         //####################################################################
@@ -473,3 +553,82 @@ public final class Fermion {
         return ham_out
     }
 } 
+
+/**
+ Bits of a Pauli packed two per qubit, v then w, 32 qubits to a word.
+ Used as a cheap hash key for Paulis.
+ */
+struct PauliKey: Hashable {
+
+    let words: [UInt64]
+
+    init(_ pauli: Pauli) {
+        var words = [UInt64](repeating: 0, count: (pauli.numberofqubits + 31) / 32)
+        for i in 0..<pauli.numberofqubits {
+            let bits = UInt64(pauli.v[i] & 1) | (UInt64(pauli.w[i] & 1) << 1)
+            words[i / 32] |= bits << UInt64(2 * (i % 32))
+        }
+        self.words = words
+    }
+
+    var hashValue: Int {
+        var h: UInt64 = 0xcbf29ce484222325
+        for word in self.words {
+            h = (h ^ word) &* 0x100000001b3
+        }
+        return Int(truncatingIfNeeded: h)
+    }
+
+    static func ==(lhs: PauliKey, rhs: PauliKey) -> Bool {
+        return lhs.words == rhs.words
+    }
+}
+
+/**
+ Sum of Pauli terms, each Pauli kept once with the sum of its coefficients,
+ in the order it was first added. Adding a term is a hash lookup, and
+ terms that cancel are only pruned when the list is taken.
+ */
+struct PauliAccumulator {
+
+    private var indexes: [PauliKey:Int] = [:]
+    private var terms: [(Complex,Pauli)] = []
+
+    var count: Int {
+        return self.terms.count
+    }
+
+    /**
+     Add coeff to the coefficient of pauli. Terms with a coefficient
+     not above threshold are ignored, as they are in pauli_list.
+     */
+    mutating func add(_ coeff: Complex, _ pauli: Pauli, _ threshold: Double) {
+        if coeff.absolute() <= threshold {
+            return
+        }
+        let key = PauliKey(pauli)
+        if let index = self.indexes[key] {
+            self.terms[index].0 += coeff
+        }
+        else {
+            self.indexes[key] = self.terms.count
+            self.terms.append((coeff, pauli))
+        }
+    }
+
+    /**
+     Add every term of other, in its order.
+     */
+    mutating func add(_ other: PauliAccumulator) {
+        for (coeff, pauli) in other.terms {
+            self.add(coeff, pauli, -1.0)
+        }
+    }
+
+    /**
+     Return the terms whose coefficient is above threshold.
+     */
+    func pauli_list(_ threshold: Double) -> [(Complex,Pauli)] {
+        return self.terms.filter { $0.0.absolute() > threshold }
+    }
+}
@@ -60,6 +60,28 @@ public final class Optimization {
                                          _ max_trials: Int,
                                          _ save_steps: Int = 1,
                                          _ last_avg: Int = 1) throws -> (Double,[Double],[Double],[Double],[[Double]],[[Double]]) {
+        return try SPSA_optimization_batch({ $0.map(obj_fun) },
+                                           initial_theta,
+                                           SPSA_parameters,
+                                           max_trials,
+                                           save_steps,
+                                           last_avg)
+    }
+
+    /**
+     Same as SPSA_optimization, but obj_fun evaluates a batch of variables
+     at once and returns their values in the same order. Each trial step
+     hands the + and - directions to obj_fun together, so that both can be
+     run as one job (see eval_hamiltonian_batch). As eval_hamiltonian_batch
+     calls back on the main queue, an obj_fun waiting on it must not be
+     called from the main thread.
+     */
+    public static func SPSA_optimization_batch(_ obj_fun: ((_:[[Double]]) throws -> [Double]),
+                                               _ initial_theta: [Double],
+                                               _ SPSA_parameters: [Double],
+                                               _ max_trials: Int,
+                                               _ save_steps: Int = 1,
+                                               _ last_avg: Int = 1) throws -> (Double,[Double],[Double],[Double],[[Double]],[[Double]]) {
         let random = Random(time(nil))
         var theta_plus_save: [[Double]] = []
         var theta_minus_save: [[Double]] = []
@@ -80,8 +102,9 @@ public final class Optimization {
             let theta_plus = try theta.add(delta.mult(c_spsa))
             let theta_minus = try theta.subtract(delta.mult(c_spsa))
             // cost fuction for the two directions
-            let cost_plus = obj_fun(theta_plus.value)
-            let cost_minus = obj_fun(theta_minus.value)
+            let costs = try evaluate_batch(obj_fun, [theta_plus.value, theta_minus.value])
+            let cost_plus = costs[0]
+            let cost_minus = costs[1]
             // derivative estimate
             let g_spsa = delta.mult(cost_plus - cost_minus).div(2.0 * c_spsa)
             // updated theta
@@ -102,7 +125,7 @@ public final class Optimization {
             }
         }
         // final cost update
-        let cost_final = obj_fun(theta_best.value)
+        let cost_final = try evaluate_batch(obj_fun, [theta_best.value])[0]
         SDKLogger.logInfo("Final objective function is: \(cost_final)")
         return (cost_final, theta_best.value, cost_plus_save, cost_minus_save,
                 theta_plus_save, theta_minus_save)
@@ -127,6 +150,24 @@ public final class Optimization {
                                         _ initial_c: Double,
                                         _ target_update: Double,
                                         _ stat: Int) throws -> [Double] {
+        return try SPSA_calibration_batch({ $0.map(obj_fun) },
+                                          initial_theta,
+                                          initial_c,
+                                          target_update,
+                                          stat)
+    }
+
+    /**
+     Same as SPSA_calibration, but obj_fun evaluates a batch of variables
+     at once and returns their values in the same order. The + and -
+     perturbations of all stat directions are handed to obj_fun in a single
+     batch, ordered as plus_0, minus_0, plus_1, minus_1, ...
+     */
+    public static func SPSA_calibration_batch(_ obj_fun: ((_:[[Double]]) throws -> [Double]),
+                                              _ initial_theta: [Double],
+                                              _ initial_c: Double,
+                                              _ target_update: Double,
+                                              _ stat: Int) throws -> [Double] {
         let random = Random(time(nil))
         var SPSA_parameters = Array<Double>(repeating:0.0, count: 5)
         SPSA_parameters[1] = initial_c
@@ -134,19 +175,21 @@ public final class Optimization {
         SPSA_parameters[3] = 0.101
         SPSA_parameters[4] = 0
         let theta = Vector<Double>(value:initial_theta)
-        var delta_obj: Double = 0
-        for i in 0..<stat {
-            if i % 5 == 0 {
-                SDKLogger.logInfo("calibration step # \(i) of \(stat)")
-            }
+        var thetas: [[Double]] = []
+        for _ in 0..<stat {
             var arr = Vector<Double>(repeating: 0, count: initial_theta.count)
             for i in 0..<arr.count {
                 arr[i] = Double(random.randint(0, 2))
             }
             let delta = arr.mult(2).subtract(1)
-            let obj_plus = obj_fun(try theta.add(delta.mult(initial_c)).value)
-            let obj_minus = obj_fun(try theta.subtract(delta.mult(initial_c)).value)
-            delta_obj += abs(obj_plus - obj_minus) / Double(stat)
+            thetas.append(try theta.add(delta.mult(initial_c)).value)
+            thetas.append(try theta.subtract(delta.mult(initial_c)).value)
+        }
+        SDKLogger.logInfo("calibration: evaluating \(stat) directions")
+        let objs = try evaluate_batch(obj_fun, thetas)
+        var delta_obj: Double = 0
+        for i in 0..<stat {
+            delta_obj += abs(objs[2 * i] - objs[2 * i + 1]) / Double(stat)
         }
         SPSA_parameters[0] = target_update * 2 / delta_obj * SPSA_parameters[1] * (SPSA_parameters[4] + 1)
 
@@ -155,6 +198,19 @@ public final class Optimization {
         return SPSA_parameters
     }
 
+    /**
+     Calls the batch objective function, checking that it returned one
+     value per variable set.
+     */
+    private static func evaluate_batch(_ obj_fun: ((_:[[Double]]) throws -> [Double]),
+                                       _ thetas: [[Double]]) throws -> [Double] {
+        let values = try obj_fun(thetas)
+        if values.count != thetas.count {
+            throw ToolsError.batchSize(expected: thetas.count, received: values.count)
+        }
+        return values
+    }
+
     /**
      Compute the expectation value of Z.
 
@@ -168,6 +224,10 @@ public final class Optimization {
         Expected value of pauli given data
      */
     public static func measure_pauli_z(_ data: [String: Int], _ pauli: Pauli) -> Double {
+        if let histogram = CountHistogram(data),
+            let mask = z_mask(pauli, histogram) {
+            return histogram.z_parities([mask])[0]
+        }
         var observable: Double = 0.0
         let tot = Double(data.values.reduce(0, {$0 + $1}))
         for (key,dataValue) in data {
@@ -195,6 +255,23 @@ public final class Optimization {
         The expectation value
      */
     public static func Energy_Estimate(_ data: [String: Int], _ pauli_list: [(Double,Pauli)]) -> Double {
+        // All the Paulis are averaged in one pass over the counts
+        if let histogram = CountHistogram(data) {
+            var masks: [Int] = []
+            for p in pauli_list {
+                guard let mask = z_mask(p.1, histogram) else {
+                    break
+                }
+                masks.append(mask)
+            }
+            if masks.count == pauli_list.count {
+                var energy: Double = 0
+                for (p, parity) in zip(pauli_list, histogram.z_parities(masks)) {
+                    energy += p.0 * parity
+                }
+                return energy
+            }
+        }
         var energy: Double = 0
         for p in pauli_list {
             energy += p.0 * measure_pauli_z(data, p.1)
@@ -202,6 +279,23 @@ public final class Optimization {
         return energy
     }
 
+    /**
+     Mask of the bits of the histogram outcomes on which pauli acts, bit j
+     for qubit j, or nil if the outcomes are not single bit strings of one
+     bit per qubit.
+     */
+    private static func z_mask(_ pauli: Pauli, _ histogram: CountHistogram) -> Int? {
+        if histogram.register_sizes.count > 1 ||
+            (!histogram.states.isEmpty && histogram.number_of_bits != pauli.numberofqubits) {
+            return nil
+        }
+        var mask = 0
+        for j in 0..<pauli.numberofqubits where pauli.v[j] == 1 || pauli.w[j] == 1 {
+            mask |= 1 << j
+        }
+        return mask
+    }
+
     /**
      Returns bit string corresponding to quantum state index
 
@@ -316,10 +410,43 @@ public final class Optimization {
                                         _ callback: @escaping ((_:Complex, _:Error?) -> Void)) -> RequestTask {
         return eval_hamiltonianInternal(Q_program,
                                         hamiltonian,
-                                        input_circuit,
+                                        [input_circuit],
+                                        shots,
+                                        device) { (ret,error) in
+            CompletionExecutor.shared.execute {
+                callback(ret.first ?? 0.0,error)
+            }
+        }
+    }
+
+    /**
+     Calculates the average value of a Hamiltonian on the state created by
+     each of the input circuits. The circuits of all inputs are run
+     together as a single job.
+
+     Args:
+        Q_program : QuantumProgram object used to run the imput circuits.
+        hamiltonian : same as in eval_hamiltonian.
+        input_circuits : the circuits preparing the states to average on.
+        shots (int) : number of shots considered in the averaging. If 1 the
+            averaging is exact.
+        device : the backend used to run the simulation.
+     Returns:
+        Average values of the Hamiltonian or observable, one per input
+        circuit.
+     */
+    public static func eval_hamiltonian_batch(_ Q_program: QuantumProgram,
+                                              _ hamiltonian: Any,
+                                              _ input_circuits: [QuantumCircuit],
+                                              _ shots: Int,
+                                              _ device: String,
+                                              _ callback: @escaping ((_:[Complex], _:Error?) -> Void)) -> RequestTask {
+        return eval_hamiltonianInternal(Q_program,
+                                        hamiltonian,
+                                        input_circuits,
                                         shots,
                                         device) { (ret,error) in
-            DispatchQueue.main.async {
+            CompletionExecutor.shared.execute {
                 callback(ret,error)
             }
         }
@@ -327,164 +454,178 @@ public final class Optimization {
 
     private static func eval_hamiltonianInternal(_ Q_program: QuantumProgram,
                                                  _ hamiltonian: Any,
-                                                 _ input_circuit: QuantumCircuit,
+                                                 _ input_circuits: [QuantumCircuit],
                                                  _ shots: Int,
                                                  _ device: String,
-                                                 _ callback: @escaping ((_:Complex, _:Error?) -> Void)) -> RequestTask {
-        var energy: Complex = 0.0
+                                                 _ callback: @escaping ((_:[Complex], _:Error?) -> Void)) -> RequestTask {
+        var energies = [Complex](repeating: 0.0, count: input_circuits.count)
         var requestTask = RequestTask()
         do {
             if shots == 1 {
                 // Hamiltonian represented by a Pauli list
                 if let hamiltonianList = hamiltonian as? [(Double,Pauli)]  { // Hamiltonian represented by a Pauli list
-                    var circuits: [QuantumCircuit] = []
-                    var circuits_labels: [String] = []
-                    circuits.append(input_circuit)
-                    // Trial circuit w/o the final rotations
-                    circuits_labels.append("circuit_label0")
-                    try Q_program.add_circuit(circuits_labels[0], circuits[0])
-                    // Execute trial circuit with final rotations for each Pauli in
-                    // hamiltonian and store from circuits[1] on
-                    guard let n_qubits = input_circuit.regs["q"]?.size else {
-                        throw ToolsError.unknownHamiltonian
-                    }
-                    let q = try QuantumRegister("q", n_qubits)
-                    var i: Int = 1
-                    for p in hamiltonianList {
-                        circuits.append(input_circuit.copy())
-                        for j in 0..<n_qubits {
-                            if p.1.v[j] == 1 && p.1.w[j] == 0 {
-                                try circuits[i].x(q[j])
-                            }
-                            else if p.1.v[j] == 0 && p.1.w[j] == 1 {
-                                try circuits[i].z(q[j])
-                            }
-                            else if p.1.v[j] == 1 && p.1.w[j] == 1 {
-                                try circuits[i].y(q[j])
+                    var circuits_labels: [[String]] = []
+                    for (c, input_circuit) in input_circuits.enumerated() {
+                        var labels: [String] = []
+                        // Trial circuit w/o the final rotations
+                        labels.append("circuit_label\(c)_0")
+                        try Q_program.add_circuit(labels[0], input_circuit)
+                        // Execute trial circuit with final rotations for each Pauli in
+                        // hamiltonian and store from labels[1] on
+                        guard let n_qubits = input_circuit.regs["q"]?.size else {
+                            throw ToolsError.unknownHamiltonian
+                        }
+                        let q = try QuantumRegister("q", n_qubits)
+                        var i: Int = 1
+                        for p in hamiltonianList {
+                            let circuit = input_circuit.copy()
+                            for j in 0..<n_qubits {
+                                if p.1.v[j] == 1 && p.1.w[j] == 0 {
+                                    try circuit.x(q[j])
+                                }
+                                else if p.1.v[j] == 0 && p.1.w[j] == 1 {
+                                    try circuit.z(q[j])
+                                }
+                                else if p.1.v[j] == 1 && p.1.w[j] == 1 {
+                                    try circuit.y(q[j])
+                                }
                             }
+                            labels.append("circuit_label\(c)_\(i)")
+                            try Q_program.add_circuit(labels[i], circuit)
+                            i += 1
                         }
-                        circuits_labels.append("circuit_label\(i)")
-                        try Q_program.add_circuit(circuits_labels[i], circuits[i])
-                        i += 1
+                        circuits_labels.append(labels)
                     }
-                    requestTask = Q_program.execute(circuits_labels, backend: device, shots: shots) { (result) in
+                    requestTask = Q_program.execute(Array(circuits_labels.joined()), backend: device, shots: shots) { (result) in
                         if let error = result.get_error() {
-                            callback(energy,error)
+                            callback(energies,error)
                             return
                         }
                         do {
-                            // no Pauli final rotations
-                            if let q_0 = try result.get_data(circuits_labels[0])["quantum_state"] as? [Complex] {
-                                let quantum_state_0 = Vector<Complex>(value:q_0)
-                                i = 1
-                                for p in hamiltonianList {
-                                    if let q_i = try result.get_data(circuits_labels[i])["quantum_state"] as? [Complex] {
-                                        let quantum_state_i = Vector<Complex>(value:q_i)
-                                        // inner product with final rotations of (i-1)-th Pauli
-                                        energy += try quantum_state_0.conjugate().inner(quantum_state_i) * p.0
+                            for (c, labels) in circuits_labels.enumerated() {
+                                // no Pauli final rotations
+                                if let q_0 = try result.get_data(labels[0])["quantum_state"] as? [Complex] {
+                                    let quantum_state_0 = Vector<Complex>(value:q_0)
+                                    var i = 1
+                                    for p in hamiltonianList {
+                                        if let q_i = try result.get_data(labels[i])["quantum_state"] as? [Complex] {
+                                            let quantum_state_i = Vector<Complex>(value:q_i)
+                                            // inner product with final rotations of (i-1)-th Pauli
+                                            energies[c] += try quantum_state_0.conjugate().inner(quantum_state_i) * p.0
+                                        }
+                                        i += 1
                                     }
-                                    i += 1
                                 }
                             }
-                            callback(energy,nil)
+                            callback(energies,nil)
                         } catch {
-                            callback(energy,error)
+                            callback(energies,error)
                         }
                     }
                 }
                 else {
                     // Hamiltonian is not a pauli_list grouped into tpb sets
-                    var circuit = ["c"]
-                    try Q_program.add_circuit(circuit[0], input_circuit)
+                    var circuit: [String] = []
+                    for (c, input_circuit) in input_circuits.enumerated() {
+                        circuit.append("c\(c)")
+                        try Q_program.add_circuit(circuit[c], input_circuit)
+                    }
                     requestTask = Q_program.execute(circuit, backend: device, config: ["data": ["quantum_state"]], shots: shots) { (result) in
                         if let error = result.get_error() {
-                            callback(energy,error)
+                            callback(energies,error)
                             return
                         }
                         do {
-                            var quantum_state: Vector<Complex> = []
-                            if let q = try result.get_data(circuit[0])["quantum_state"] as? [Complex] {
-                                quantum_state = Vector<Complex>(value:q)
-                            }
-                            else {
-                                if let q = try result.get_data(circuit[0])["quantum_states"] as? [[Complex]] {
-                                    if q.count > 0 {
-                                        quantum_state = Vector<Complex>(value:q[0])
+                            for c in 0..<circuit.count {
+                                var quantum_state: Vector<Complex> = []
+                                if let q = try result.get_data(circuit[c])["quantum_state"] as? [Complex] {
+                                    quantum_state = Vector<Complex>(value:q)
+                                }
+                                else {
+                                    if let q = try result.get_data(circuit[c])["quantum_states"] as? [[Complex]] {
+                                        if q.count > 0 {
+                                            quantum_state = Vector<Complex>(value:q[0])
+                                        }
                                     }
                                 }
-                            }
 
-                            // Diagonal Hamiltonian represented by 1D array
-                            if let h = hamiltonian as? [Complex] {
-                                let hamiltonianVector = Vector<Complex>(value:h)
-                                energy = try hamiltonianVector.mult(Vector<Complex>(value:quantum_state.absolute()).power(2)).sum()
-                            }
-                            // Hamiltonian represented by square matrix
-                            else if let h = hamiltonian as? [[Complex]] {
-                                //TODO fix this hamiltonian calculation
-                                let hamiltonianMatrix = Matrix<Complex>(value:h)
-                                let m = Matrix<Complex>(value: [quantum_state.value])
-                                energy = try quantum_state.conjugate().inner(Vector<Complex>(value:hamiltonianMatrix.dot(m).value[0]))
-                            }
-                            else {
-                                callback(energy,ToolsError.unknownHamiltonian)
-                                return
+                                // Diagonal Hamiltonian represented by 1D array
+                                if let h = hamiltonian as? [Complex] {
+                                    let hamiltonianVector = Vector<Complex>(value:h)
+                                    energies[c] = try hamiltonianVector.mult(Vector<Complex>(value:quantum_state.absolute()).power(2)).sum()
+                                }
+                                // Hamiltonian represented by square matrix
+                                else if let h = hamiltonian as? [[Complex]] {
+                                    //TODO fix this hamiltonian calculation
+                                    let hamiltonianMatrix = Matrix<Complex>(value:h)
+                                    let m = Matrix<Complex>(value: [quantum_state.value])
+                                    energies[c] = try quantum_state.conjugate().inner(Vector<Complex>(value:hamiltonianMatrix.dot(m).value[0]))
+                                }
+                                else {
+                                    callback(energies,ToolsError.unknownHamiltonian)
+                                    return
+                                }
                             }
-                            callback(energy,nil)
+                            callback(energies,nil)
                         } catch {
-                            callback(energy,error)
+                            callback(energies,error)
                         }
                     }
                 }
             }
             else if let hamiltonianMatrix = hamiltonian as? [[(Double,Pauli)]] { // finite number of shots and hamiltonian grouped in tpb sets
-                var circuits: [QuantumCircuit] = []
-                var circuits_labels: [String] = []
+                var circuits_labels: [[String]] = []
                 let n = hamiltonianMatrix[0][0].1.v.count
                 let q = try QuantumRegister("q", n)
                 let c = try ClassicalRegister("c", n)
-                var i: Int = 0
-                for tpb_set in hamiltonianMatrix {
-                    circuits.append(input_circuit.copy())
-                    circuits_labels.append("tpb_circuit_\(i)")
-                    for j in 0..<n {
-                        // Measure X
-                        if tpb_set[0].1.v[j] == 0 && tpb_set[0].1.w[j] == 1 {
-                            try circuits[i].h(q[j])
-                        }
-                        // Measure Y
-                        else if tpb_set[0].1.v[j] == 1 && tpb_set[0].1.w[j] == 1 {
-                            try circuits[i].s(q[j]).inverse()
-                            try circuits[i].h(q[j])
+                for (b, input_circuit) in input_circuits.enumerated() {
+                    var labels: [String] = []
+                    var i: Int = 0
+                    for tpb_set in hamiltonianMatrix {
+                        let circuit = input_circuit.copy()
+                        labels.append("tpb_circuit_\(b)_\(i)")
+                        for j in 0..<n {
+                            // Measure X
+                            if tpb_set[0].1.v[j] == 0 && tpb_set[0].1.w[j] == 1 {
+                                try circuit.h(q[j])
+                            }
+                            // Measure Y
+                            else if tpb_set[0].1.v[j] == 1 && tpb_set[0].1.w[j] == 1 {
+                                try circuit.s(q[j]).inverse()
+                                try circuit.h(q[j])
+                            }
+                            try circuit.measure(q[j], c[j])
                         }
-                        try circuits[i].measure(q[j], c[j])
+                        try Q_program.add_circuit(labels[i], circuit)
+                        i += 1
                     }
-                    try Q_program.add_circuit(circuits_labels[i], circuits[i])
-                    i += 1
+                    circuits_labels.append(labels)
                 }
-                requestTask = Q_program.execute(circuits_labels, backend: device, shots: shots) { (result) in
+                requestTask = Q_program.execute(Array(circuits_labels.joined()), backend: device, shots: shots) { (result) in
                     if let error = result.get_error() {
-                        callback(energy,error)
+                        callback(energies,error)
                         return
                     }
                     do {
-                        for j in 0..<hamiltonianMatrix.count {
-                            for k in 0..<hamiltonianMatrix[j].count {
-                                energy +=
-                                    hamiltonianMatrix[j][k].0 * measure_pauli_z(try result.get_counts(circuits_labels[j]), hamiltonianMatrix[j][k].1)
+                        for (b, labels) in circuits_labels.enumerated() {
+                            for j in 0..<hamiltonianMatrix.count {
+                                for k in 0..<hamiltonianMatrix[j].count {
+                                    energies[b] +=
+                                        hamiltonianMatrix[j][k].0 * measure_pauli_z(try result.get_counts(labels[j]), hamiltonianMatrix[j][k].1)
+                                }
                             }
                         }
-                        callback(energy,nil)
+                        callback(energies,nil)
                     } catch {
-                        callback(energy,error)
+                        callback(energies,error)
                     }
                 }
             }
             else {
-                callback(energy,ToolsError.unknownHamiltonian)
+                callback(energies,ToolsError.unknownHamiltonian)
             }
         } catch {
-            callback(energy,error)
+            callback(energies,error)
         }
         return requestTask
     }
@@ -502,6 +643,9 @@ public final class Optimization {
          circuit
          measurement (bool) : whether to measure the qubit (register "q")
          on classical bits (register "c")
+         parameterized (bool) : whether to bind the rotation angles to the
+         circuit parameters named by trial_parameters, so that the compiled
+         circuit can be bound to a new theta without compiling it again
      Returns:
         A QuantumCircuit object
      */
@@ -510,7 +654,8 @@ public final class Optimization {
                                         _ theta: [Double],
                                         _ entangler_map: [Int:[Int]],
                                         _ meas_string: String? = nil,
-                                        _ measurement: Bool = true) throws -> QuantumCircuit {
+                                        _ measurement: Bool = true,
+                                        _ parameterized: Bool = false) throws -> QuantumCircuit {
         let q = try QuantumRegister("q", n)
         let c = try ClassicalRegister("c", n)
         let trial_circuit = try QuantumCircuit([q, c])
@@ -524,7 +669,10 @@ public final class Optimization {
                 }
             }
             for j in 0..<n {
-                try trial_circuit.ry(theta[n * i + j], q[j])
+                let ry = try trial_circuit.ry(theta[n * i + j], q[j])
+                if parameterized {
+                    try ry.parameterize(trial_parameter(n * i + j))
+                }
             }
         }
         try trial_circuit.barrier(q)
@@ -558,6 +706,9 @@ public final class Optimization {
          circuit
          measurement (bool) : whether to measure the qubit (register "q")
          on classical bits (register "c")
+         parameterized (bool) : whether to bind the rotation angles to the
+         circuit parameters named by trial_parameters, so that the compiled
+         circuit can be bound to a new theta without compiling it again
      Returns:
         A QuantumCircuit object
      */
@@ -566,7 +717,8 @@ public final class Optimization {
                                           _ theta: [Double],
                                           _ entangler_map: [Int:[Int]],
                                           _ meas_string: String? = nil,
-                                          _ measurement: Bool = true) throws -> QuantumCircuit {
+                                          _ measurement: Bool = true,
+                                          _ parameterized: Bool = false) throws -> QuantumCircuit {
         let q = try QuantumRegister("q", n)
         let c = try ClassicalRegister("c", n)
         let trial_circuit = try QuantumCircuit([q, c])
@@ -580,8 +732,12 @@ public final class Optimization {
                 }
             }
             for j in 0..<n {
-                try trial_circuit.ry(theta[n * i * 2 + 2 * j], q[j])
-                try trial_circuit.rz(theta[n * i * 2 + 2 * j + 1], q[j])
+                let ry = try trial_circuit.ry(theta[n * i * 2 + 2 * j], q[j])
+                let rz = try trial_circuit.rz(theta[n * i * 2 + 2 * j + 1], q[j])
+                if parameterized {
+                    try ry.parameterize(trial_parameter(n * i * 2 + 2 * j))
+                    try rz.parameterize(trial_parameter(n * i * 2 + 2 * j + 1))
+                }
             }
         }
         try trial_circuit.barrier(q)
@@ -602,6 +758,27 @@ public final class Optimization {
         return trial_circuit
     }
 
+    /**
+     Returns the name of the circuit parameter bound to theta[index] in the
+     parameterized trial circuits.
+     */
+    public static func trial_parameter(_ index: Int) -> String {
+        return "theta_\(index)"
+    }
+
+    /**
+     Returns the values of the trial circuit parameters for theta, to bind
+     a compiled parameterized trial circuit with
+     QuantumProgram.bind_parameters.
+     */
+    public static func trial_parameters(_ theta: [Double]) -> [String:Double] {
+        var values: [String:Double] = [:]
+        for (index, value) in theta.enumerated() {
+            values[trial_parameter(index)] = value
+        }
+        return values
+    }
+
     /**
      Creates a matrix operator out of a list of Paulis.
 
@@ -47,7 +47,7 @@ import Foundation
  */
 final class JsonBackend: UnrollerBackend {
 
-    private var circuit: [String:Any] = [:]
+    private var operations: [QobjOperation] = []
     private var _number_of_qubits: Int = 0
     private var _number_of_cbits: Int = 0
     private var _qubit_order: [RegBit] = []
@@ -68,8 +68,6 @@ final class JsonBackend: UnrollerBackend {
      The default basis is ["U", "CX"].
      */
     init(_ basis: [String] = []) {
-        self.circuit["operations"] = []
-        self.circuit["header"] = [:]
         // default, unroll to U, CX
         self.basis = basis
     }
@@ -102,13 +100,6 @@ final class JsonBackend: UnrollerBackend {
             self._qubit_order_internal[RegBit(name, j)] = self._number_of_qubits + j
         }
         self._number_of_qubits += size
-        var header: [String:Any] = [:]
-        if let head = self.circuit["header"] as? [String:Any] {
-            header = head
-        }
-        header["number_of_qubits"] = self._number_of_qubits
-        header["qubit_labels"] = self._qubit_order.map { [$0.name,$0.index] }
-        self.circuit["header"] = header
     }
 
     /**
@@ -124,13 +115,6 @@ final class JsonBackend: UnrollerBackend {
             self._cbit_order_internal[RegBit(name, j)] = self._number_of_cbits + j
         }
         self._number_of_cbits += size
-        var header: [String:Any] = [:]
-        if let head = self.circuit["header"] as? [String:Any] {
-            header = head
-        }
-        header["number_of_clbits"] = self._number_of_cbits
-        header["clbit_labels"] = self._cbit_order.map { [$0.name,$0.index] }
-        self.circuit["header"] = header
     }
 
     /**
@@ -156,18 +140,10 @@ final class JsonBackend: UnrollerBackend {
                 self.basis.append("U")
             }
             let qubit_indices: [Int] =  [self._qubit_order_internal[qubit]!]
-            var operations: [[String:Any]] = []
-            if let oper = self.circuit["operations"] as? [[String:Any]] {
-                operations = oper
-            }
-            var operation: [String:Any] = [:]
-            operation["name"] = "U"
-            operation["params"] = [try arg.0.real(nested_scope).value,
-                                   try arg.1.real(nested_scope).value,
-                                   try arg.2.real(nested_scope).value]
-            operation["qubits"] = qubit_indices
-            operations.append(operation)
-            self.circuit["operations"] = operations
+            let params: [Double] = [try arg.0.real(nested_scope).value,
+                                    try arg.1.real(nested_scope).value,
+                                    try arg.2.real(nested_scope).value]
+            self.operations.append(QobjOperation("U", params: params, qubits: qubit_indices))
             self._add_condition()
         }
     }
@@ -179,25 +155,17 @@ final class JsonBackend: UnrollerBackend {
     private func _add_condition() {
         if self.creg != nil {
             var mask: Int = 0
-            var conditional: [String:Any] = [:]
             for (cbit, index) in self._cbit_order_internal {
                 if cbit.name == self.creg! {
                     mask |= (1 << index)
                 }
-                // Would be nicer to zero pad the mask, but we
-                // need to know the total number of cbits.
-                // format_spec = "{0:#0{%d}X}" % number_of_clbits
-                // format_spec.format(mask)
-                conditional["type"] = "equals"
-                conditional["mask"] = String(format: "0x%X", mask)
-                conditional["val"] = String(format: "0x%X", self.cval!)
             }
-            if var operations = self.circuit["operations"] as? [[String:Any]] {
-                if var operation = operations.last {
-                    operation["conditional"] = conditional
-                    operations[operations.count-1] = operation
-                    self.circuit["operations"] = operations
-                }
+            // Would be nicer to zero pad the mask, but we
+            // need to know the total number of cbits.
+            // format_spec = "{0:#0{%d}X}" % number_of_clbits
+            // format_spec.format(mask)
+            if !self.operations.isEmpty {
+                self.operations[self.operations.count-1].conditional = QobjConditional(mask: mask, val: self.cval!)
             }
         }
     }
@@ -212,16 +180,8 @@ final class JsonBackend: UnrollerBackend {
             if !self.basis.contains("CX") {
                 self.basis.append("CX")
             }
-           let qubit_indices: [Int] =  [self._qubit_order_internal[qubit0]!,self._qubit_order_internal[qubit1]!]
-            var operations: [[String:Any]] = []
-            if let oper = self.circuit["operations"] as? [[String:Any]] {
-                operations = oper
-            }
-            var operation: [String:Any] = [:]
-            operation["name"] = "CX"
-            operation["qubits"] = qubit_indices
-            operations.append(operation)
-            self.circuit["operations"] = operations
+            let qubit_indices: [Int] =  [self._qubit_order_internal[qubit0]!,self._qubit_order_internal[qubit1]!]
+            self.operations.append(QobjOperation("CX", qubits: qubit_indices))
             self._add_condition()
         }
     }
@@ -238,16 +198,7 @@ final class JsonBackend: UnrollerBackend {
             }
             let qubit_indices: [Int] =  [self._qubit_order_internal[qubit]!]
             let clbit_indices: [Int] =  [self._cbit_order_internal[bit]!]
-            var operations: [[String:Any]] = []
-            if let oper = self.circuit["operations"] as? [[String:Any]] {
-                operations = oper
-            }
-            var operation: [String:Any] = [:]
-            operation["name"] = "measure"
-            operation["qubits"] = qubit_indices
-            operation["clbits"] = clbit_indices
-            operations.append(operation)
-            self.circuit["operations"] = operations
+            self.operations.append(QobjOperation("measure", qubits: qubit_indices, clbits: clbit_indices))
             self._add_condition()
         }
     }
@@ -267,15 +218,7 @@ final class JsonBackend: UnrollerBackend {
                     qubit_indices.append(self._qubit_order_internal[qubits]!)
                 }
             }
-            var operations: [[String:Any]] = []
-            if let oper = self.circuit["operations"] as? [[String:Any]] {
-                operations = oper
-            }
-            var operation: [String:Any] = [:]
-            operation["name"] = "barrier"
-            operation["qubits"] = qubit_indices
-            operations.append(operation)
-            self.circuit["operations"] = operations
+            self.operations.append(QobjOperation("barrier", qubits: qubit_indices))
             // no conditions on barrier, even when it appears
             // in body of conditioned gate
         }
@@ -291,15 +234,7 @@ final class JsonBackend: UnrollerBackend {
                 self.basis.append("reset")
             }
             let qubit_indices: [Int] =  [self._qubit_order_internal[qubit]!]
-            var operations: [[String:Any]] = []
-            if let oper = self.circuit["operations"] as? [[String:Any]] {
-                operations = oper
-            }
-            var operation: [String:Any] = [:]
-            operation["name"] = "reset"
-            operation["qubits"] = qubit_indices
-            operations.append(operation)
-            self.circuit["operations"] = operations
+            self.operations.append(QobjOperation("reset", qubits: qubit_indices))
             self._add_condition()
         }
     }
@@ -346,20 +281,11 @@ final class JsonBackend: UnrollerBackend {
             for qubit in qubits {
                 qubit_indices.append(self._qubit_order_internal[qubit]!)
             }
-            var operations: [[String:Any]] = []
-            if let oper = self.circuit["operations"] as? [[String:Any]] {
-                operations = oper
-            }
-            var operation: [String:Any] = [:]
-            operation["name"] = name
             var params: [Double] = []
             for arg in args {
                 params.append(try arg.real(nested_scope).value)
             }
-            operation["params"] = params
-            operation["qubits"] = qubit_indices
-            operations.append(operation)
-            self.circuit["operations"] = operations
+            self.operations.append(QobjOperation(name, params: params, qubits: qubit_indices))
             self._add_condition()
         }
     }
@@ -384,23 +310,34 @@ final class JsonBackend: UnrollerBackend {
      Returns the generated circuit.
      */
     func get_output() throws -> Any? {
-        assert(self._is_circuit_valid(), "Invalid circuit! Has the Qasm parsing been called?. e.g: unroller.execute()")
-        if JSONSerialization.isValidJSONObject(self.circuit) {
-            return self.circuit
+        let circuit = self.get_compiled_circuit().dictionary
+        if JSONSerialization.isValidJSONObject(circuit) {
+            return circuit
         }
         throw UnrollerError.invalidJSON
     }
 
     /**
-     Checks whether the circuit object is a valid one or not.
+     Returns the generated circuit as a typed qobj compiled circuit.
      */
-    private func _is_circuit_valid() -> Bool {
-        guard let header = self.circuit["header"] as? [String:Any] else {
-            return false
+    func get_compiled_circuit() -> QobjCompiledCircuit {
+        assert(self._is_circuit_valid(), "Invalid circuit! Has the Qasm parsing been called?. e.g: unroller.execute()")
+        var header = QobjHeader(qubit_labels: nil, clbit_labels: nil)
+        if !self._qubit_order.isEmpty {
+            header.number_of_qubits = self._number_of_qubits
+            header.qubit_labels = self._qubit_order
         }
-        guard let operations = self.circuit["operations"] as? [[String:Any]] else {
-            return false
+        if !self._cbit_order.isEmpty {
+            header.number_of_clbits = self._number_of_cbits
+            header.clbit_labels = self._cbit_order
         }
-        return !header.isEmpty && !operations.isEmpty
+        return QobjCompiledCircuit(header: header, operations: self.operations)
+    }
+
+    /**
+     Checks whether the circuit object is a valid one or not.
+     */
+    private func _is_circuit_valid() -> Bool {
+        return !(self._qubit_order.isEmpty && self._cbit_order.isEmpty) && !self.operations.isEmpty
     }
 }
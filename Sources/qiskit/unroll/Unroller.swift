@@ -34,6 +34,27 @@ final class ProcessNodesReturn {
     }
 }
 
+/**
+ Gate body unrolled once into operations on parameter and qubit slots.
+ Parameters are expressions compiled against the gate arguments and qubits
+ are indices into the gate bits.
+ */
+private final class GateTemplate {
+
+    enum Operation {
+        case u([CompiledRealValue], Int)
+        case cx(Int, Int)
+        case barrier([[Int]])
+        case gate(String, GateTemplate?, [CompiledRealValue], [Int])
+    }
+
+    let operations: [Operation]
+
+    init(_ operations: [Operation]) {
+        self.operations = operations
+    }
+}
+
 /**
  OPENQASM interpreter object that unrolls subroutines and loops.
  */
@@ -72,22 +93,39 @@ final class Unroller {
      */
     private var gates: [String:GateData] = [:]
     /**
-     List of dictionaries mapping local parameter ids to expression Nodes
+     Dict of gate names and their unrolled bodies
      */
-    private var arg_stack: Stack<[String:NodeRealValue]> = Stack<[String:NodeRealValue]>()
+    private var templates: [String:GateTemplate] = [:]
     /**
-     List of dictionaries mapping local bit ids to global ids (name,idx)
+     Scope of the circuit parameters, the ids that may appear in the
+     arguments of top level gates. nil if the circuit has none.
      */
-    private var bit_stack: Stack<[String:RegBit]> = Stack<[String:RegBit]>()
+    private let parameter_scope: [[String:NodeRealValue]]?
 
     /**
      Initialize interpreter's data.
+     parameters are the circuit parameters with their values. Their ids
+     evaluate to symbolic values that keep the parameter name.
      */
-    init(_ ast: NodeMainProgram, _ backend: UnrollerBackend? = nil, _ precision: Int = 15, _ filename: String? = nil) {
+    init(_ ast: NodeMainProgram,
+         _ backend: UnrollerBackend? = nil,
+         _ precision: Int = 15,
+         _ filename: String? = nil,
+         parameters: [String:Double] = [:]) {
         self.ast = ast
         self.backend = backend
         self.precision = precision
         self.filename = filename ?? ""
+        if parameters.isEmpty {
+            self.parameter_scope = nil
+        }
+        else {
+            var scope: [String:NodeRealValue] = [:]
+            for (name, value) in parameters {
+                scope[name] = NodeReal(SymbolicValue(parameter: name, value: value))
+            }
+            self.parameter_scope = [scope]
+        }
     }
 
     /**
@@ -102,35 +140,138 @@ final class Unroller {
         }
         if let node = n as? NodeId {
             // A qubit or qreg or creg
-            var bits: [String:RegBit] = [:]
-            if let map = self.bit_stack.peek() {
-                bits = map
+            if let size = self.qregs[node.name] {
+                var array: [RegBit] = []
+                for j in 0..<size {
+                    array.append(RegBit(node.name,j))
+                }
+                return array
             }
-            if bits.isEmpty {
-                // Global scope
-                if let size = self.qregs[node.name] {
-                    var array: [RegBit] = []
-                    for j in 0..<size {
-                        array.append(RegBit(node.name,j))
-                    }
-                    return array
+            if let size = self.cregs[node.name] {
+                var array: [RegBit] = []
+                for j in 0..<size {
+                    array.append(RegBit(node.name,j))
+                }
+                return array
+            }
+            throw UnrollerError.errorRegName(qasm: node.qasm(self.precision))
+        }
+        return []
+    }
+
+    /**
+     Process a local bit id of a gate body as a slot of the gate bits.
+     */
+    private func _process_bit_slot(_ n: Node, _ bit_slots: [String:Int]) throws -> Int {
+        if let node = n as? NodeId {
+            if let slot = bit_slots[node.name] {
+                return slot
+            }
+        }
+        throw UnrollerError.errorLocalBit(qasm: n.qasm(self.precision))
+    }
+
+    /**
+     Return the unrolled body of a gate, building it on first use.
+     Nested gates keep their own template so that the backend still sees
+     every start_gate and end_gate and decides which ones to expand.
+     */
+    private func _gate_template(_ name: String, _ gate: GateData) throws -> GateTemplate? {
+        if gate.opaque || gate.body == nil {
+            return nil
+        }
+        if let template = self.templates[name] {
+            return template
+        }
+        var slots: [String:Int] = [:]
+        for (j, garg) in gate.args.enumerated() {
+            slots[garg] = j
+        }
+        var bit_slots: [String:Int] = [:]
+        for (j, gbit) in gate.bits.enumerated() {
+            bit_slots[gbit] = j
+        }
+        var operations: [GateTemplate.Operation] = []
+        for node in gate.body!.children {
+            switch node.type {
+            case .N_UNIVERSALUNITARY:
+                let unode = node as! NodeUniversalUnitary
+                let args = try self._process_node(unode.explist).nodes
+                if args.count >= 3 {
+                    operations.append(.u([try args[0].compile(slots),
+                                          try args[1].compile(slots),
+                                          try args[2].compile(slots)],
+                                         try self._process_bit_slot(unode.indexedid, bit_slots)))
+                }
+            case .N_CNOT:
+                let cnode = node as! NodeCnot
+                operations.append(.cx(try self._process_bit_slot(cnode.arg1, bit_slots),
+                                      try self._process_bit_slot(cnode.arg2, bit_slots)))
+            case .N_BARRIER:
+                var bits: [[Int]] = []
+                for child in node.children[0].children {
+                    bits.append([try self._process_bit_slot(child, bit_slots)])
                 }
-                if let size = self.cregs[node.name] {
-                    var array: [RegBit] = []
-                    for j in 0..<size {
-                        array.append(RegBit(node.name,j))
+                operations.append(.barrier(bits))
+            case .N_CUSTOMUNITARY:
+                let cnode = node as! NodeCustomUnitary
+                guard let inner = self.gates[cnode.name] else {
+                    throw UnrollerError.errorUndefinedGate(qasm: cnode.qasm(self.precision))
+                }
+                var args: [CompiledRealValue] = []
+                if let list = cnode.arguments {
+                    for arg in try self._process_node(list).nodes {
+                        args.append(try arg.compile(slots))
                     }
-                    return array
                 }
-                throw UnrollerError.errorRegName(qasm: node.qasm(self.precision))
+                var bits: [Int] = []
+                for child in cnode.bitlist.children {
+                    bits.append(try self._process_bit_slot(child, bit_slots))
+                }
+                operations.append(.gate(cnode.name, try self._gate_template(cnode.name, inner), args, bits))
+            default:
+                throw UnrollerError.errorType(type: node.type.rawValue, qasm: node.qasm(self.precision))
             }
-            // local scope
-            if let regBit = bits[node.name] {
-                return [regBit]
+        }
+        let template = GateTemplate(operations)
+        self.templates[name] = template
+        return template
+    }
+
+    /**
+     Emit a gate and its unrolled body to the backend.
+     values are the gate arguments, qubits the gate bits.
+     */
+    private func _emit_gate(_ backend: UnrollerBackend,
+                            _ name: String,
+                            _ template: GateTemplate?,
+                            _ values: [SymbolicValue],
+                            _ qubits: [RegBit]) throws {
+        let args: [NodeRealValue] = values.map { NodeReal($0) }
+        try backend.start_gate(name,args,qubits,nil)
+        if let operations = template?.operations {
+            for operation in operations {
+                switch operation {
+                case .u(let params, let qubit):
+                    let arg: (NodeRealValue, NodeRealValue, NodeRealValue) =
+                        (NodeReal(try params[0](values)),
+                         NodeReal(try params[1](values)),
+                         NodeReal(try params[2](values)))
+                    try backend.u(arg, qubits[qubit], nil)
+                case .cx(let qubit0, let qubit1):
+                    try backend.cx(qubits[qubit0], qubits[qubit1])
+                case .barrier(let bits):
+                    try backend.barrier(bits.map { $0.map { qubits[$0] } })
+                case .gate(let inner, let innerTemplate, let params, let bits):
+                    var innerValues: [SymbolicValue] = []
+                    for param in params {
+                        innerValues.append(try param(values))
+                    }
+                    try self._emit_gate(backend, inner, innerTemplate, innerValues, bits.map { qubits[$0] })
+                }
             }
-            throw UnrollerError.errorLocalBit(qasm: node.qasm(self.precision))
         }
-        return []
+        try backend.end_gate(name,args,qubits,nil)
     }
 
     /**
@@ -153,58 +294,24 @@ final class Unroller {
         }
 
         if let gate = self.gates[name] {
-            let gargs = gate.args
-            let gbits = gate.bits
-            let gbody = gate.body
+            // Arguments are evaluated once and bound by position
+            // to the gate parameters.
+            var values: [SymbolicValue] = []
+            for j in 0..<gate.args.count {
+                values.append(try args[j].real(self.parameter_scope))
+            }
+            let template = try self._gate_template(name, gate)
             // Loop over register arguments, if any.
             for idx in 0..<maxidx {
-                var map: [String:NodeRealValue] = [:]
-                for (j, garg) in gargs.enumerated() {
-                    map[garg] = args[j]
-                }
-                self.arg_stack.push(map)
                 // Only index into register arguments.
-                var element: [Int] = []
-                for bitList in bits {
-                    let condition = bitList.count > 1 ? 1 : 0
-                    element.append(idx * condition)
-                }
-                var regBitMap: [String:RegBit] = [:]
-                for (j, gbit) in gbits.enumerated() {
-                    regBitMap[gbit] = bits[j][element[j]]
-                }
-                self.bit_stack.push(regBitMap)
-                var args: [NodeRealValue] = []
-                if let map = self.arg_stack.peek() {
-                    for s in gargs {
-                        if let value = map[s] {
-                            args.append(value)
-                        }
-                    }
-                }
                 var qubits: [RegBit] = []
-                if let map = self.bit_stack.peek() {
-                    for s in gbits {
-                        if let value = map[s] {
-                            qubits.append(value)
-                        }
-                    }
-                }
-                if let backend = self.backend {
-                    let endIndex: Int = self.arg_stack.items.count - 1
-                    let array = Array(self.arg_stack.items[0..<endIndex])
-                    try backend.start_gate(name,args,qubits,array)
-                }
-                if !gate.opaque && gbody != nil {
-                    try self._process_children(gbody!)
+                for j in 0..<gate.bits.count {
+                    let condition = bits[j].count > 1 ? 1 : 0
+                    qubits.append(bits[j][idx * condition])
                 }
                 if let backend = self.backend {
-                    let endIndex: Int = self.arg_stack.items.count - 1
-                    let array = Array(self.arg_stack.items[0..<endIndex])
-                    try backend.end_gate(name,args,qubits,array)
+                    try self._emit_gate(backend, name, template, values, qubits)
                 }
-                self.arg_stack.pop()
-                self.bit_stack.pop()
             }
             return
         }
@@ -239,6 +346,7 @@ final class Unroller {
         let body: NodeGateBody? = node.body as? NodeGateBody
         let gatedata = GateData(false, n_args, n_bits, args, bits, body)
         self.gates[node.name] = gatedata
+        self.templates.removeAll()
         if let backend = self.backend {
             try backend.define_gate(node.name, gatedata)
         }        
@@ -266,6 +374,7 @@ final class Unroller {
 
         let gatedata = GateData(true, n_args, n_bits, args, bits, nil)
         self.gates[node.name] = gatedata
+        self.templates.removeAll()
         if let backend = self.backend {
             try backend.define_gate(node.name, gatedata)
         }
@@ -384,9 +493,13 @@ final class Unroller {
             let unode = node as! NodeUniversalUnitary
             let args = try self._process_node(unode.explist).nodes
             if args.count >= 3 {
+                let arg: (NodeRealValue, NodeRealValue, NodeRealValue) =
+                    (NodeReal(try args[0].real(self.parameter_scope)),
+                     NodeReal(try args[1].real(self.parameter_scope)),
+                     NodeReal(try args[2].real(self.parameter_scope)))
                 let qid = try self._process_bit_id(unode.indexedid)
                 for element in qid {
-                    try self.backend!.u((args[0], args[1], args[2]), element, self.arg_stack.items)
+                    try self.backend!.u(arg, element, nil)
                 }
             }
         case .N_CNOT:
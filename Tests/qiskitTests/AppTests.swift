@@ -22,7 +22,9 @@ import XCTest
 class QuantumOptimizationTests: XCTestCase {
 
     static let allTests = [
-        ("test_trial_functions",test_trial_functions)
+        ("test_trial_functions",test_trial_functions),
+        ("test_parameterized_trial_circuit",test_parameterized_trial_circuit),
+        ("test_SPSA_batch",test_SPSA_batch)
     ]
 
     override func setUp() {
@@ -61,12 +63,101 @@ class QuantumOptimizationTests: XCTestCase {
             XCTFail("test_trial_functions: \(error)")
         }
     }
+
+    func test_parameterized_trial_circuit() {
+        do {
+            let entangler_map: [Int: [Int]] = [0: [1], 1: [2]]
+            let m = 2
+            let n = 3
+            let theta = (0..<(2 * m * n)).map { 0.1 * Double($0 + 1) }
+            let theta2 = (0..<(2 * m * n)).map { -0.2 * Double($0 + 1) }
+
+            let trial_circuit = try Optimization.trial_circuit_ryrz(n, m, theta, entangler_map, nil, true, true)
+            XCTAssertEqual(trial_circuit.parameters.count, 2 * m * n)
+            XCTAssertEqual(trial_circuit.parameters[Optimization.trial_parameter(1)], theta[1])
+            XCTAssertFalse(trial_circuit.qasm().contains(Optimization.trial_parameter(0)))
+            XCTAssertTrue(trial_circuit._qasm(symbolic: true).contains("ry(\(Optimization.trial_parameter(0))) q[0];"))
+
+            var parameters: [String:Double] = [:]
+            for (name, value) in trial_circuit.parameters {
+                parameters[name] = value
+            }
+            var template = try OpenQuantumCompiler.compile(trial_circuit._qasm(symbolic: true), format: "json",
+                                                           parameters: parameters, cache: nil).json!
+            XCTAssertEqual(template.parameters?.count, 2 * m * n)
+            try template.bind(Optimization.trial_parameters(theta2))
+
+            let expected_circuit = try Optimization.trial_circuit_ryrz(n, m, theta2, entangler_map, nil, true)
+            let expected = try OpenQuantumCompiler.compile(expected_circuit.qasm(), format: "json", cache: nil).json!
+            XCTAssertEqual(template.operations.count, expected.operations.count)
+            for (operation, expected_operation) in zip(template.operations, expected.operations) {
+                XCTAssertEqual(operation.name, expected_operation.name)
+                XCTAssertEqual(operation.qubits, expected_operation.qubits)
+                XCTAssertEqual(operation.params?.count, expected_operation.params?.count)
+                for (param, expected_param) in zip(operation.params ?? [], expected_operation.params ?? []) {
+                    XCTAssertEqual(param, expected_param, accuracy: 1e-12)
+                }
+            }
+
+            // Mapping and optimization keep every rotation bound
+            let mapped = try OpenQuantumCompiler.compile(trial_circuit._qasm(symbolic: true), coupling_map: [0: [1], 1: [2]],
+                                                         format: "json", parameters: parameters, cache: nil).json!
+            XCTAssertEqual(mapped.parameters?.count, 2 * m * n)
+
+            // params that are not affine in their parameter cannot be bound
+            let qasm = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[1];\nu1(sin(phi)) q[0];\nu1(2*phi+1) q[0];\n"
+            var untracked = try OpenQuantumCompiler.compile(qasm, format: "json", parameters: ["phi": 0.5]).json!
+            XCTAssertEqual(untracked.untracked ?? [], ["phi"])
+            XCTAssertEqual(untracked.parameters?.count, 1)
+            XCTAssertThrowsError(try untracked.bind(["phi": 0.1])) { (error) in
+                guard case QISKitError.parameterNotBindable(let name) = error else {
+                    XCTFail("test_parameterized_trial_circuit: \(error)")
+                    return
+                }
+                XCTAssertEqual(name, "phi")
+            }
+        } catch {
+            XCTFail("test_parameterized_trial_circuit: \(error)")
+        }
+    }
+
+    func test_SPSA_batch() {
+        do {
+            var batch_sizes: [Int] = []
+            let obj_fun = { (thetas: [[Double]]) -> [Double] in
+                batch_sizes.append(thetas.count)
+                return thetas.map { $0.reduce(0.0) { $0 + $1 * $1 } }
+            }
+            let initial_theta = [1.0, -0.5, 0.25]
+
+            // Calibration evaluates every direction in a single batch
+            let SPSA_parameters = try Optimization.SPSA_calibration_batch(obj_fun, initial_theta, 0.1, 0.1, 10)
+            XCTAssertEqual(batch_sizes, [20])
+            XCTAssertGreaterThan(SPSA_parameters[0], 0.0)
+
+            // Each trial step evaluates both directions in one batch
+            batch_sizes = []
+            let max_trials = 20
+            let result = try Optimization.SPSA_optimization_batch(obj_fun, initial_theta, SPSA_parameters, max_trials)
+            XCTAssertEqual(batch_sizes, [Int](repeating: 2, count: max_trials) + [1])
+            XCTAssertEqual(result.2.count, max_trials)
+            XCTAssertEqual(result.3.count, max_trials)
+
+            // The batch has to return one value per variable set
+            XCTAssertThrowsError(try Optimization.SPSA_calibration_batch({ _ in [0.0] }, initial_theta, 0.1, 0.1, 2))
+        } catch {
+            XCTFail("test_SPSA_batch: \(error)")
+        }
+    }
 }
 
 class HamiltonianTests: XCTestCase {
 
     static let allTests = [
-        ("test_hamiltonian",test_hamiltonian)
+        ("test_hamiltonian",test_hamiltonian),
+        ("test_fermionic_maps",test_fermionic_maps),
+        ("test_fermionic_maps_symmetry",test_fermionic_maps_symmetry),
+        ("test_energy_estimate",test_energy_estimate)
     ]
 
     static private let H2Equilibrium: String =
@@ -154,4 +245,108 @@ XX
             XCTFail("test_hamiltonian: \(error)")
         }
     }
+
+    func test_fermionic_maps() {
+        do {
+            // h = n0 + 2 n1 + 0.5 n0 n1, with n_i = (I - Z_i) / 2
+            let h1: [[Double]] = [[1.0, 0.0], [0.0, 2.0]]
+            var h2 = [[[[Double]]]](repeating: [[[Double]]](repeating: [[Double]](repeating: [Double](repeating: 0.0, count: 2), count: 2), count: 2), count: 2)
+            h2[0][0][1][1] = 0.5
+            var pauli_list = try Fermion.fermionic_maps(h1, h2, "JORDAN_WIGNER")
+            var coefficients: [String:Complex] = [:]
+            for (coeff, pauli) in pauli_list {
+                XCTAssertNil(coefficients[pauli.to_label()])
+                coefficients[pauli.to_label()] = coeff
+            }
+            let expected: [String:Double] = ["II": 1.625, "ZI": -0.625, "IZ": -1.125, "ZZ": 0.125]
+            XCTAssertEqual(Set(coefficients.keys), Set(expected.keys))
+            for (label, value) in expected {
+                XCTAssertEqual(coefficients[label]?.real ?? 0.0, value, accuracy: 1e-12)
+                XCTAssertEqual(coefficients[label]?.imag ?? 1.0, 0.0, accuracy: 1e-12)
+            }
+
+            // Hopping: the XY and YX terms cancel and are pruned
+            let hopping: [[Double]] = [[0.0, 0.3], [0.3, 0.0]]
+            h2[0][0][1][1] = 0.0
+            pauli_list = try Fermion.fermionic_maps(hopping, h2, "JORDAN_WIGNER")
+            XCTAssertEqual(Set(pauli_list.map { $0.1.to_label() }), Set(["XX", "YY"]))
+            for (coeff, _) in pauli_list {
+                XCTAssertEqual(abs(coeff.real), 0.15, accuracy: 1e-12)
+                XCTAssertEqual(coeff.real, pauli_list[0].0.real, accuracy: 1e-12)
+            }
+        } catch {
+            XCTFail("test_fermionic_maps: \(error)")
+        }
+    }
+
+    func test_fermionic_maps_symmetry() {
+        do {
+            // Two-body integrals with the real orbital symmetries, plus one
+            // asymmetric entry that has to be expanded on its own
+            let n = 3
+            let h1 = [[Double]](repeating: [Double](repeating: 0.0, count: n), count: n)
+            var h2 = [[[[Double]]]](repeating: [[[Double]]](repeating: [[Double]](repeating: [Double](repeating: 0.0, count: n), count: n), count: n), count: n)
+            for i in 0..<n {
+                for j in 0..<n {
+                    for k in 0..<n {
+                        for m in 0..<n {
+                            let p = (i + 1) * (j + 1)
+                            let q = (k + 1) * (m + 1)
+                            h2[i][j][k][m] = 0.1 * Double(p + q) + 0.01 * Double(p * q)
+                        }
+                    }
+                }
+            }
+            h2[0][1][2][2] += 0.05
+            for map_type in ["JORDAN_WIGNER"] {
+                let pauli_list = try Fermion.fermionic_maps(h1, h2, map_type)
+
+                // Reference: every quadruple expanded on its own
+                var reference = PauliAccumulator()
+                for i in 0..<n {
+                    for j in 0..<n {
+                        for k in 0..<n {
+                            for m in 0..<n {
+                                var single = [[[[Double]]]](repeating: [[[Double]]](repeating: [[Double]](repeating: [Double](repeating: 0.0, count: n), count: n), count: n), count: n)
+                                single[i][j][k][m] = h2[i][j][k][m]
+                                for (coeff, pauli) in try Fermion.fermionic_maps(h1, single, map_type) {
+                                    reference.add(coeff, pauli, -1.0)
+                                }
+                            }
+                        }
+                    }
+                }
+                var expected: [String:Complex] = [:]
+                for (coeff, pauli) in reference.pauli_list(-1.0) {
+                    expected[pauli.to_label()] = coeff
+                }
+                var coefficients: [String:Complex] = [:]
+                for (coeff, pauli) in pauli_list {
+                    coefficients[pauli.to_label()] = coeff
+                }
+                for label in Set(expected.keys).union(coefficients.keys) {
+                    let coeff = coefficients[label] ?? Complex()
+                    let expected_coeff = expected[label] ?? Complex()
+                    XCTAssertEqual(coeff.real, expected_coeff.real, accuracy: 1e-9, "\(map_type) \(label)")
+                    XCTAssertEqual(coeff.imag, expected_coeff.imag, accuracy: 1e-9, "\(map_type) \(label)")
+                }
+            }
+        } catch {
+            XCTFail("test_fermionic_maps_symmetry: \(error)")
+        }
+    }
+
+    func test_energy_estimate() {
+        let data = ["000": 3, "101": 1, "111": 4]
+        let z0 = Pauli([1, 0, 0], [0, 0, 0])
+        let z0z1 = Pauli([1, 1, 0], [0, 0, 0])
+        let x2 = Pauli([0, 0, 0], [0, 0, 1])
+        XCTAssertEqual(Optimization.measure_pauli_z(data, z0), -0.25, accuracy: 1e-12)
+        XCTAssertEqual(Optimization.measure_pauli_z(data, z0z1), 0.75, accuracy: 1e-12)
+        XCTAssertEqual(Optimization.measure_pauli_z(data, x2), -0.25, accuracy: 1e-12)
+        XCTAssertEqual(Optimization.Energy_Estimate(data, [(2.0, z0), (-1.0, z0z1), (0.5, x2)]),
+                       -0.5 - 0.75 - 0.125, accuracy: 1e-12)
+        // Outcomes that are not one bit per qubit keep the character lookup
+        XCTAssertEqual(Optimization.measure_pauli_z(["0 01": 2], Pauli([1, 0, 0], [0, 0, 0])), 1.0, accuracy: 1e-12)
+    }
 }
@@ -31,7 +31,12 @@ class DataStructureTests: XCTestCase {
         ("testMatrix",testMatrix),
         ("testComplexMatrix", testComplexMatrix),
         ("testTrace",testTrace),
-        ("testMultiDArray", testMultiDArray)
+        ("testMultiDArray", testMultiDArray),
+        ("testCouplingDistance", testCouplingDistance),
+        ("testSwapMapper", testSwapMapper),
+        ("testLookaheadMapper", testLookaheadMapper),
+        ("testPeepholeOptimize", testPeepholeOptimize),
+        ("testCompileCache", testCompileCache)
     ]
 
     override func setUp() {
@@ -301,6 +306,179 @@ class DataStructureTests: XCTestCase {
         }
     }
 
+    func testCouplingDistance() {
+        do {
+            let coupling = try Coupling([0: [1], 1: [2], 3: [2]])
+            let qubits = coupling.get_qubits()
+            XCTAssertEqual(coupling.distance_matrix.count, qubits.count * qubits.count)
+            for (i, q1) in qubits.enumerated() {
+                XCTAssertEqual(try coupling.qubit_index(q1), i)
+                for (j, q2) in qubits.enumerated() {
+                    XCTAssertEqual(coupling.distance(i, j), try coupling.distance(q1, q2))
+                    XCTAssertEqual(coupling.distance(i, j), coupling.distance(j, i))
+                }
+            }
+            XCTAssertEqual(try coupling.distance(RegBit("q", 0), RegBit("q", 3)), 3)
+            XCTAssertEqual(try coupling.distance(RegBit("q", 1), RegBit("q", 3)), 2)
+            XCTAssertEqual(coupling.get_edge_indices().count, coupling.get_edges().count)
+        } catch {
+            XCTFail("testCouplingDistance: \(error)")
+        }
+    }
+
+    func testSwapMapper() {
+        do {
+            let qasm = "OPENQASM 2.0;\n" +
+                "gate cx c,t { CX c,t; }\n" +
+                "qreg q[3];\n" +
+                "creg c[3];\n" +
+                "cx q[0],q[1];\n" +
+                "cx q[0],q[2];\n" +
+                "cx q[1],q[2];\n" +
+                "measure q -> c;\n"
+            let dag = try OpenQuantumCompiler.compile(qasm, basis_gates: "cx").dag!
+            let coupling = try Coupling([0: [1], 1: [2]])
+            let (circuit, layout) = try Mapping.swap_mapper(dag, coupling, nil, "cx", trials: 20, seed: 13)
+            XCTAssertEqual(layout.count, 3)
+            let (_, negative_layout) = try Mapping.swap_mapper(dag, coupling, nil, "cx", trials: 20, seed: -7)
+            XCTAssertEqual(negative_layout.count, 3)
+            var ops = try circuit.count_ops()
+            let swaps = ops["swap"] ?? 0
+            XCTAssert(swaps > 0)
+            XCTAssertEqual(ops["cx"], 3)
+            XCTAssertEqual(ops["measure"], 3)
+            for node in try circuit.get_named_nodes("cx") {
+                let data = node.data as! CircuitVertexOpData
+                XCTAssertEqual(try coupling.distance(data.qargs[0], data.qargs[1]), 1)
+            }
+            try Mapping.expand_swaps(circuit)
+            ops = try circuit.count_ops()
+            XCTAssertNil(ops["swap"])
+            XCTAssertEqual(ops["cx"], 3 + 3 * swaps)
+        } catch {
+            XCTFail("testSwapMapper: \(error)")
+        }
+    }
+
+    func testLookaheadMapper() {
+        do {
+            let qasm = "OPENQASM 2.0;\n" +
+                "gate cx c,t { CX c,t; }\n" +
+                "qreg q[5];\n" +
+                "creg c[5];\n" +
+                "cx q[0],q[4];\n" +
+                "cx q[1],q[3];\n" +
+                "cx q[0],q[2];\n" +
+                "cx q[4],q[1];\n" +
+                "measure q -> c;\n"
+            let dag = try OpenQuantumCompiler.compile(qasm, basis_gates: "cx").dag!
+            let coupling = try Coupling([0: [1], 1: [2], 2: [3], 3: [4]])
+            let (circuit, layout) = try Mapping.lookahead_mapper(dag, coupling, nil, "cx")
+            XCTAssertEqual(layout.count, 5)
+            var ops = try circuit.count_ops()
+            let swaps = ops["swap"] ?? 0
+            XCTAssert(swaps > 0)
+            XCTAssertEqual(ops["cx"], 4)
+            XCTAssertEqual(ops["measure"], 5)
+            for node in try circuit.get_named_nodes("cx") {
+                let data = node.data as! CircuitVertexOpData
+                XCTAssertEqual(try coupling.distance(data.qargs[0], data.qargs[1]), 1)
+            }
+            try Mapping.expand_swaps(circuit)
+            ops = try circuit.count_ops()
+            XCTAssertEqual(ops["cx"], 4 + 3 * swaps)
+
+            let compiled = try OpenQuantumCompiler.compile(qasm, basis_gates: "cx",
+                                                           coupling_map: [0: [1], 1: [2], 2: [3], 3: [4]],
+                                                           mapper: "lookahead")
+            XCTAssertNotNil(compiled.dag)
+            XCTAssertThrowsError(try OpenQuantumCompiler.compile(qasm, coupling_map: [0: [1]], mapper: "none")) { (error) in
+                guard case QisKitCompilerError.unknownMapper(let name) = error else {
+                    XCTFail("testLookaheadMapper: unexpected error \(error)")
+                    return
+                }
+                XCTAssertEqual(name, "none")
+            }
+        } catch {
+            XCTFail("testLookaheadMapper: \(error)")
+        }
+    }
+
+    func testPeepholeOptimize() {
+        do {
+            let qasm = "OPENQASM 2.0;\n" +
+                "gate cx c,t { CX c,t; }\n" +
+                "gate u1(lambda) q { U(0,0,lambda) q; }\n" +
+                "gate u2(phi,lambda) q { U(pi/2,phi,lambda) q; }\n" +
+                "gate id a { U(0,0,0) a; }\n" +
+                "gate h a { u2(0,pi) a; }\n" +
+                "qreg q[2];\n" +
+                "cx q[0],q[1];\n" +
+                "u1(0.3) q[0];\n" +
+                "u1(-0.3) q[0];\n" +
+                "id q[1];\n" +
+                "cx q[0],q[1];\n" +
+                "h q[1];\n" +
+                "u1(0.2) q[1];\n"
+            let dag = try OpenQuantumCompiler.compile(qasm, basis_gates: "u1,u2,cx,id,h").dag!
+            let ops = try dag.count_ops()
+            let optimized = try Mapping.peephole_optimize(dag)
+            XCTAssertEqual(try dag.count_ops(), ops)
+            XCTAssertEqual(try optimized.count_ops(), ["u2": 1])
+            XCTAssertEqual(optimized.basis.keys, ["u2"])
+            let node = try optimized.get_named_nodes("u2")[0].data as! CircuitVertexOpData
+            XCTAssertEqual(node.params[0].value, 0.2, accuracy: 1e-9)
+            XCTAssertEqual(node.params[1].value, Double.pi, accuracy: 1e-9)
+        } catch {
+            XCTFail("testPeepholeOptimize: \(error)")
+        }
+    }
+
+    func testCompileCache() {
+        do {
+            let qasm = "OPENQASM 2.0;\n" +
+                "include \"qelib1.inc\";\n" +
+                "qreg q[3];\n" +
+                "creg c[3];\n" +
+                "h q[0];\n" +
+                "cx q[0],q[2];\n" +
+                "measure q -> c;\n"
+            let directory = URL(fileURLWithPath: NSTemporaryDirectory())
+                .appendingPathComponent("CompileCache-\(ProcessInfo.processInfo.globallyUniqueString)")
+            defer {
+                try? FileManager.default.removeItem(at: directory)
+            }
+            let cache = CompileCache(capacity: 4, directory: directory)
+            let first = try OpenQuantumCompiler.compile(qasm, coupling_map: [0: [1], 1: [2]], get_layout: true, cache: cache)
+            XCTAssertEqual(cache.misses, 1)
+            XCTAssertEqual(cache.hits, 0)
+            let second = try OpenQuantumCompiler.compile(qasm, coupling_map: [0: [1], 1: [2]], get_layout: true, cache: cache)
+            XCTAssertEqual(cache.misses, 1)
+            XCTAssertEqual(cache.hits, 1)
+            XCTAssertFalse(first.dag! === second.dag!)
+            XCTAssertEqual(try first.dag!.qasm(), try second.dag!.qasm())
+            XCTAssertEqual(first.final_layout!.keys, second.final_layout!.keys)
+            XCTAssertEqual(first.final_layout!.values, second.final_layout!.values)
+
+            _ = try OpenQuantumCompiler.compile(qasm, basis_gates: "u1,u2,u3,cx", cache: cache)
+            XCTAssertEqual(cache.misses, 2)
+            XCTAssertEqual(cache.count, 2)
+
+            let reloaded = CompileCache(directory: directory)
+            let third = try OpenQuantumCompiler.compile(qasm, coupling_map: [0: [1], 1: [2]], get_layout: true, cache: reloaded)
+            XCTAssertEqual(reloaded.hits, 1)
+            XCTAssertEqual(reloaded.misses, 0)
+            XCTAssertEqual(try first.dag!.qasm(), try third.dag!.qasm())
+            XCTAssertEqual(first.final_layout!.keys, third.final_layout!.keys)
+            XCTAssertEqual(first.final_layout!.values, third.final_layout!.values)
+
+            // programs do not cache unless asked to
+            XCTAssertNil(try QuantumProgram().compile_cache)
+        } catch {
+            XCTFail("testCompileCache: \(error)")
+        }
+    }
+
     func testMultiDArray() {
         let value = 101
         let count = 3
@@ -29,6 +29,9 @@ class IBMQuantumExperienceTests: XCTestCase {
         ("test_api_run_job",test_api_run_job),
         ("test_api_run_job_fail_backend",test_api_run_job_fail_backend),
         ("test_api_get_jobs",test_api_get_jobs),
+        ("test_job_poller",test_job_poller),
+        ("test_request_retry_and_metrics",test_request_retry_and_metrics),
+        ("test_backend_cache",test_backend_cache),
         ("test_api_backend_status",test_api_backend_status),
         ("test_api_backend_calibration",test_api_backend_calibration),
         ("test_api_backend_parameters",test_api_backend_parameters),
@@ -356,6 +359,208 @@ measure q[2] -> f[0];
         })
     }
 
+    func test_job_poller() {
+        // stand-in for the API: a job finishes after a number of status
+        // requests, and the second status request fails
+        let lock = NSLock()
+        var finish_after: [String:Int] = ["j1": 2, "j2": 4, "j4": 100]
+        var batches: [[String]] = []
+        var fetched: [String] = []
+        let poller = JobPoller(initial_interval: 0.01, backoff: 2.0, jitter: 0.2, fetch_status: { (ids, handler) in
+            lock.lock()
+            batches.append(ids)
+            if batches.count == 2 {
+                lock.unlock()
+                handler([:], IBMQuantumExperienceError.timeout)
+                return RequestTask()
+            }
+            var statuses: [String:String] = [:]
+            for id in ids {
+                if let n = finish_after[id] {
+                    finish_after[id] = n - 1
+                    statuses[id] = n > 1 ? "RUNNING" : "COMPLETED"
+                }
+            }
+            lock.unlock()
+            handler(statuses, nil)
+            return RequestTask()
+        }, fetch_job: { (id, handler) in
+            lock.lock()
+            fetched.append(id)
+            lock.unlock()
+            handler(["id": id, "status": "COMPLETED"], nil)
+            return RequestTask()
+        })
+        let asyncExpectation = self.expectation(description: "test_job_poller")
+        var results: [String] = []
+        var errors: [String:Error] = [:]
+        let group = DispatchGroup()
+        var tasks: [String:RequestTask] = [:]
+        // j3 is never reported and times out, j4 is cancelled
+        for (id, timeout) in [("j1", 60), ("j1", 60), ("j2", 60), ("j3", 1), ("j4", 60)] {
+            group.enter()
+            tasks[id] = poller.wait(id, wait: 1, timeout: timeout) { (job, error) in
+                lock.lock()
+                if error != nil {
+                    errors[id] = error!
+                }
+                else {
+                    results.append(job["id"] as! String)
+                }
+                lock.unlock()
+                group.leave()
+            }
+        }
+        tasks["j4"]!.cancel()
+        group.notify(queue: DispatchQueue.global()) {
+            asyncExpectation.fulfill()
+        }
+        self.waitForExpectations(timeout: 30, handler: { (error) in
+            XCTAssertNil(error, "Failure in test_job_poller")
+        })
+        lock.lock()
+        defer { lock.unlock() }
+        // one status request for all the jobs, each job fetched once
+        XCTAssertEqual(batches.first ?? [], ["j1", "j2", "j3"])
+        XCTAssertEqual(Set(fetched), Set(["j1", "j2"]))
+        XCTAssertEqual(poller.job_requests, 2)
+        // the failed request did not fail the jobs
+        XCTAssertEqual(results.sorted(), ["j1", "j1", "j2"])
+        XCTAssertEqual(Set(errors.keys), Set(["j3", "j4"]))
+        if let e = errors["j3"] as? QISKitError, case .jobTimeout = e {
+        }
+        else {
+            XCTFail("test_job_poller: j3 should time out")
+        }
+        if let e = errors["j4"] as? IBMQuantumExperienceError, case .requestCancelled = e {
+        }
+        else {
+            XCTFail("test_job_poller: j4 should be cancelled")
+        }
+        XCTAssertEqual(poller.pending, 0)
+    }
+
+    func test_request_retry_and_metrics() {
+        do {
+            let request = try Request(Credentials(nil, ["url": "http://localhost"]), 5, 0.5, 4.0)
+            // capped exponential backoff
+            XCTAssertEqual((0..<5).map { request.retry_delay(UInt($0)) }, [0.5, 1.0, 2.0, 4.0, 4.0])
+            XCTAssertTrue(Request.is_retryable(IBMQuantumExperienceError.httpError(httpStatus: 503, status: 0, code: "", msg: "")))
+            XCTAssertTrue(Request.is_retryable(IBMQuantumExperienceError.httpError(httpStatus: 429, status: 0, code: "", msg: "")))
+            XCTAssertFalse(Request.is_retryable(IBMQuantumExperienceError.httpError(httpStatus: 400, status: 0, code: "", msg: "")))
+            XCTAssertFalse(Request.is_retryable(IBMQuantumExperienceError.registerSizeError(msg: "")))
+            // clients with the same proxies share their session
+            let other = try Request(Credentials(nil, ["url": "http://localhost"]))
+            XCTAssertTrue(request.urlSession === other.urlSession)
+            // the session is dropped with its last client
+            var ntlm: Request? = try Request(Credentials(nil, ["url": "http://localhost",
+                                                               "proxies": ["username_ntlm": "user", "password_ntlm": "secret"]]))
+            let released = ntlm!.urlSession
+            XCTAssertFalse(released === request.urlSession)
+            ntlm = nil
+            let renewed = try Request(Credentials(nil, ["url": "http://localhost",
+                                                        "proxies": ["username_ntlm": "user", "password_ntlm": "secret"]]))
+            XCTAssertFalse(renewed.urlSession === released)
+            // checksum of the gzip trailer
+            XCTAssertEqual(Request.crc32("123456789".data(using: .utf8)!), 0xCBF43926)
+
+            let metrics = RequestMetrics()
+            metrics.record(0.01, failed: false)
+            metrics.record(0.3, failed: true)
+            metrics.record(100.0, failed: false)
+            metrics.record_retry()
+            XCTAssertEqual(metrics.requests, 3)
+            XCTAssertEqual(metrics.failures, 1)
+            XCTAssertEqual(metrics.retries, 1)
+            XCTAssertEqual(metrics.mean_latency, 100.31 / 3.0, accuracy: 1e-9)
+            let counts = metrics.latency_counts
+            XCTAssertEqual(counts.count, RequestMetrics.latency_bounds.count + 1)
+            XCTAssertEqual(counts[0], 1)
+            XCTAssertEqual(counts[3], 1)
+            XCTAssertEqual(counts.last!, 1)
+            metrics.reset()
+            XCTAssertEqual(metrics.requests, 0)
+            XCTAssertEqual(metrics.latency_counts.reduce(0, +), 0)
+        } catch {
+            XCTFail("test_request_retry_and_metrics: \(error)")
+        }
+    }
+
+    func test_backend_cache() {
+        let cache = BackendCache(configuration_ttl: 60.0, status_ttl: 0.0)
+        var fetches = 0
+        var pending: [(Any?, IBMQuantumExperienceError?) -> Void] = []
+        var tasks: [RequestTask] = []
+        var values: [String] = []
+        let fetch = { (done: @escaping (Any?, IBMQuantumExperienceError?) -> Void) -> RequestTask in
+            fetches += 1
+            pending.append(done)
+            tasks.append(RequestTask())
+            return tasks.last!
+        }
+        let handler = { (value: Any?, error: IBMQuantumExperienceError?) -> Void in
+            if let e = error, case IBMQuantumExperienceError.requestCancelled(_) = e {
+                values.append("cancelled")
+                return
+            }
+            values.append(error == nil ? value as! String : "error")
+        }
+        // concurrent callers share the request
+        _ = cache.get(.configuration, "backends", fetch: fetch, handler)
+        _ = cache.get(.configuration, "backends", fetch: fetch, handler)
+        XCTAssertEqual(fetches, 1)
+        pending.removeFirst()("ibmqx4", nil)
+        XCTAssertEqual(values, ["ibmqx4", "ibmqx4"])
+        // then the entry is used until it expires
+        _ = cache.get(.configuration, "backends", fetch: fetch, handler)
+        XCTAssertEqual(fetches, 1)
+        XCTAssertEqual(values.last, "ibmqx4")
+        XCTAssertEqual(cache.misses, 1)
+        XCTAssertEqual(cache.hits, 2)
+        // errors are not cached
+        _ = cache.get(.configuration, "other", fetch: fetch, handler)
+        pending.removeFirst()(nil, IBMQuantumExperienceError.missingBackends)
+        _ = cache.get(.configuration, "other", fetch: fetch, handler)
+        XCTAssertEqual(fetches, 3)
+        pending.removeFirst()("ibmqx5", nil)
+        XCTAssertEqual(Array(values.suffix(2)), ["error", "ibmqx5"])
+        // a time to live of 0 does not cache
+        _ = cache.get(.status, "ibmqx4", fetch: fetch, handler)
+        pending.removeFirst()("busy", nil)
+        _ = cache.get(.status, "ibmqx4", fetch: fetch, handler)
+        XCTAssertEqual(fetches, 5)
+        pending.removeFirst()("idle", nil)
+        // persisted entries are read by other caches
+        let directory = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent("qiskit_backend_cache_\(getpid())")
+        defer {
+            try? FileManager.default.removeItem(at: directory)
+        }
+        cache.directory = directory
+        _ = cache.get(.calibration, "ibmqx4", fetch: fetch, handler)
+        pending.removeFirst()("calibration", nil)
+        let other = BackendCache()
+        other.directory = directory
+        _ = other.get(.calibration, "ibmqx4", fetch: fetch, handler)
+        XCTAssertEqual(fetches, 6)
+        XCTAssertEqual(values.last, "calibration")
+        other.invalidate(.calibration)
+        _ = BackendCache().get(.calibration, "ibmqx4", fetch: fetch, handler)
+        _ = other.get(.calibration, "ibmqx4", fetch: fetch, handler)
+        XCTAssertEqual(fetches, 8)
+        // cancelled callers are answered, the request is cancelled with the last one
+        let first = cache.get(.configuration, "cancelled", fetch: fetch, handler)
+        let second = cache.get(.configuration, "cancelled", fetch: fetch, handler)
+        XCTAssertEqual(fetches, 9)
+        first.cancel()
+        XCTAssertEqual(values.last, "cancelled")
+        XCTAssertFalse(tasks.last!.isCancelled())
+        second.cancel()
+        XCTAssertEqual(Array(values.suffix(2)), ["cancelled", "cancelled"])
+        XCTAssertTrue(tasks.last!.isCancelled())
+        _ = cache.get(.configuration, "cancelled", fetch: fetch, handler)
+        XCTAssertEqual(fetches, 10)
+    }
+
     func test_api_backend_status() {
         guard let api = self.getAPI() else {
             print("Set environment variable QE_TOKEN to execute this method")
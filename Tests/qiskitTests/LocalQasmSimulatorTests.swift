@@ -25,7 +25,9 @@ class LocalQasmSimulatorTests: XCTestCase {
         ("test_qasm_simulator_single_shot",test_qasm_simulator_single_shot),
         ("test_qasm_simulator",test_qasm_simulator),
         ("test_if_statement",test_if_statement),
-        ("test_teleport",test_teleport)
+        ("test_teleport",test_teleport),
+        ("test_format_result",test_format_result),
+        ("test_wide_classical_register",test_wide_classical_register)
     ]
     
     private var seed: Int = 0
@@ -286,4 +288,42 @@ class LocalQasmSimulatorTests: XCTestCase {
             XCTFail("\(error)")
         }
     }
+
+    func test_format_result() {
+        XCTAssertEqual(QasmSimulator._format_result(3, [0, 1], [1, 2]), "01 1")
+        XCTAssertEqual(QasmSimulator._format_result(5, [0, 1, 2], [1, 1, 1]), "1 0 1")
+        XCTAssertEqual(QasmSimulator._format_result(2, [0], [4]), "0010")
+    }
+
+    /**
+     Counts above the flat histogram size.
+     */
+    func test_wide_classical_register() {
+        do {
+            let shots = 10
+            let nbits = QasmSimulator.dense_histogram_cbits + 2
+            let qp = try QuantumProgram()
+            let qr = try qp.create_quantum_register("qr", 1)
+            let cr = try qp.create_classical_register("cr", nbits)
+            let circuit = try qp.create_circuit("wide", [qr], [cr])
+            try circuit.x(qr[0])
+            try circuit.measure(qr[0], cr[0])
+            try circuit.measure(qr[0], cr[nbits - 1])
+            let asyncExpectation = self.expectation(description: "test_wide_classical_register")
+            qp.execute(["wide"], backend: "local_qasm_simulator", shots: shots, seed: self.seed) { (result) in
+                do {
+                    let key = "1" + String(repeating: "0", count: nbits - 2) + "1"
+                    XCTAssertEqual(try result.get_counts("wide"), [key: shots])
+                } catch {
+                    XCTFail("\(error)")
+                }
+                asyncExpectation.fulfill()
+            }
+            self.waitForExpectations(timeout: 180, handler: { (error) in
+                XCTAssertNil(error, "Failure in test_wide_classical_register")
+            })
+        } catch {
+            XCTFail("\(error)")
+        }
+    }
 }
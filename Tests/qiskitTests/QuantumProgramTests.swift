@@ -68,6 +68,8 @@ class QuantumProgramTests: XCTestCase {
         ("test_change_circuit_qobj_after_compile",test_change_circuit_qobj_after_compile),
         ("test_run_program",test_run_program),
         ("test_run_batch",test_run_batch),
+        ("test_job_scheduler",test_job_scheduler),
+        ("test_completion_executor",test_completion_executor),
         ("test_combine_results",test_combine_results),
         ("test_local_qasm_simulator",test_local_qasm_simulator),
         ("test_local_qasm_simulator_one_shot",test_local_qasm_simulator_one_shot),
@@ -75,6 +77,7 @@ class QuantumProgramTests: XCTestCase {
         ("test_run_program_map",test_run_program_map),
         ("test_execute_program_map",test_execute_program_map),
         ("test_average_data",test_average_data),
+        ("test_result_store",test_result_store),
         ("test_execute_one_circuit_simulator_online",test_execute_one_circuit_simulator_online),
         ("test_simulator_online_size",test_simulator_online_size),
         ("test_execute_several_circuits_simulator_online",test_execute_several_circuits_simulator_online),
@@ -87,6 +90,8 @@ class QuantumProgramTests: XCTestCase {
         ("test_example_swap_bits",test_example_swap_bits),
         ("test_offline",test_offline),
         ("test_results_save_load",test_results_save_load),
+        ("test_results_save_load_binary",test_results_save_load_binary),
+        ("test_memory_mapped_output",test_memory_mapped_output),
         ("test_qubitpol",test_qubitpol),
         ("test_ccx",test_ccx),
         ("test_reconfig",test_reconfig),
@@ -1332,6 +1337,155 @@ class QuantumProgramTests: XCTestCase {
         }
     }
 
+    func test_job_scheduler() {
+        let scheduler = JobScheduler(max_jobs: 2, memory_limit: 100)
+        scheduler.set_max_jobs(1, backend: "b")
+        var started: [String] = []
+        var finish: [String:() -> Void] = [:]
+        var expired: [String:Bool] = [:]
+        func submit(_ name: String, _ backend: String, priority: Int = 0, memory: Int = 0,
+                    task: RequestTask = RequestTask()) {
+            scheduler.submit(backend, local: true, priority: priority, memory: memory, timeout: 60, task: task, start: { (done) in
+                started.append(name)
+                finish[name] = done
+            }, expire: { (timed_out) in
+                expired[name] = timed_out
+            })
+        }
+        // at most max_jobs per backend, other backends are not held up
+        submit("a1", "a")
+        submit("a2", "a")
+        submit("a3", "a")
+        submit("b1", "b")
+        XCTAssertEqual(started, ["a1", "a2", "b1"])
+        XCTAssertEqual(scheduler.running, 3)
+        XCTAssertEqual(scheduler.queued, 1)
+        // higher priority first, then first submitted
+        submit("b2", "b")
+        submit("b3", "b", priority: 5)
+        submit("b4", "b", priority: 5)
+        finish["b1"]!()
+        XCTAssertEqual(started.last, "b3")
+        finish["b3"]!()
+        XCTAssertEqual(started.last, "b4")
+        finish["b4"]!()
+        XCTAssertEqual(started.last, "b2")
+        // memory: a smaller job does not overtake a waiting larger one
+        submit("c1", "c", memory: 60)
+        submit("c2", "c", memory: 60)
+        submit("c3", "c", memory: 10)
+        XCTAssertEqual(started.last, "c1")
+        finish["c1"]!()
+        XCTAssertEqual(Array(started.suffix(2)), ["c2", "c3"])
+        // a job larger than the limit runs alone
+        submit("d1", "d", memory: 1000)
+        XCTAssertEqual(started.last, "c3")
+        finish["c2"]!()
+        finish["c3"]!()
+        XCTAssertEqual(started.last, "d1")
+        // cancelled jobs leave the queue
+        let task = RequestTask()
+        submit("a4", "a", task: task)
+        task.cancel()
+        XCTAssertEqual(expired["a4"], false)
+        finish["a1"]!()
+        XCTAssertEqual(started.last, "a3")
+        XCTAssertFalse(started.contains("a4"))
+        XCTAssertEqual(scheduler.queued, 0)
+        for name in ["a2", "a3", "b2", "d1"] {
+            finish[name]!()
+        }
+        XCTAssertEqual(scheduler.running, 0)
+
+        // a running job that never reports back expires at its deadline
+        // and gives back its slot
+        let asyncExpectation = self.expectation(description: "test_job_scheduler")
+        let hung = RequestTask()
+        var hung_done: (() -> Void)? = nil
+        scheduler.submit("b", local: false, priority: 0, memory: 0, timeout: 1, task: hung, start: { (done) in
+            hung_done = done
+        }, expire: { (timed_out) in
+            XCTAssertTrue(timed_out)
+            asyncExpectation.fulfill()
+        })
+        XCTAssertEqual(scheduler.running, 1)
+        self.waitForExpectations(timeout: 10, handler: { (error) in
+            XCTAssertNil(error, "Failure in test_job_scheduler")
+        })
+        XCTAssertTrue(hung.isCancelled())
+        XCTAssertEqual(scheduler.running, 0)
+        submit("b5", "b")
+        XCTAssertEqual(started.last, "b5")
+        // its late done does not release the slot of another job
+        hung_done!()
+        XCTAssertEqual(scheduler.running, 1)
+        finish["b5"]!()
+        XCTAssertEqual(scheduler.running, 0)
+
+        // a local job keeps its memory past its deadline until it stops
+        let slowExpectation = self.expectation(description: "test_job_scheduler local")
+        var slow_done: (() -> Void)? = nil
+        scheduler.submit("e", local: true, priority: 0, memory: 60, timeout: 1, task: RequestTask(), start: { (done) in
+            slow_done = done
+        }, expire: { (timed_out) in
+            XCTAssertTrue(timed_out)
+            slowExpectation.fulfill()
+        })
+        self.waitForExpectations(timeout: 10, handler: { (error) in
+            XCTAssertNil(error, "Failure in test_job_scheduler")
+        })
+        submit("e2", "e", memory: 60)
+        XCTAssertNotEqual(started.last, "e2")
+        XCTAssertEqual(scheduler.running, 1)
+        slow_done!()
+        XCTAssertEqual(started.last, "e2")
+        finish["e2"]!()
+        XCTAssertEqual(scheduler.running, 0)
+
+        // remote backends have their own limit
+        XCTAssertEqual(scheduler.max_jobs("r", local: false), scheduler.remote_max_jobs)
+        XCTAssertEqual(scheduler.max_jobs("b", local: false), 1)
+    }
+
+    func test_completion_executor() {
+        do {
+            let QP_program = try QuantumProgram()
+            let q = try QP_program.create_quantum_register("q", 1)
+            let c = try QP_program.create_classical_register("c", 1)
+            let qc = try QP_program.create_circuit("qc", [q], [c])
+            try qc.h(q[0])
+            try qc.measure(q[0], c[0])
+
+            // callbacks on the queue of the program executor
+            let key = DispatchSpecificKey<String>()
+            let queue = DispatchQueue(label: "test_completion_executor")
+            queue.setSpecific(key: key, value: "test_completion_executor")
+            QP_program.completion_executor = CompletionExecutor(queue: queue)
+            let asyncExpectation = self.expectation(description: "test_completion_executor")
+            QP_program.execute(["qc"], shots: 100, seed: 7) { (result) in
+                XCTAssertEqual(DispatchQueue.getSpecific(key: key), "test_completion_executor")
+                XCTAssertNil(result.get_error())
+                asyncExpectation.fulfill()
+            }
+            self.waitForExpectations(timeout: 180, handler: { (error) in
+                XCTAssertNil(error, "Failure in test_completion_executor")
+            })
+
+            // waiting on the main thread for the main queue would never end
+            XCTAssertThrowsError(try QP_program.execute_and_wait(["qc"], shots: 100, seed: 7))
+            let shared = CompletionExecutor.shared
+            CompletionExecutor.shared = CompletionExecutor.serial()
+            defer {
+                CompletionExecutor.shared = shared
+            }
+            let result = try QP_program.execute_and_wait(["qc"], shots: 100, seed: 7)
+            XCTAssertNil(result.get_error())
+            XCTAssertEqual(try result.get_counts("qc").values.reduce(0, +), 100)
+        } catch {
+            XCTFail("test_completion_executor: \(error)")
+        }
+    }
+
     func test_combine_results() {
         do {
             let QP_program = try QuantumProgram()
@@ -1681,6 +1835,53 @@ class QuantumProgramTests: XCTestCase {
         }
     }
 
+    func test_result_store() {
+        do {
+            let config: [String:Any] = ["shots": 10, "backend": "local_qasm_simulator"]
+            let qobj1: [String:Any] = ["id": "q1", "config": config,
+                                       "circuits": [["name": "a"], ["name": "b"]]]
+            let result1: [String:Any] = ["job_id": "j1", "status": "COMPLETED",
+                                         "result": [["data": ["counts": ["01 1": 6, "10 0": 4]], "status": "DONE"],
+                                                    ["data": ["counts": ["0x3": 10], "time": 1.5], "status": "DONE"]]]
+            let qobj2: [String:Any] = ["id": "q2", "config": config,
+                                       "circuits": [["name": "c"]]]
+            let result2: [String:Any] = ["job_id": "j2", "status": "COMPLETED",
+                                         "result": [["data": ["quantum_state": [Complex(real: 1.0), Complex()]], "status": "DONE"]]]
+            var result = Result(result1, qobj1)
+            XCTAssertEqual(try result.get_counts("a"), ["01 1": 6, "10 0": 4])
+            XCTAssertEqual(try result.get_count_histogram("a")?.register_sizes ?? [], [2, 1])
+            XCTAssertEqual(try result.get_count_histogram("a")?.shots, 10)
+            // Keys that are not bit strings are kept as they are
+            XCTAssertNil(try result.get_count_histogram("b"))
+            XCTAssertEqual(try result.get_counts("b"), ["0x3": 10])
+            XCTAssertEqual(try result.get_data("b")["time"] as? Double, 1.5)
+            let parities = try result.average_z_parities("a", [0b1, 0b110, 0])
+            XCTAssertEqual(parities[0], -0.2, accuracy: 1e-12)
+            XCTAssertEqual(parities[1], -1.0, accuracy: 1e-12)
+            XCTAssertEqual(parities[2], 1.0, accuracy: 1e-12)
+
+            try result.append(Result(result2, qobj2))
+            XCTAssertEqual(result.get_names(), ["a", "b", "c"])
+            XCTAssertEqual(result.count, 3)
+            XCTAssertEqual(result.circuit_statuses(), ["DONE", "DONE", "DONE"])
+            XCTAssertEqual(result._qobj["id"] as? [String] ?? [], ["q1", "q2"])
+            XCTAssertEqual((try result.get_data("c")["quantum_state"] as? [Complex])?.count, 2)
+            XCTAssertThrowsError(try result.get_counts("d"))
+
+            // The dictionary views round trip
+            let copy = Result(result._result, result._qobj)
+            XCTAssertEqual(try copy.get_counts("a"), ["01 1": 6, "10 0": 4])
+            XCTAssertEqual(copy.get_names(), ["a", "b", "c"])
+            XCTAssertEqual(copy.get_job_id(), "j1")
+
+            result._result["result"] = QISKitError.invalidResultsCombine
+            XCTAssertNotNil(result.get_error())
+            XCTAssertEqual(result.count, 0)
+        } catch {
+            XCTFail("test_result_store: \(error)")
+        }
+    }
+
     func test_execute_one_circuit_simulator_online() {
         guard let token = self.QE_TOKEN else {
             print("Set environment variable QE_TOKEN to execute this method")
@@ -2408,6 +2609,143 @@ class QuantumProgramTests: XCTestCase {
         }
     }
 
+    func test_results_save_load_binary() {
+        do {
+            let qobj: [String:Any] = ["id": "q1", "config": ["shots": 10],
+                                      "circuits": [["name": "a"], ["name": "b"]]]
+            let state = [Complex(0.5, -0.25), Complex(), Complex(-1.0, 2.0)]
+            let unitary = Matrix<Complex>(value: [[Complex(real: 1.0), Complex(imag: 1.0)],
+                                                  [Complex(imag: -1.0), Complex(real: 0.5)]])
+            let qresult: [String:Any] = ["job_id": "j1", "status": "COMPLETED",
+                                         "result": [["data": ["counts": ["01 1": 6, "10 0": 4], "time": 0.5], "status": "DONE"],
+                                                    ["data": ["quantum_state": state, "unitary": unitary], "status": "DONE"]]]
+            let result = Result(qresult, qobj)
+            let directory = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString)
+            try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true, attributes: nil)
+            defer {
+                try? FileManager.default.removeItem(at: directory)
+            }
+            let file = try FileIO.save_result_to_file(result, directory.appendingPathComponent("test").path,
+                                                      metadata: ["testval": 5], format: "binary")
+            XCTAssertTrue(file.hasSuffix(".qres"))
+            let (loaded, metadata) = try FileIO.load_result_from_file(file)
+            XCTAssertEqual(metadata["testval"] as? Int, 5)
+            XCTAssertEqual(loaded.get_names(), ["a", "b"])
+            XCTAssertEqual(loaded.get_job_id(), "j1")
+            XCTAssertEqual(loaded.circuit_statuses(), ["DONE", "DONE"])
+            XCTAssertEqual(try loaded.get_counts("a"), ["01 1": 6, "10 0": 4])
+            XCTAssertEqual(try loaded.get_data("a")["time"] as? Double, 0.5)
+            XCTAssertEqual(try loaded.get_data("b")["quantum_state"] as? [Complex] ?? [], state)
+            XCTAssertEqual(try loaded.get_data("b")["unitary"] as? Matrix<Complex>, unitary)
+
+            // failed jobs keep their error
+            let failed = Result("j2", QISKitError.jobTimeout(timeout: 5), qobj)
+            let failed_file = try FileIO.save_result_to_file(failed, directory.appendingPathComponent("failed").path,
+                                                             format: "binary")
+            let (failed_loaded, _) = try FileIO.load_result_from_file(failed_file)
+            XCTAssertTrue(failed_loaded.is_error())
+            XCTAssertNotNil(failed_loaded.get_error())
+            XCTAssertEqual(failed_loaded.get_job_id(), "j2")
+
+            // lengths past the end of the file are rejected
+            var data = try Data(contentsOf: URL(fileURLWithPath: file))
+            data.count -= 8
+            let truncated = directory.appendingPathComponent("truncated.qres")
+            try data.write(to: truncated)
+            XCTAssertThrowsError(try FileIO.load_result_from_file(truncated.path))
+            data = try Data(contentsOf: URL(fileURLWithPath: file))
+            // key length of the first record
+            data.replaceSubrange(13..<17, with: [0xff, 0xff, 0xff, 0xff])
+            try data.write(to: truncated)
+            XCTAssertThrowsError(try FileIO.load_result_from_file(truncated.path))
+
+            XCTAssertThrowsError(try FileIO.save_result_to_file(result, directory.appendingPathComponent("test").path,
+                                                                format: "xml"))
+        } catch {
+            XCTFail("test_results_save_load_binary: \(error)")
+        }
+    }
+
+    func test_memory_mapped_output() {
+        do {
+            let QP_program = try QuantumProgram()
+            let q = try QP_program.create_quantum_register("q", 2)
+            let c = try QP_program.create_classical_register("c", 2)
+            let qc = try QP_program.create_circuit("qc", [q], [c])
+            try qc.h(q[0])
+            try qc.cx(q[0], q[1])
+            let directory = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString)
+            defer {
+                try? FileManager.default.removeItem(at: directory)
+            }
+            let config: [String:Any] = ["memory_mapped_output": directory.path]
+            let asyncExpectation = self.expectation(description: "test_memory_mapped_output")
+            QP_program.execute(["qc"], backend: "local_qasm_simulator", config: config, shots: 1, seed: 9) { result in
+                do {
+                    if let error = result.get_error() {
+                        XCTFail("Failure in test_memory_mapped_output: \(error)")
+                        asyncExpectation.fulfill()
+                        return
+                    }
+                    guard let state = try result.get_data("qc")["quantum_state"] as? ComplexBuffer else {
+                        XCTFail("test_memory_mapped_output missing mapped quantum state.")
+                        asyncExpectation.fulfill()
+                        return
+                    }
+                    XCTAssertTrue(state.isMapped)
+                    XCTAssertTrue(FileManager.default.fileExists(atPath: state.url!.path))
+                    let expected: [Complex] = [0.70710678, 0, 0, 0.70710678]
+                    XCTAssertEqual(state.count, expected.count)
+                    for (value, expected_value) in zip(state, expected) {
+                        XCTAssert(value.almostEqual(expected_value, 0.000001))
+                    }
+                    let file = try FileIO.save_result_to_file(result, directory.appendingPathComponent("test").path,
+                                                              format: "binary")
+                    let (loaded, _) = try FileIO.load_result_from_file(file)
+                    XCTAssertEqual(try loaded.get_data("qc")["quantum_state"] as? [Complex] ?? [], state.array)
+                } catch {
+                    XCTFail("Failure in test_memory_mapped_output: \(error)")
+                }
+                QP_program.execute(["qc"], backend: "local_unitary_simulator", config: config) { result in
+                    do {
+                        if let error = result.get_error() {
+                            XCTFail("Failure in test_memory_mapped_output: \(error)")
+                            asyncExpectation.fulfill()
+                            return
+                        }
+                        guard let unitary = try result.get_data("qc")["unitary"] as? ComplexBuffer else {
+                            XCTFail("test_memory_mapped_output missing mapped unitary.")
+                            asyncExpectation.fulfill()
+                            return
+                        }
+                        XCTAssertTrue(unitary.isMapped)
+                        XCTAssertEqual(unitary.dimensions, [4, 4])
+                        let h: Double = 0.70710678
+                        let expected: Matrix<Complex> = [[Complex(real: h), Complex(real: h), 0, 0],
+                                                         [0, 0, Complex(real: h), Complex(real: -h)],
+                                                         [0, 0, Complex(real: h), Complex(real: h)],
+                                                         [Complex(real: h), Complex(real: -h), 0, 0]]
+                        for row in 0..<4 {
+                            for col in 0..<4 {
+                                XCTAssert(unitary[row, col].almostEqual(expected[row, col], 0.000001),
+                                          "(\(row),\(col)): \(unitary[row, col])")
+                            }
+                        }
+                        asyncExpectation.fulfill()
+                    } catch {
+                        XCTFail("Failure in test_memory_mapped_output: \(error)")
+                        asyncExpectation.fulfill()
+                    }
+                }
+            }
+            self.waitForExpectations(timeout: 180, handler: { (error) in
+                XCTAssertNil(error, "Failure in test_memory_mapped_output")
+            })
+        } catch {
+            XCTFail("test_memory_mapped_output: \(error)")
+        }
+    }
+
     func test_qubitpol() {
         do {
             let QP_program = try QuantumProgram()
@@ -19,7 +19,11 @@ import XCTest
 class UnrollerTests: XCTestCase {
 
     static let allTests = [
-        ("testRippleAddUnroller",testRippleAddUnroller)
+        ("testRippleAddUnroller",testRippleAddUnroller),
+        ("testDagToJson",testDagToJson),
+        ("testQobjCompiledCircuitCoding",testQobjCompiledCircuitCoding),
+        ("testNestedGateParameters",testNestedGateParameters),
+        ("testGateTemplateRegisters",testGateTemplateRegisters)
     ]
 
     private static let backend: String = "ibmqx_qasm_simulator"
@@ -72,6 +76,103 @@ class UnrollerTests: XCTestCase {
         }
     }
 
+    func testDagToJson() {
+        do {
+            let qasm = "OPENQASM 2.0;\n" +
+                "include \"qelib1.inc\";\n" +
+                "qreg q[3];\n" +
+                "creg c[2];\n" +
+                "creg d[1];\n" +
+                "h q[0];\n" +
+                "cx q[0],q[1];\n" +
+                "barrier q;\n" +
+                "measure q[0] -> c[0];\n" +
+                "measure q[1] -> d[0];\n" +
+                "if(d==1) x q[2];\n" +
+                "reset q[1];\n"
+            let unroller = Unroller(try Qasm(data: qasm).parse(), DAGBackend(["u1","u2","u3","cx","id"]))
+            let dag = try unroller.execute() as! DAGCircuit
+            let direct = try OpenQuantumCompiler.dag2json(dag)
+            let reparsed = try Unroller(try Qasm(data: dag.qasm(qeflag: true)).parse(),
+                                        JsonBackend(["u1","u2","u3","cx","id"])).execute() as! [String:Any]
+            XCTAssertEqual(NSDictionary(dictionary: direct), NSDictionary(dictionary: reparsed))
+        } catch let error {
+            XCTFail("testDagToJson fail: \(error)")
+        }
+    }
+
+    func testQobjCompiledCircuitCoding() {
+        do {
+            let qasm = "OPENQASM 2.0;\n" +
+                "include \"qelib1.inc\";\n" +
+                "qreg q[2];\n" +
+                "creg c[2];\n" +
+                "u3(0.1,0.2,0.3) q[0];\n" +
+                "cx q[0],q[1];\n" +
+                "measure q[0] -> c[0];\n" +
+                "if(c==1) u1(0.5) q[1];\n"
+            let json = try Unroller(try Qasm(data: qasm).parse(),
+                                    JsonBackend(["u1","u2","u3","cx","id"])).execute() as! [String:Any]
+            let compiled_circuit = QobjCompiledCircuit(json)
+            XCTAssertEqual(compiled_circuit.operations.count, 4)
+            XCTAssertEqual(compiled_circuit.operations[3].conditional?.mask, 3)
+            XCTAssertEqual(compiled_circuit.operations[3].conditional?.val, 1)
+            XCTAssertEqual(NSDictionary(dictionary: compiled_circuit.dictionary), NSDictionary(dictionary: json))
+            let data = try JSONEncoder().encode(compiled_circuit)
+            let decoded = try JSONDecoder().decode(QobjCompiledCircuit.self, from: data)
+            XCTAssertEqual(NSDictionary(dictionary: decoded.dictionary), NSDictionary(dictionary: json))
+        } catch let error {
+            XCTFail("testQobjCompiledCircuitCoding fail: \(error)")
+        }
+    }
+
+    func testNestedGateParameters() {
+        do {
+            let qasm = "OPENQASM 2.0;\n" +
+                "qreg q[1];\n" +
+                "gate g1(a) r { U(a/2,-a,a*2) r; }\n" +
+                "gate g2(a,b) r { g1(a+b) r; g1(sin(pi/2)*b) r; }\n" +
+                "g2(pi/4,0.5) q[0];\n" +
+                "g2(pi,-(1+1)) q[0];\n"
+            let json = try Unroller(try Qasm(data: qasm).parse(), JsonBackend([])).execute() as! [String:Any]
+            let operations = json["operations"] as! [[String:Any]]
+            let params = operations.map { $0["params"] as! [Double] }
+            let expected: [[Double]] = [
+                [(Double.pi/4+0.5)/2, -(Double.pi/4+0.5), (Double.pi/4+0.5)*2],
+                [0.25, -0.5, 1.0],
+                [(Double.pi-2)/2, -(Double.pi-2), (Double.pi-2)*2],
+                [-1.0, 2.0, -4.0]
+            ]
+            XCTAssertEqual(params.count, expected.count)
+            for (p, e) in zip(params, expected) {
+                for (x, y) in zip(p, e) {
+                    XCTAssertEqual(x, y, accuracy: 1e-12)
+                }
+            }
+        } catch let error {
+            XCTFail("testNestedGateParameters fail: \(error)")
+        }
+    }
+
+    func testGateTemplateRegisters() {
+        do {
+            let qasm = "OPENQASM 2.0;\n" +
+                "qreg q[2];\n" +
+                "qreg r[2];\n" +
+                "gate g a,b { CX a,b; barrier a,b; U(0,0,0) b; }\n" +
+                "g q,r;\n" +
+                "g r[1],q[0];\n"
+            let json = try Unroller(try Qasm(data: qasm).parse(), JsonBackend([])).execute() as! [String:Any]
+            let operations = json["operations"] as! [[String:Any]]
+            XCTAssertEqual(operations.map { $0["name"] as! String },
+                           ["CX","barrier","U","CX","barrier","U","CX","barrier","U"])
+            XCTAssertEqual(operations.map { $0["qubits"] as! [Int] },
+                           [[0,2],[0,2],[2],[1,3],[1,3],[3],[3,0],[3,0],[0]])
+        } catch let error {
+            XCTFail("testGateTemplateRegisters fail: \(error)")
+        }
+    }
+
     private func rippleAdd() throws {
         let qp = try QuantumProgram(specs: UnrollerTests.QPS_SPECS)
         let qc = try qp.get_circuit("rippleadd")